@@ -1,5 +1,8 @@
 
 #include "Animation.hpp"
+#include "Crowd.hpp"
+#include "PoseCache.hpp"
+#include "FixedRig.hpp"
 
 MeshBuffer *CreateCube()
 {
@@ -55,343 +58,446 @@ MeshBuffer *CreateCube()
 }
 
 
-Pose Animation::getPoseAtTime(float time)
+AnimationLibrary &AnimationLibrary::Instance()
 {
-    if (keyframes.empty())
-        return Pose();
-    if (keyframes.size() == 1)
-        return keyframes[0].pose;
+    static AnimationLibrary library;
+    return library;
+}
 
-    // Ajusta o tempo se a animação for em loop
-    if (loop)
+AnimationLibrary::~AnimationLibrary()
+{
+    // Os clips attach() apontam para estes ficheiros
+    clips.clear();
+    for (MappedFile *file : storage)
     {
-        time = fmod(time, duration);
+        delete file;
     }
-    else
+}
+
+ClipId AnimationLibrary::add(const Animation &anim)
+{
+    auto it = ids.find(anim.name);
+    if (it != ids.end())
     {
-        time = std::min(time, duration);
+        LogWarning("[ANIM] Clip %s already exists, keeping the original", anim.name.c_str());
+        return it->second;
     }
 
-    // Encontra os keyframes anterior e posterior
-    size_t nextFrame = 0;
-    for (; nextFrame < keyframes.size(); nextFrame++)
+    ClipId id = (ClipId)clips.size();
+    clips.emplace_back(anim, compression);
+    names.push_back(anim.name);
+    ids[anim.name] = id;
+    logClip(id);
+    return id;
+}
+
+ClipId AnimationLibrary::add(const std::string &name, const AnimationClip &clip)
+{
+    auto it = ids.find(name);
+    if (it != ids.end())
     {
-        if (keyframes[nextFrame].time > time)
-            break;
+        LogWarning("[ANIM] Clip %s already exists, keeping the original", name.c_str());
+        return it->second;
     }
 
-    if (nextFrame == 0)
-        return keyframes[0].pose;
-    if (nextFrame == keyframes.size())
-        return keyframes.back().pose;
-
-    // Interpolacao linear
-    size_t prevFrame = nextFrame - 1;
-    float frameDuration = keyframes[nextFrame].time - keyframes[prevFrame].time;
-    float t = (time - keyframes[prevFrame].time) / frameDuration;
+    ClipId id = (ClipId)clips.size();
+    clips.push_back(clip);
+    names.push_back(name);
+    ids[name] = id;
+    return id;
+}
 
-    return Pose::lerp(keyframes[prevFrame].pose, keyframes[nextFrame].pose, t);
+void AnimationLibrary::logClip(ClipId id) const
+{
+    const AnimationClip &clip = clips[id];
+    const ClipStats &stats = clip.getStats();
+    LogInfo("[ANIM] Clip %s: %d -> %d keys, %d/%d channels animated, %d -> %d bytes (%.1fx), max error %.4f deg / %.5f",
+            names[id].c_str(), stats.sourceKeys, stats.keys, clip.getAnimatedChannelCount(), clip.getChannelCount(),
+            (int)stats.sourceBytes, (int)stats.bytes, stats.ratio(), ToDegrees(stats.maxRotationError), stats.maxTranslationError);
 }
 
-void AnimationManager::playAnimation(const std::string &name, bool shouldLoop, bool resetTime )
+ClipId AnimationLibrary::find(const std::string &name) const
 {
-    if (animations.find(name) != animations.end())
-    {
-        currentAnimation = name;
-        looping = shouldLoop;
+    auto it = ids.find(name);
+    return (it != ids.end()) ? it->second : INVALID_CLIP;
+}
 
-        if (resetTime)
-        {
-            currentTime = 0.0f;
-        }
+void AnimationPlayer::play(ClipId id, bool loop, bool resetTime)
+{
+    if (!AnimationLibrary::Instance().isValid(id))
+        return;
 
-        playing = true;
+    if (id != clip)
+    {
+        clip = id;
+        cursor = ClipCursor();
+        flags |= NEEDS_INIT;
     }
+    if (resetTime)
+    {
+        time = 0.0f;
+    }
+    flags = loop ? (flags | LOOPING) : (flags & ~LOOPING);
+    flags |= PLAYING;
 }
 
-void AnimationManager::update(float deltaTime)
+void AnimationPlayer::update(float deltaTime)
 {
-    if (!playing)
+    if (!(flags & PLAYING))
         return;
 
-    currentTime += deltaTime * playbackSpeed;
+    time += deltaTime * speed;
 
     // Verifica se chegou ao fim da animação
-    if (animations.find(currentAnimation) != animations.end())
+    float duration = AnimationLibrary::Instance().getClip(clip).getDuration();
+    if (time >= duration)
     {
-        Animation &anim = animations[currentAnimation];
-
-        if (currentTime >= anim.duration)
+        if ((flags & LOOPING) && duration > 0.0f)
         {
-            if (looping)
-            {
-                // Volta ao início se estiver em loop
-                currentTime = fmod(currentTime, anim.duration);
-            }
-            else
-            {
-                // Para a animação se não estiver em loop
-                currentTime = anim.duration;
-                playing = false;
-            }
+            // Volta ao início se estiver em loop
+            time -= duration;
+            if (time >= duration)
+                time = fmod(time, duration);
+        }
+        else
+        {
+            // Para a animação se não estiver em loop
+            time = duration;
+            flags &= ~PLAYING;
         }
     }
 }
 
-void AnimationManager::createDanceAnimation()
+bool AnimationPlayer::sample(Pose &out)
 {
+    if (!(flags & PLAYING))
+        return false;
+
+    const AnimationClip &current = AnimationLibrary::Instance().getClip(clip);
+    if ((flags & NEEDS_INIT) || out.channelCount() != current.getChannelCount())
+    {
+        current.initPose(out);
+        flags &= ~NEEDS_INIT;
+    }
+    current.sample(time, cursor, out);
+    return true;
+}
+
+bool AnimationPlayer::sampleAt(float t, Pose &out)
+{
+    if (!(flags & PLAYING))
+        return false;
+
+    const AnimationClip &current = AnimationLibrary::Instance().getClip(clip);
+    if ((flags & NEEDS_INIT) || out.channelCount() != current.getChannelCount())
+    {
+        current.initPose(out);
+        flags &= ~NEEDS_INIT;
+    }
+
+    float duration = current.getDuration();
+    if (t >= duration)
+        t = ((flags & LOOPING) && duration > 0.0f) ? fmod(t, duration) : duration;
+    current.sample(t, cursor, out);
+    return true;
+}
+
+bool AnimationPlayer::sampleRoot(Pose &out)
+{
+    if (!(flags & PLAYING))
+        return false;
+
+    const AnimationClip &current = AnimationLibrary::Instance().getClip(clip);
+    if ((flags & NEEDS_INIT) || out.channelCount() != current.getChannelCount())
+    {
+        current.initPose(out);
+        flags &= ~NEEDS_INIT;
+    }
+    current.sampleRoot(time, cursor, out);
+    return true;
+}
+
+void AnimationLibrary::createDanceAnimation()
+{
+    if (find("dance") != INVALID_CLIP)
+        return;
+
     Animation dance("dance", true);
     const float PI = 3.14159f;
 
-    Pose pose1;
+    Pose pose1(HUMAN_JOINT_COUNT);
 
-    pose1.torsoRotation = 15.0f * PI / 180.0f;
-    pose1.upperArmRotation[0] = pose1.upperArmRotation[1] = -90.0f * PI / 180.0f; // Braços levantados
-    pose1.forearmRotation[0] = pose1.forearmRotation[1] = -45.0f * PI / 180.0f;   // Cotovelos dobrados
-    pose1.thighRotation[0] = -20.0f * PI / 180.0f;                                // Perna esquerda flexionada
+    pose1.rotation(JOINT_TORSO) = 15.0f * PI / 180.0f;
+    pose1.rotation(JOINT_UPPER_ARM_L) = pose1.rotation(JOINT_UPPER_ARM_R) = -90.0f * PI / 180.0f; // Braços levantados
+    pose1.rotation(JOINT_FOREARM_L) = pose1.rotation(JOINT_FOREARM_R) = -45.0f * PI / 180.0f;     // Cotovelos dobrados
+    pose1.rotation(JOINT_THIGH_L) = -20.0f * PI / 180.0f;                                        // Perna esquerda flexionada
     dance.addKeyframe(pose1, 0.0f);
 
     // Pose 2: Movimento de disco
-    Pose pose2;
-    pose2.torsoRotation = -15.0f * PI / 180.0f;
-    pose2.upperArmRotation[0] = -45.0f * PI / 180.0f;  // Braço esquerdo diagonal
-    pose2.upperArmRotation[1] = -135.0f * PI / 180.0f; // Braço direito diagonal
-    pose2.forearmRotation[0] = pose2.forearmRotation[1] = -45.0f * PI / 180.0f;
-    pose2.thighRotation[1] = -20.0f * PI / 180.0f;
+    Pose pose2(HUMAN_JOINT_COUNT);
+    pose2.rotation(JOINT_TORSO) = -15.0f * PI / 180.0f;
+    pose2.rotation(JOINT_UPPER_ARM_L) = -45.0f * PI / 180.0f;  // Braço esquerdo diagonal
+    pose2.rotation(JOINT_UPPER_ARM_R) = -135.0f * PI / 180.0f; // Braço direito diagonal
+    pose2.rotation(JOINT_FOREARM_L) = pose2.rotation(JOINT_FOREARM_R) = -45.0f * PI / 180.0f;
+    pose2.rotation(JOINT_THIGH_R) = -20.0f * PI / 180.0f;
     dance.addKeyframe(pose2, 0.5f);
 
-    Pose pose3;
-    pose3.torsoRotation = 180.0f * PI / 180.0f;
-    pose3.upperArmRotation[0] = pose3.upperArmRotation[1] = -90.0f * PI / 180.0f;
-    pose3.forearmRotation[0] = -90.0f * PI / 180.0f;
-    pose3.forearmRotation[1] = 90.0f * PI / 180.0f;
+    Pose pose3(HUMAN_JOINT_COUNT);
+    pose3.rotation(JOINT_TORSO) = 180.0f * PI / 180.0f;
+    pose3.rotation(JOINT_UPPER_ARM_L) = pose3.rotation(JOINT_UPPER_ARM_R) = -90.0f * PI / 180.0f;
+    pose3.rotation(JOINT_FOREARM_L) = -90.0f * PI / 180.0f;
+    pose3.rotation(JOINT_FOREARM_R) = 90.0f * PI / 180.0f;
     dance.addKeyframe(pose3, 1.0f);
 
     // Volta para pose inicial
     dance.addKeyframe(pose1, 1.5f);
 
-    addAnimation(dance);
+    add(dance);
 }
 
-void AnimationManager::createFighterAnimation()
+void AnimationLibrary::createFighterAnimation()
 {
+    if (find("fight") != INVALID_CLIP)
+        return;
+
     Animation fight("fight", true);
     const float PI = 3.14159f;
 
-    Pose fightStance;
-    fightStance.torsoRotation = 45.0f * PI / 180.0f;
-    fightStance.upperArmRotation[0] = -90.0f * PI / 180.0f; // Braço esquerdo em guarda
-    fightStance.upperArmRotation[1] = -45.0f * PI / 180.0f; // Braço direito em guarda
-    fightStance.forearmRotation[0] = -90.0f * PI / 180.0f;
-    fightStance.forearmRotation[1] = -90.0f * PI / 180.0f;
-    fightStance.thighRotation[0] = -30.0f * PI / 180.0f; // Pernas flexionadas
-    fightStance.thighRotation[1] = -30.0f * PI / 180.0f;
-    fightStance.calfRotation[0] = 30.0f * PI / 180.0f;
-    fightStance.calfRotation[1] = 30.0f * PI / 180.0f;
+    Pose fightStance(HUMAN_JOINT_COUNT);
+    fightStance.rotation(JOINT_TORSO) = 45.0f * PI / 180.0f;
+    fightStance.rotation(JOINT_UPPER_ARM_L) = -90.0f * PI / 180.0f; // Braço esquerdo em guarda
+    fightStance.rotation(JOINT_UPPER_ARM_R) = -45.0f * PI / 180.0f; // Braço direito em guarda
+    fightStance.rotation(JOINT_FOREARM_L) = -90.0f * PI / 180.0f;
+    fightStance.rotation(JOINT_FOREARM_R) = -90.0f * PI / 180.0f;
+    fightStance.rotation(JOINT_THIGH_L) = -30.0f * PI / 180.0f; // Pernas flexionadas
+    fightStance.rotation(JOINT_THIGH_R) = -30.0f * PI / 180.0f;
+    fightStance.rotation(JOINT_CALF_L) = 30.0f * PI / 180.0f;
+    fightStance.rotation(JOINT_CALF_R) = 30.0f * PI / 180.0f;
     fight.addKeyframe(fightStance, 0.0f);
 
     // Soco direito
-    Pose punch;
-    punch.torsoRotation = 30.0f * PI / 180.0f;
-    punch.upperArmRotation[1] = 45.0f * PI / 180.0f; // Braço direito estendido
-    punch.forearmRotation[1] = 0.0f;
-    punch.upperArmRotation[0] = -90.0f * PI / 180.0f; // Braço esquerdo mantém guarda
-    punch.forearmRotation[0] = -90.0f * PI / 180.0f;
+    Pose punch(HUMAN_JOINT_COUNT);
+    punch.rotation(JOINT_TORSO) = 30.0f * PI / 180.0f;
+    punch.rotation(JOINT_UPPER_ARM_R) = 45.0f * PI / 180.0f; // Braço direito estendido
+    punch.rotation(JOINT_FOREARM_R) = 0.0f;
+    punch.rotation(JOINT_UPPER_ARM_L) = -90.0f * PI / 180.0f; // Braço esquerdo mantém guarda
+    punch.rotation(JOINT_FOREARM_L) = -90.0f * PI / 180.0f;
     fight.addKeyframe(punch, 0.2f);
 
     // Volta para posição de guarda
     fight.addKeyframe(fightStance, 0.4f);
 
     //  perna esquerda
-    Pose kick;
-    kick.torsoRotation = 60.0f * PI / 180.0f;
-    kick.thighRotation[0] = 90.0f * PI / 180.0f;  // Perna esquerda levantada
-    kick.calfRotation[0] = 0.0f;                  // Perna esticada
-    kick.thighRotation[1] = -45.0f * PI / 180.0f; // Perna direita como base
-    kick.calfRotation[1] = 45.0f * PI / 180.0f;
+    Pose kick(HUMAN_JOINT_COUNT);
+    kick.rotation(JOINT_TORSO) = 60.0f * PI / 180.0f;
+    kick.rotation(JOINT_THIGH_L) = 90.0f * PI / 180.0f;  // Perna esquerda levantada
+    kick.rotation(JOINT_CALF_L) = 0.0f;                  // Perna esticada
+    kick.rotation(JOINT_THIGH_R) = -45.0f * PI / 180.0f; // Perna direita como base
+    kick.rotation(JOINT_CALF_R) = 45.0f * PI / 180.0f;
     fight.addKeyframe(kick, 0.6f);
 
     // Retorno à posição de guarda
     fight.addKeyframe(fightStance, 1.0f);
 
-    addAnimation(fight);
+    add(fight);
 }
 
-void AnimationManager::createDefaultAnimations()
+void AnimationLibrary::createDefaultAnimations()
 {
+    if (find("walk") != INVALID_CLIP)
+        return;
 
+    // Walk e jump são curvas cúbicas: com três keys o balanço e o arco do salto já saem suaves
     Animation walk("walk", true);
+    walk.curve = AnimationCurve::CUBIC;
 
-    Pose pose1; // Pose inicial
-    pose1.upperArmRotation[0] = 45.0f * (3.14159f / 180.0f);
-    pose1.upperArmRotation[1] = -45.0f * (3.14159f / 180.0f);
-    pose1.thighRotation[0] = -30.0f * (3.14159f / 180.0f);
-    pose1.thighRotation[1] = 30.0f * (3.14159f / 180.0f);
+    Pose pose1(HUMAN_JOINT_COUNT); // Pose inicial
+    pose1.rotation(JOINT_UPPER_ARM_L) = 45.0f * (3.14159f / 180.0f);
+    pose1.rotation(JOINT_UPPER_ARM_R) = -45.0f * (3.14159f / 180.0f);
+    pose1.rotation(JOINT_THIGH_L) = -30.0f * (3.14159f / 180.0f);
+    pose1.rotation(JOINT_THIGH_R) = 30.0f * (3.14159f / 180.0f);
     walk.addKeyframe(pose1, 0.0f);
 
-    Pose pose2; // Pose intermediária
-    pose2.upperArmRotation[0] = -45.0f * (3.14159f / 180.0f);
-    pose2.upperArmRotation[1] = 45.0f * (3.14159f / 180.0f);
-    pose2.thighRotation[0] = 30.0f * (3.14159f / 180.0f);
-    pose2.thighRotation[1] = -30.0f * (3.14159f / 180.0f);
+    Pose pose2(HUMAN_JOINT_COUNT); // Pose intermediária
+    pose2.rotation(JOINT_UPPER_ARM_L) = -45.0f * (3.14159f / 180.0f);
+    pose2.rotation(JOINT_UPPER_ARM_R) = 45.0f * (3.14159f / 180.0f);
+    pose2.rotation(JOINT_THIGH_L) = 30.0f * (3.14159f / 180.0f);
+    pose2.rotation(JOINT_THIGH_R) = -30.0f * (3.14159f / 180.0f);
     walk.addKeyframe(pose2, 0.5f);
 
     walk.addKeyframe(pose1, 1.0f); // Volta à pose inicial
 
-    addAnimation(walk);
+    add(walk);
 
     Animation jump("jump", false);
+    jump.curve = AnimationCurve::CUBIC;
 
-    Pose jumpStart;
-    jumpStart.position.y = 2;
-    jumpStart.thighRotation[0] = jumpStart.thighRotation[1] = 45.0f * (3.14159f / 180.0f);
-    jumpStart.calfRotation[0] = jumpStart.calfRotation[1] = -90.0f * (3.14159f / 180.0f);
+    // A altura do salto é uma translação do torso (somada ao offset de bind do esqueleto)
+    Pose jumpStart(HUMAN_JOINT_COUNT);
+    jumpStart.rotation(JOINT_THIGH_L) = jumpStart.rotation(JOINT_THIGH_R) = 45.0f * (3.14159f / 180.0f);
+    jumpStart.rotation(JOINT_CALF_L) = jumpStart.rotation(JOINT_CALF_R) = -90.0f * (3.14159f / 180.0f);
     jump.addKeyframe(jumpStart, 0.0f);
 
-    // Pose jumpMiddle;
-    // jumpMiddle.position.y = 2;
-    // jumpMiddle.thighRotation[0] = jumpMiddle.thighRotation[1]  -30.0f * (3.14159f / 180.0f);
-    // jumpMiddle.upperArmRotation[0] = jumpMiddle.upperArmRotation[1] = -180.0f * (3.14159f / 180.0f);
-    // jump.addKeyframe(jumpMiddle, 0.4f);
-
-    Pose jumpAir;
-    jumpAir.position.y = 5;
-    jumpAir.thighRotation[0] = jumpAir.thighRotation[1] = -30.0f * (3.14159f / 180.0f);
-    jumpAir.upperArmRotation[0] = jumpAir.upperArmRotation[1] = -180.0f * (3.14159f / 180.0f);
+    Pose jumpAir(HUMAN_JOINT_COUNT);
+    jumpAir.setTranslation(JOINT_TORSO, Vec3(0.0f, 3.0f, 0.0f));
+    jumpAir.rotation(JOINT_THIGH_L) = jumpAir.rotation(JOINT_THIGH_R) = -30.0f * (3.14159f / 180.0f);
+    jumpAir.rotation(JOINT_UPPER_ARM_L) = jumpAir.rotation(JOINT_UPPER_ARM_R) = -180.0f * (3.14159f / 180.0f);
     jump.addKeyframe(jumpAir, 0.4f);
 
-
-
     Pose jumpEnd = jumpStart;
     jump.addKeyframe(jumpEnd, 1.0f);
 
-    addAnimation(jump);
+    add(jump);
 }
-Pose AnimationManager::getDefaultPose()
+void Humanoid::render(Shader &shader)
 {
-    Pose pose;
-    pose.torsoRotation = 0.0f;
-    pose.headRotation = 0.0f;
-    for (int i = 0; i < 2; i++)
+    // Só os nós alterados desde o último frame (e os seus filhos) são recalculados
+    updateTransforms();
+
+    // Handles resolvidos uma vez por personagem; cada cubo só indexa a tabela de uniforms
+    UniformHandle model = shader.GetUniformHandle("model");
+    UniformHandle diffuse = shader.GetUniformHandle("difusse");
+    const Mat4 *worlds = getWorldMatrices();
+    for (int joint = 0; joint < skeleton.getJointCount(); joint++)
     {
-        pose.upperArmRotation[i] = 0.0f;
-        pose.forearmRotation[i] = 0.0f;
-        pose.thighRotation[i] = 0.0f;
-        pose.calfRotation[i] = 0.0f;
+        renderCube(shader, model, diffuse, worlds[skeleton.getShapeNode(joint)], skeleton.getColor(joint));
     }
-    return pose;
 }
 
-Pose AnimationManager::getCurrentPose()
+void Humanoid::submit(CrowdRenderer &crowd)
 {
-    if (!playing || animations.find(currentAnimation) == animations.end())
+    updateTransforms();
+
+    const Mat4 *worlds = getWorldMatrices();
+    for (int joint = 0; joint < skeleton.getJointCount(); joint++)
     {
-        return Pose();
+        crowd.add(worlds[skeleton.getShapeNode(joint)], skeleton.getColor(joint));
     }
-    return animations[currentAnimation].getPoseAtTime(currentTime);
 }
 
-void Humanoid::render(Shader &shader)
+void Humanoid::setFixedRig(bool enable)
 {
-    matrixStack.identity();
-
-    matrixStack.translate(position.x, position.y, position.z);
-
-    // Rotação principal do torso
-    matrixStack.rotateY(torsoRotation);
-
-    // Torso - todas as outras partes serão relativas a ele
-    matrixStack.push();
-    matrixStack.scale(1.0f, 1.6f, 0.5f);
-    renderCube(shader, matrixStack.top(), Color(45, 100, 25));
-    matrixStack.pop();
-
-    // Cabeça - relativa ao torso
-    matrixStack.push();
-    matrixStack.translate(0.0f, 1.4f, 0.0f);
-    matrixStack.rotateY(headRotation);
-    matrixStack.scale(0.7f, 0.7f, 0.7f);
-    renderCube(shader, matrixStack.top(), Color(255, 224, 185));
-    matrixStack.pop();
-
-    // Braços
-    for (int side = 0; side < 2; side++)
-    { // 0 = esquerdo, 1 = direito
-        float sideSign = (side == 0) ? -1.0f : 1.0f;
-
-        // Upper arm - relativo ao torso
-        matrixStack.push();
-        matrixStack.translate(sideSign * 0.7f, 0.75f, 0.0f);
-        matrixStack.rotateX(upperArmRotation[side]);
-
-        // Renderiza upper arm
-        matrixStack.push();
-        matrixStack.translate(0.0f, -0.3f, 0.0f);
-        matrixStack.scale(0.4f, 0.6f, 0.4f);
-        renderCube(shader, matrixStack.top(), Color(255, 224, 185));
-        matrixStack.pop();
-
-        // Forearm - relativo ao upper arm
-        matrixStack.translate(0.0f, -0.6f, 0.0f);
-        matrixStack.rotateX(forearmRotation[side]);
-        matrixStack.translate(0.0f, -0.3f, 0.0f);
-        matrixStack.scale(0.3f, 0.6f, 0.3f);
-        renderCube(shader, matrixStack.top(), Color(255, 224, 185));
-
-        matrixStack.pop();
-    }
+    assert((!enable || &skeleton == &Skeleton::Humanoid()) && "Humanoid: the fixed rig is only for Skeleton::Humanoid()");
+    if (enable == fixedRig)
+        return;
 
-    // Pernas
-    for (int side = 0; side < 2; side++)
-    { // 0 = esquerda, 1 = direita
-        float sideSign = (side == 0) ? -1.0f : 1.0f;
-
-        // Thigh - relativo ao torso
-        matrixStack.push();
-        matrixStack.translate(sideSign * 0.3f, -0.85f, 0.0f);
-        matrixStack.rotateX(thighRotation[side]);
-
-        // Renderiza thigh
-        matrixStack.push();
-        matrixStack.translate(0.0f, -0.3f, 0.0f);
-        matrixStack.scale(0.4f, 0.8f, 0.4f);
-        renderCube(shader, matrixStack.top(), Color::BLUE);
-        matrixStack.pop();
-
-        // Calf - relativo ao thigh
-        matrixStack.translate(0.0f, -0.6f, 0.0f);
-        matrixStack.rotateX(calfRotation[side]);
-        matrixStack.translate(0.0f, -0.3f, 0.0f);
-        matrixStack.scale(0.35f, 0.6f, 0.35f);
-        renderCube(shader, matrixStack.top(), Color::BLUE);
-
-        matrixStack.pop();
+    fixedRig = enable;
+    if (fixedRig)
+    {
+        rigWorlds.resize(FixedRig<HumanoidRig>::NODE_COUNT);
+        rigDirty = true;
+    }
+    else
+    {
+        // A hierarquia não viu as poses enquanto o rig especializado estava ligado
+        skeleton.applyPose(pose, transforms);
     }
 }
 
-void Humanoid::animate(float deltaTime)
+void Humanoid::updateTransforms()
 {
+    if (!fixedRig)
+    {
+        transforms.update();
+        return;
+    }
 
-    animManager.update(deltaTime);
-    Pose currentPose = animManager.getCurrentPose();
+    if (rigDirty)
+    {
+        // Poses de outro tamanho (ou vazias) ficam na pose de bind
+        const float *channels = pose.channelCount() == 4 * HumanoidRig::JOINT_COUNT ? pose.channels.data() : nullptr;
+        FixedRig<HumanoidRig>::Evaluate(position, channels, rigWorlds.data());
+        rigDirty = false;
+    }
+}
+
+void Humanoid::setPoseCache(PoseCache *cache)
+{
+    assert((!cache || &cache->getSkeleton() == &skeleton) && "Humanoid: pose cache belongs to another rig");
+    poseCache = cache;
+}
 
-    // Aplica a pose atual ao modelo
-    setTorsoRotation(currentPose.torsoRotation);
-    setHeadRotation(currentPose.headRotation);
-    if (animManager.CurrentAnimation() == "jump")
+void Humanoid::animate(float deltaTime)
+{
+    player.update(deltaTime);
+    if (poseCache && poseCache->enabled && player.isPlaying())
     {
-        position = currentPose.position;
+        const JointLocal *locals = poseCache->acquire(player.clip, player.time, pose);
+        if (locals)
+        {
+            if (fixedRig)
+                rigDirty = true;
+            else
+                skeleton.applyLocals(locals, transforms);
+            return;
+        }
     }
-    else
+
+    if (!player.sample(pose))
     {
-        position.y = 2;
+        // Nada a tocar (ou um clip sem loop terminou): pose de bind
+        pose.channels.clear();
     }
 
-    for (int i = 0; i < 2; i++)
+    // Aplica a pose atual ao esqueleto; os joints sem canais na pose ficam na pose de bind
+    poseChanged();
+}
+
+AnimationLodLevel Humanoid::animate(float deltaTime, AnimationLod &lod)
+{
+    bool timed = lod.isTimed(lodPhase);
+    Uint64 start = timed ? SDL_GetPerformanceCounter() : 0;
+    AnimationLodLevel level = lod.select(position);
+
+    if (level != ANIM_LOD_INTERPOLATED)
+        lodFramesLeft = 0;
+
+    switch (level)
     {
-        setUpperArmRotation(i == 1, currentPose.upperArmRotation[i]);
-        setForearmRotation(i == 1, currentPose.forearmRotation[i]);
-        setThighRotation(i == 1, currentPose.thighRotation[i]);
-        setCalfRotation(i == 1, currentPose.calfRotation[i]);
+    case ANIM_LOD_FULL:
+        animate(deltaTime);
+        break;
+
+    case ANIM_LOD_INTERPOLATED:
+    {
+        player.update(deltaTime);
+        if (lod.isUpdateFrame(level, lodPhase) || lodFramesLeft <= 0)
+        {
+            // Pose daqui a interval frames (ao ritmo do frame atual); até lá caminha-se para ela
+            int interval = lod.getInterval(level);
+            if (!player.sampleAt(player.time + deltaTime * player.speed * interval, lodTarget))
+            {
+                lodTarget.channels.clear();
+            }
+            lodFramesLeft = interval;
+            if (pose.channelCount() != lodTarget.channelCount())
+                pose = lodTarget;
+        }
+        if (lodFramesLeft > 0)
+        {
+            Pose::lerp(pose, lodTarget, 1.0f / (float)lodFramesLeft, pose);
+            lodFramesLeft--;
+        }
+        poseChanged();
+        break;
+    }
+
+    case ANIM_LOD_ROOT:
+        player.update(deltaTime);
+        if (lod.isUpdateFrame(level, lodPhase))
+        {
+            if (!player.sampleRoot(pose))
+                pose.channels.clear();
+            poseChanged();
+        }
+        break;
+
+    default:
+        // Parado: o tempo continua, para o personagem voltar no sítio certo do clip
+        player.update(deltaTime);
+        break;
     }
-}
\ No newline at end of file
+
+    lod.record(level, timed, timed ? SDL_GetPerformanceCounter() - start : 0);
+    return level;
+}
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <string>
-#include <map>
+#include <unordered_map>
 #include "Core.hpp"
+#include "Skeleton.hpp"
+#include "AnimationClip.hpp"
+#include "AnimationLod.hpp"
 
 struct Vertex
 {
@@ -11,53 +14,11 @@ struct Vertex
 
 MeshBuffer *CreateCube();
 
-struct Pose
-{
-    Vec3 position;
-    float torsoRotation;
-    float headRotation;
-    float upperArmRotation[2]; // [0] = esquerdo, [1] = direito
-    float forearmRotation[2];  // [0] = esquerdo, [1] = direito
-    float thighRotation[2];    // [0] = esquerdo, [1] = direito
-    float calfRotation[2];     // [0] = esquerdo, [1] = direito
-
-    Pose()
-    {
-        torsoRotation = 0.0f;
-        headRotation = 0.0f;
-        for (int i = 0; i < 2; i++)
-        {
-            upperArmRotation[i] = 0.0f;
-            forearmRotation[i] = 0.0f;
-            thighRotation[i] = 0.0f;
-            calfRotation[i] = 0.0f;
-        }
-    }
-
-    static Pose lerp(const Pose &a, const Pose &b, float t)
-    {
-        Pose result;
-        result.torsoRotation = a.torsoRotation * (1 - t) + b.torsoRotation * t;
-        result.headRotation = a.headRotation * (1 - t) + b.headRotation * t;
-        result.position.x = a.position.x  * (1 - t) + b.position.x * t;
-        result.position.y = a.position.y  * (1 - t) + b.position.y * t;
-        result.position.z = a.position.z  * (1 - t) + b.position.z * t;
-
-        for (int i = 0; i < 2; i++)
-        {
-            result.upperArmRotation[i] = a.upperArmRotation[i] * (1 - t) + b.upperArmRotation[i] * t;
-            result.forearmRotation[i] = a.forearmRotation[i] * (1 - t) + b.forearmRotation[i] * t;
-            result.thighRotation[i] = a.thighRotation[i] * (1 - t) + b.thighRotation[i] * t;
-            result.calfRotation[i] = a.calfRotation[i] * (1 - t) + b.calfRotation[i] * t;
-        }
-        return result;
-    }
-};
-
 struct Keyframe
 {
     Pose pose;
     float time; // Tempo em segundos
+    Pose tangents; // Só em curvas cúbicas: derivada de cada canal (por segundo); canais em falta ou NaN = automática
 };
 
 class Animation
@@ -67,6 +28,7 @@ public:
     std::vector<Keyframe> keyframes;
     bool loop;
     float duration;
+    AnimationCurve curve = AnimationCurve::LINEAR;
 
     Animation()
     {
@@ -77,155 +39,250 @@ public:
 
     void addKeyframe(const Pose &pose, float time)
     {
-        Keyframe kf = {pose, time};
+        Keyframe kf = {pose, time, Pose()};
         keyframes.push_back(kf);
         duration = std::max(duration, time);
     }
 
-    
-    Pose getPoseAtTime(float time);
+    // Key de Hermite: tangents dá a derivada de cada canal neste key (só usada com AnimationCurve::CUBIC).
+    // Os handles de uma curva de Bézier com tangentes contínuas dão tangents = 3 * (handle - valor) / duração do segmento.
+    void addKeyframe(const Pose &pose, float time, const Pose &tangents)
+    {
+        Keyframe kf = {pose, time, tangents};
+        keyframes.push_back(kf);
+        duration = std::max(duration, time);
+    }
 };
 
-class AnimationManager
-{
-private:
-    std::map<std::string, Animation> animations;
-    std::string currentAnimation;
-    std::string nextAnimation;
-    float currentTime;
-    float playbackSpeed;
-    bool playing;
-    bool looping;
+// Índice de um clip na AnimationLibrary; o nome só é procurado uma vez (ao carregar ou ao trocar de clip)
+typedef int ClipId;
+static const ClipId INVALID_CLIP = -1;
 
+// Clips partilhados por todos os personagens do processo. São compilados uma vez ao serem
+// adicionados e não mudam depois disso, por isso podem ser lidos de qualquer thread;
+// adicionar clips só é seguro enquanto nenhum player estiver a ser atualizado.
+class AnimationLibrary
+{
 public:
-    AnimationManager() : currentTime(0.0f),
-                         playbackSpeed(1.0f),
-                         playing(false),
-                         looping(true) {}
+    static AnimationLibrary &Instance();
 
-    void reset()
-    {
-        currentTime = 0.0f;
-        playing = false;
-        currentAnimation = "";
-        nextAnimation = "";
-    }
+    // Compila (e comprime) a animação e devolve o seu id; um nome já registado mantém o clip original
+    ClipId add(const Animation &anim);
+    // Clip já compilado (p.ex. carregado de um ficheiro binário)
+    ClipId add(const std::string &name, const AnimationClip &clip);
+    ClipId find(const std::string &name) const;
 
-    std::string const CurrentAnimation() {return currentAnimation;}
+    // Ficheiro mapeado com dados usados por clips attach(); fica aberto até ao fim do processo
+    void addStorage(MappedFile *file) { storage.push_back(file); }
 
-    void addAnimation(const Animation &anim)
-    {
-        animations[anim.name] = anim;
-    }
-
-    void playAnimation(const std::string &name, bool shouldLoop = true, bool resetTime = true);
+    const AnimationClip &getClip(ClipId id) const { return clips[id]; }
+    const std::string &getName(ClipId id) const { return names[id]; }
+    int getClipCount() const { return (int)clips.size(); }
+    bool isValid(ClipId id) const { return id >= 0 && id < (int)clips.size(); }
 
-    void update(float deltaTime);
+    // Só afeta os clips adicionados depois
+    void setCompression(const ClipCompression &settings) { compression = settings; }
+    const ClipCompression &getCompression() const { return compression; }
 
-    void setPlaybackSpeed(float speed) { playbackSpeed = speed; }
-    float getPlaybackSpeed() const { return playbackSpeed; }
+    // Clips de demonstração do rig humanoide (walk, jump, dance, fight); só regista os que faltam
+    void createDefaultAnimations();
+    void createDanceAnimation();
+    void createFighterAnimation();
 
-    void pause() { playing = false; }
-    void resume() { playing = true; }
-    bool isPlaying() const { return playing; }
+private:
+    AnimationLibrary() {}
+    ~AnimationLibrary();
+    AnimationLibrary(const AnimationLibrary &) = delete;
+    AnimationLibrary &operator=(const AnimationLibrary &) = delete;
+
+    std::vector<AnimationClip> clips;
+    std::vector<std::string> names;
+    std::unordered_map<std::string, ClipId> ids;
+    std::vector<MappedFile *> storage;
+    ClipCompression compression;
+
+    void logClip(ClipId id) const;
+};
 
-    float getCurrentTime() const { return currentTime; }
-    void setCurrentTime(float time) { currentTime = time; }
+// Estado de reprodução de um personagem: POD sem ponteiros nem strings, pode ser copiado
+// com memcpy e guardado em arrays contíguos. O clip vem sempre da AnimationLibrary.
+struct AnimationPlayer
+{
+    enum Flags : uint32_t
+    {
+        PLAYING = 1 << 0,
+        LOOPING = 1 << 1,
+        NEEDS_INIT = 1 << 2, // o clip mudou: a pose tem de ser redimensionada antes de amostrar
+    };
+
+    ClipId clip = INVALID_CLIP;
+    float time = 0.0f;
+    float speed = 1.0f;
+    ClipCursor cursor;
+    uint32_t flags = 0;
+
+    void play(ClipId id, bool loop = true, bool resetTime = true);
+    void stop() { flags &= ~PLAYING; }
+    void pause() { flags &= ~PLAYING; }
+    void resume()
+    {
+        if (clip != INVALID_CLIP)
+            flags |= PLAYING;
+    }
+    void seek(float t) { time = t; } // o cursor resolve com pesquisa binária
 
-    const std::string &getCurrentAnimationName() const { return currentAnimation; }
+    bool isPlaying() const { return (flags & PLAYING) != 0; }
+    bool isLooping() const { return (flags & LOOPING) != 0; }
 
-    bool isLooping() const { return looping; }
-    void setLooping(bool loop) { looping = loop; }
+    void update(float deltaTime);
 
-    Pose getCurrentPose();
-    void createDanceAnimation();
-    void createFighterAnimation();
-    void createDefaultAnimations();
-    Pose getDefaultPose();
+    // Escreve a pose do clip no tempo atual; devolve false (e não toca em out) se nada estiver a tocar
+    bool sample(Pose &out);
 
+    // Pose noutro instante (p.ex. à frente, para interpolar até lá); com loop o tempo dá a volta,
+    // sem loop fica no fim do clip. Não muda o tempo do player.
+    bool sampleAt(float t, Pose &out);
+    // Só os canais da raiz (AnimationClip::sampleRoot); os restantes ficam como estão
+    bool sampleRoot(Pose &out);
 };
 
+class CrowdRenderer;
+class PoseCache;
+
 class Humanoid
 {
 private:
     MeshBuffer *cubeMesh;
-    MatrixStack matrixStack;
+    bool ownsMesh;
     Vec3 position;
 
-    AnimationManager animManager;
+    AnimationPlayer player;
+
+    // O rig vem do asset de esqueleto; cada joint e cada cubo é um nó da hierarquia
+    // e as matrizes world só são recalculadas quando um nó (ou um pai) muda.
+    const Skeleton &skeleton;
+    TransformHierarchy transforms;
+    Pose pose;
 
-    // Ângulos de rotação para cada parte
-    float torsoRotation = 0.0f;
-    float headRotation = 0.0f;
+    // Animation LOD: pose para onde o nível interpolado caminha e frames que faltam para lá chegar
+    Pose lodTarget;
+    int lodFramesLeft = 0;
+    int lodPhase = 0;
 
-    // Braços
-    float upperArmRotation[2] = {0.0f, 0.0f}; // [0] = esquerdo, [1] = direito
-    float forearmRotation[2] = {0.0f, 0.0f};  // [0] = esquerdo, [1] = direito
+    // Poses partilhadas com outros personagens do mesmo rig (não é libertada aqui)
+    PoseCache *poseCache = nullptr;
 
-    // Pernas
-    float thighRotation[2] = {0.0f, 0.0f}; // [0] = esquerda, [1] = direita
-    float calfRotation[2] = {0.0f, 0.0f};  // [0] = esquerda, [1] = direita
+    // Caminho especializado (FixedRig<HumanoidRig>): a pose vai direta para rigWorlds, sem passar pela
+    // hierarquia; rigDirty marca que a pose ou a posição mudaram desde a última avaliação
+    bool fixedRig = false;
+    bool rigDirty = true;
+    std::vector<Mat4> rigWorlds;
 
 public:
-    Humanoid()
+    Humanoid() : skeleton(Skeleton::Humanoid())
     {
         cubeMesh = CreateCube();
-        animManager.createDefaultAnimations();
-        animManager.createDanceAnimation();
-        animManager.createFighterAnimation();
-        animManager.playAnimation("jump");
+        ownsMesh = true;
+        skeleton.buildHierarchy(transforms);
+        pose = skeleton.createPose();
+        AnimationLibrary &library = AnimationLibrary::Instance();
+        library.createDefaultAnimations();
+        library.createDanceAnimation();
+        library.createFighterAnimation();
+        player.play(library.find("jump"));
+    }
+
+    // Para multidões: cubo partilhado (não é libertado aqui); os clips vêm da AnimationLibrary
+    explicit Humanoid(MeshBuffer *sharedCube) : skeleton(Skeleton::Humanoid())
+    {
+        cubeMesh = sharedCube;
+        ownsMesh = false;
+        skeleton.buildHierarchy(transforms);
+        pose = skeleton.createPose();
     }
 
     ~Humanoid()
     {
-        if (cubeMesh)
+        if (cubeMesh && ownsMesh)
         {
             delete cubeMesh;
         }
     }
 
+    Humanoid(const Humanoid &) = delete;
+    Humanoid &operator=(const Humanoid &) = delete;
+
     void render(Shader &shader);
-    
 
-    void setTorsoRotation(float angle) { torsoRotation = angle; }
-    void setHeadRotation(float angle) { headRotation = angle; }
+    // Envia as partes para o renderer instanciado em vez de as desenhar uma a uma
+    void submit(CrowdRenderer &crowd);
 
-    void setUpperArmRotation(bool isRight, float angle)
+    void setPosition(const Vec3 &pos)
     {
-        upperArmRotation[isRight ? 1 : 0] = angle;
+        position = pos;
+        transforms.setTranslation(Skeleton::GetRootNode(), pos);
+        rigDirty = true;
     }
 
-    void setForearmRotation(bool isRight, float angle)
+    // Ângulo (radianos) de um joint à volta do seu eixo; é substituído pela animação no próximo animate()
+    void setJointRotation(int joint, float angle)
     {
-        forearmRotation[isRight ? 1 : 0] = angle;
+        pose.rotation(joint) = angle;
+        poseChanged();
     }
 
-    void setThighRotation(bool isRight, float angle)
-    {
-        thighRotation[isRight ? 1 : 0] = angle;
-    }
+    const Skeleton &getSkeleton() const { return skeleton; }
+    const Pose &getPose() const { return pose; }
 
-    void setCalfRotation(bool isRight, float angle)
-    {
-        calfRotation[isRight ? 1 : 0] = angle;
-    }
+    // Matrizes world de todos os nós na ordem de Skeleton::buildHierarchy(), da hierarquia ou do
+    // caminho especializado; válidas depois de updateTransforms()
+    const Mat4 *getWorldMatrices() const { return fixedRig ? rigWorlds.data() : transforms.getWorldMatrices(); }
+
+    // Avalia o rig humanoide com FixedRig em vez da hierarquia genérica (só para Skeleton::Humanoid())
+    void setFixedRig(bool enable);
+    bool isFixedRig() const { return fixedRig; }
 
     void animate(float deltaTime);
-   
-    void playAnimation(const std::string &name)
+
+    // Com LOD: o nível vem da distância à câmara (lod.begin() já chamado neste frame) e o tempo
+    // gasto fica nas estatísticas do lod. Devolve o nível usado.
+    AnimationLodLevel animate(float deltaTime, AnimationLod &lod);
+    // Fase dos níveis reduzidos; personagens vizinhos com fases diferentes espalham o trabalho pelos frames
+    void setLodPhase(int phase) { lodPhase = phase; }
+
+    // Com cache, animate() troca o tempo exato do clip pelo início do balde e copia a pose partilhada
+    void setPoseCache(PoseCache *cache);
+
+    // Recalcula já as matrizes world (render()/submit() ficam só com a leitura); pode correr num job
+    void updateTransforms();
+
+    void playAnimation(ClipId clip, bool loop = true) { player.play(clip, loop); }
+    void playAnimation(const std::string &name, bool loop = true)
     {
-        animManager.playAnimation(name);
+        player.play(AnimationLibrary::Instance().find(name), loop);
     }
 
+    AnimationPlayer &getPlayer() { return player; }
+    void setAnimationTime(float time) { player.seek(time); }
+
 private:
-    void renderCube(Shader &shader, const Mat4 &modelMatrix, const Color &color)
+    // A pose mudou: passa-a para a hierarquia ou marca o rig especializado para reavaliar
+    void poseChanged()
+    {
+        if (fixedRig)
+            rigDirty = true;
+        else
+            skeleton.applyPose(pose, transforms);
+    }
+
+    void renderCube(Shader &shader, UniformHandle model, UniformHandle diffuse, const Mat4 &modelMatrix, const Color &color)
     {
-        shader.SetMatrix4("model", modelMatrix.m);
+        shader.SetMatrix4(model, modelMatrix.m);
         float r = color.r / 255.0f;
         float g = color.g / 255.0f;
         float b = color.b / 255.0f;
 
-        shader.SetFloat("difusse", r, g, b);
+        shader.SetFloat(diffuse, r, g, b);
         cubeMesh->Render(static_cast<int>(PrimitiveType::TRIANGLES), 36);
     }
 };
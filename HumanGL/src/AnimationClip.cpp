@@ -0,0 +1,597 @@
+#include "AnimationClip.hpp"
+#include "Animation.hpp"
+#include <algorithm>
+#include <cmath>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CLIP_HAS_SSE2
+#endif
+
+// Número de keys que o cursor avança linearmente antes de desistir e fazer pesquisa binária
+static const int CURSOR_MAX_STEPS = 4;
+
+// Tracks descomprimidas em blocos deste tamanho antes de irem para os canais da pose
+static const int SAMPLE_BLOCK = 64;
+
+static const float QUANTIZE_LEVELS = 65535.0f;
+static const int QUANTIZE_LANES = 8;
+
+// Até este número de tracks a descompressão é feita aqui mesmo: a chamada ao kernel (dispatch da
+// MathStreams, que não pode ser inlined) custava mais do que as poucas lanes que ele processa
+static const int INLINE_DEQUANTIZE_TRACKS = 2 * QUANTIZE_LANES;
+
+// Uma linha de QUANTIZE_LANES tracks u16 -> float, com SSE2 (sempre presente em x86-64)
+static inline void DequantizeLerpRow(const uint16_t *q0, const uint16_t *q1, const float *offset, const float *scale,
+                                     float t, float *out)
+{
+#if defined(CLIP_HAS_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 vt = _mm_set1_ps(t);
+    const __m128 vta = _mm_set1_ps(1.0f - t);
+    __m128i a = _mm_loadu_si128((const __m128i *)q0);
+    __m128i b = _mm_loadu_si128((const __m128i *)q1);
+    __m128 a0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(a, zero));
+    __m128 a1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(a, zero));
+    __m128 b0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(b, zero));
+    __m128 b1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(b, zero));
+    __m128 r0 = _mm_add_ps(_mm_mul_ps(a0, vta), _mm_mul_ps(b0, vt));
+    __m128 r1 = _mm_add_ps(_mm_mul_ps(a1, vta), _mm_mul_ps(b1, vt));
+    _mm_storeu_ps(out, _mm_add_ps(_mm_loadu_ps(offset), _mm_mul_ps(_mm_loadu_ps(scale), r0)));
+    _mm_storeu_ps(out + 4, _mm_add_ps(_mm_loadu_ps(offset + 4), _mm_mul_ps(_mm_loadu_ps(scale + 4), r1)));
+#else
+    for (int i = 0; i < QUANTIZE_LANES; i++)
+        out[i] = offset[i] + scale[i] * ((float)q0[i] * (1.0f - t) + (float)q1[i] * t);
+#endif
+}
+
+// Linhas de coeficientes das curvas cúbicas também alinhadas às 8 lanes do kernel
+static const int CUBIC_LANES = 8;
+
+// Num segmento de Hermite o termo de uma tangente m afasta a curva dos valores no máximo 4/27 * duração * |m|
+static const float HERMITE_TANGENT_BULGE = 4.0f / 27.0f;
+
+// Com muitos personagens as linhas de keys não estão em cache; pede já a linha do próximo segmento
+static inline void PrefetchRow(const void *row)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(row);
+#else
+    (void)row;
+#endif
+}
+
+// Redução de keys: a partir de um key âncora, cada key seguinte limita o declive da recta
+// âncora -> fim de segmento a um intervalo [lo, hi] por track. O segmento estende-se enquanto o
+// declive até ao key candidato cair dentro de todos os intervalos; custo O(keys * tracks).
+static void ReduceKeys(const std::vector<float> &times, const std::vector<float> &values, int tracks,
+                       const std::vector<float> &tolerances, std::vector<int> &kept)
+{
+    int keyCount = (int)times.size();
+    kept.clear();
+    kept.push_back(0);
+    if (keyCount < 2)
+        return;
+
+    std::vector<float> lo(tracks), hi(tracks);
+    int anchor = 0;
+    std::fill(lo.begin(), lo.end(), -Maxloat);
+    std::fill(hi.begin(), hi.end(), Maxloat);
+
+    for (int j = 1; j < keyCount; j++)
+    {
+        const float *va = &values[(size_t)anchor * tracks];
+        const float *vj = &values[(size_t)j * tracks];
+        float dt = times[j] - times[anchor];
+
+        bool valid = (j == anchor + 1);
+        if (!valid && dt > 0.0f)
+        {
+            valid = true;
+            for (int a = 0; a < tracks && valid; a++)
+            {
+                float slope = (vj[a] - va[a]) / dt;
+                valid = slope >= lo[a] && slope <= hi[a];
+            }
+        }
+
+        if (!valid)
+        {
+            // O último key que ainda fechava um segmento válido passa a ser a nova âncora
+            anchor = j - 1;
+            kept.push_back(anchor);
+            va = &values[(size_t)anchor * tracks];
+            dt = times[j] - times[anchor];
+            std::fill(lo.begin(), lo.end(), -Maxloat);
+            std::fill(hi.begin(), hi.end(), Maxloat);
+        }
+
+        // Restrição que este key impõe aos segmentos que o atravessarem
+        if (dt <= 0.0f)
+        {
+            // Dois keys no mesmo instante (salto): nenhum segmento pode passar por cima
+            std::fill(lo.begin(), lo.end(), Maxloat);
+            std::fill(hi.begin(), hi.end(), -Maxloat);
+            continue;
+        }
+        for (int a = 0; a < tracks; a++)
+        {
+            lo[a] = Max(lo[a], (vj[a] - tolerances[a] - va[a]) / dt);
+            hi[a] = Min(hi[a], (vj[a] + tolerances[a] - va[a]) / dt);
+        }
+    }
+
+    if (kept.back() != keyCount - 1)
+        kept.push_back(keyCount - 1);
+}
+
+void AnimationClip::compile(const Animation &anim, const ClipCompression &compression)
+{
+    loop = anim.loop;
+    duration = anim.duration;
+    channelCount = 0;
+    times.clear();
+    animatedChannels.clear();
+    values.clear();
+    quantized.clear();
+    trackRanges.clear();
+    coefficients.clear();
+    constantChannels.clear();
+    constantValues.clear();
+    stats = ClipStats();
+    attached = false;
+    data = ClipData();
+
+    // Os keys podem ter sido adicionados fora de ordem
+    std::vector<const Keyframe *> keys;
+    keys.reserve(anim.keyframes.size());
+    for (const Keyframe &kf : anim.keyframes)
+    {
+        keys.push_back(&kf);
+        channelCount = Max(channelCount, kf.pose.channelCount());
+    }
+    std::stable_sort(keys.begin(), keys.end(), [](const Keyframe *a, const Keyframe *b)
+                     { return a->time < b->time; });
+
+    if (keys.empty())
+    {
+        bindStorage(0, 0);
+        return;
+    }
+
+    // Fonte em key-major com todos os canais; canais que um key não tem (pose de um rig menor) contam como zero
+    int keyCount = (int)keys.size();
+    std::vector<float> sourceTimes(keyCount);
+    std::vector<float> source((size_t)keyCount * channelCount, 0.0f);
+    for (int k = 0; k < keyCount; k++)
+    {
+        sourceTimes[k] = keys[k]->time;
+        const std::vector<float> &channels = keys[k]->pose.channels;
+        std::copy(channels.begin(), channels.end(), source.begin() + (size_t)k * channelCount);
+    }
+
+    // Derivadas por segundo de cada canal em cada key (só curvas cúbicas)
+    bool cubic = anim.curve == AnimationCurve::CUBIC && keyCount >= 2;
+    std::vector<float> tangents;
+    float maxSpan = 0.0f;
+    if (cubic)
+    {
+        tangents.assign((size_t)keyCount * channelCount, 0.0f);
+        for (int k = 0; k + 1 < keyCount; k++)
+            maxSpan = Max(maxSpan, sourceTimes[k + 1] - sourceTimes[k]);
+
+        int last = keyCount - 1;
+        for (int k = 0; k < keyCount; k++)
+        {
+            const Pose &explicitTangents = keys[k]->tangents;
+
+            // Catmull-Rom: declive entre os vizinhos; nas pontas de um clip em loop os vizinhos dão a volta,
+            // sem loop fica o declive do primeiro/último segmento
+            int prev = Max(k - 1, 0), next = Min(k + 1, last);
+            float span = sourceTimes[next] - sourceTimes[prev];
+            if ((k == 0 || k == last) && anim.loop && keyCount >= 3)
+            {
+                prev = last - 1;
+                next = 1;
+                span = (sourceTimes[1] - sourceTimes[0]) + (sourceTimes[last] - sourceTimes[last - 1]);
+            }
+
+            for (int c = 0; c < channelCount; c++)
+            {
+                float &m = tangents[(size_t)k * channelCount + c];
+                if (c < explicitTangents.channelCount() && !std::isnan(explicitTangents.channels[c]))
+                    m = explicitTangents.channels[c];
+                else if (span > 0.0f)
+                    m = (source[(size_t)next * channelCount + c] - source[(size_t)prev * channelCount + c]) / span;
+            }
+        }
+    }
+
+    // Os primeiros jointCount canais são ângulos, os restantes translações (ver Pose)
+    int rotationChannels = channelCount / 4;
+    std::vector<float> tolerances, trackOffsets, trackScales;
+    for (int c = 0; c < channelCount; c++)
+    {
+        float lo = source[c], hi = source[c];
+        for (int k = 1; k < keyCount; k++)
+        {
+            float v = source[(size_t)k * channelCount + c];
+            lo = Min(lo, v);
+            hi = Max(hi, v);
+        }
+
+        float tolerance = (c < rotationChannels) ? compression.rotationTolerance : compression.translationTolerance;
+        float bulge = 0.0f;
+        for (int k = 0; cubic && k < keyCount; k++)
+            bulge = Max(bulge, HERMITE_TANGENT_BULGE * maxSpan * std::fabs(tangents[(size_t)k * channelCount + c]));
+        if (hi - lo + 2.0f * bulge <= tolerance)
+        {
+            constantChannels.push_back(c);
+            constantValues.push_back(lo == hi ? lo : (lo + hi) * 0.5f);
+            continue;
+        }
+
+        animatedChannels.push_back(c);
+        trackOffsets.push_back(lo);
+        trackScales.push_back((hi - lo) / QUANTIZE_LEVELS);
+        tolerances.push_back(tolerance);
+    }
+
+    int animated = (int)animatedChannels.size();
+    std::vector<float> animatedValues((size_t)keyCount * animated);
+    for (int k = 0; k < keyCount; k++)
+    {
+        for (int a = 0; a < animated; a++)
+        {
+            animatedValues[(size_t)k * animated + a] = source[(size_t)k * channelCount + animatedChannels[a]];
+        }
+    }
+
+    // Curvas cúbicas ficam com todos os keys: a redução e a quantização são para segmentos lineares
+    std::vector<int> kept;
+    if (compression.reduceKeys && animated > 0 && !cubic)
+    {
+        // Parte da tolerância fica reservada para o erro de quantização (meio degrau)
+        std::vector<float> budget(tolerances);
+        if (compression.quantize)
+        {
+            for (int a = 0; a < animated; a++)
+                budget[a] = Max(0.0f, budget[a] - trackScales[a] * 0.5f);
+        }
+        ReduceKeys(sourceTimes, animatedValues, animated, budget, kept);
+    }
+    else if (animated > 0)
+    {
+        for (int k = 0; k < keyCount; k++)
+            kept.push_back(k);
+    }
+    else
+    {
+        kept.push_back(0);
+    }
+
+    times.reserve(kept.size());
+    for (int k : kept)
+    {
+        times.push_back(sourceTimes[k]);
+    }
+
+    int quantizedStride = 0;
+    int coefficientStride = 0;
+    if (animated > 0 && cubic)
+    {
+        // Por segmento: 4 linhas (a, b, c, d) de coefficientStride tracks
+        coefficientStride = (animated + CUBIC_LANES - 1) / CUBIC_LANES * CUBIC_LANES;
+        coefficients.assign((size_t)(keyCount - 1) * 4 * coefficientStride, 0.0f);
+        for (int k = 0; k + 1 < keyCount; k++)
+        {
+            float span = sourceTimes[k + 1] - sourceTimes[k];
+            float *row = &coefficients[(size_t)k * 4 * coefficientStride];
+            for (int a = 0; a < animated; a++)
+            {
+                int c = animatedChannels[a];
+                float p0 = source[(size_t)k * channelCount + c];
+                float p1 = source[(size_t)(k + 1) * channelCount + c];
+                float m0 = tangents[(size_t)k * channelCount + c] * span;
+                float m1 = tangents[(size_t)(k + 1) * channelCount + c] * span;
+                row[a] = 2.0f * p0 - 2.0f * p1 + m0 + m1;
+                row[coefficientStride + a] = -3.0f * p0 + 3.0f * p1 - 2.0f * m0 - m1;
+                row[2 * coefficientStride + a] = m0;
+                row[3 * coefficientStride + a] = p0;
+            }
+        }
+    }
+    else if (animated > 0 && compression.quantize)
+    {
+        // Linhas alinhadas a QUANTIZE_LANES tracks para o kernel não ter cauda escalar
+        quantizedStride = (animated + QUANTIZE_LANES - 1) / QUANTIZE_LANES * QUANTIZE_LANES;
+        trackRanges.assign(quantizedStride * 2, 0.0f);
+        std::copy(trackOffsets.begin(), trackOffsets.end(), trackRanges.begin());
+        std::copy(trackScales.begin(), trackScales.end(), trackRanges.begin() + quantizedStride);
+        quantized.assign(kept.size() * quantizedStride, 0);
+        for (size_t i = 0; i < kept.size(); i++)
+        {
+            const float *row = &animatedValues[(size_t)kept[i] * animated];
+            uint16_t *q = &quantized[i * quantizedStride];
+            for (int a = 0; a < animated; a++)
+            {
+                float level = (row[a] - trackOffsets[a]) / trackScales[a];
+                q[a] = (uint16_t)Clamp((int)std::lround(level), 0, 65535);
+            }
+        }
+    }
+    else
+    {
+        values.resize(kept.size() * animated);
+        for (size_t i = 0; i < kept.size(); i++)
+        {
+            std::copy_n(&animatedValues[(size_t)kept[i] * animated], animated, &values[i * animated]);
+        }
+    }
+
+    stats.sourceKeys = keyCount;
+    stats.keys = (int)times.size();
+    stats.sourceBytes = (size_t)keyCount * (1 + channelCount) * sizeof(float);
+    stats.bytes = times.size() * sizeof(float) +
+                  animatedChannels.size() * sizeof(int) +
+                  values.size() * sizeof(float) +
+                  quantized.size() * sizeof(uint16_t) +
+                  trackRanges.size() * sizeof(float) +
+                  coefficients.size() * sizeof(float) +
+                  constantChannels.size() * (sizeof(int) + sizeof(float));
+
+    bindStorage(quantizedStride, coefficientStride);
+    measure(sourceTimes, source);
+}
+
+void AnimationClip::bindStorage(int quantizedStride, int coefficientStride)
+{
+    data.keyCount = (int)times.size();
+    data.animatedCount = (int)animatedChannels.size();
+    data.constantCount = (int)constantChannels.size();
+    data.quantizedStride = quantizedStride;
+    data.coefficientStride = coefficientStride;
+    data.times = times.data();
+    data.animatedChannels = animatedChannels.data();
+    data.values = values.empty() ? nullptr : values.data();
+    data.quantized = quantized.empty() ? nullptr : quantized.data();
+    data.trackRanges = trackRanges.empty() ? nullptr : trackRanges.data();
+    data.coefficients = coefficients.empty() ? nullptr : coefficients.data();
+    data.constantChannels = constantChannels.data();
+    data.constantValues = constantValues.data();
+}
+
+AnimationClip &AnimationClip::operator=(const AnimationClip &other)
+{
+    if (this == &other)
+        return *this;
+
+    loop = other.loop;
+    duration = other.duration;
+    channelCount = other.channelCount;
+    attached = other.attached;
+    times = other.times;
+    animatedChannels = other.animatedChannels;
+    values = other.values;
+    quantized = other.quantized;
+    trackRanges = other.trackRanges;
+    coefficients = other.coefficients;
+    constantChannels = other.constantChannels;
+    constantValues = other.constantValues;
+    stats = other.stats;
+
+    if (attached)
+        data = other.data;
+    else
+        bindStorage(other.data.quantizedStride, other.data.coefficientStride);
+    return *this;
+}
+
+void AnimationClip::attach(const ClipData &external, float clipDuration, bool clipLoop, int clipChannels, const ClipStats &clipStats)
+{
+    times.clear();
+    animatedChannels.clear();
+    values.clear();
+    quantized.clear();
+    trackRanges.clear();
+    coefficients.clear();
+    constantChannels.clear();
+    constantValues.clear();
+
+    data = external;
+    duration = clipDuration;
+    loop = clipLoop;
+    channelCount = clipChannels;
+    stats = clipStats;
+    attached = true;
+}
+
+void AnimationClip::measure(const std::vector<float> &sourceTimes, const std::vector<float> &sourceValues)
+{
+    // Os dois lados são lineares por troços e os keys compilados são um subconjunto dos
+    // originais, por isso o erro máximo é atingido num key original (as curvas cúbicas
+    // passam pelos keys e mantêm-nos todos: só sobra o arredondamento dos coeficientes)
+    int rotationChannels = channelCount / 4;
+    Pose pose;
+    ClipCursor cursor;
+    initPose(pose);
+    for (size_t k = 0; k < sourceTimes.size(); k++)
+    {
+        sample(sourceTimes[k], cursor, pose);
+        const float *expected = &sourceValues[k * channelCount];
+        for (int c = 0; c < channelCount; c++)
+        {
+            float error = std::fabs(pose.channels[c] - expected[c]);
+            if (c < rotationChannels)
+                stats.maxRotationError = Max(stats.maxRotationError, error);
+            else
+                stats.maxTranslationError = Max(stats.maxTranslationError, error);
+        }
+    }
+}
+
+void AnimationClip::initPose(Pose &out) const
+{
+    out.channels.assign(channelCount, 0.0f);
+    float *po = out.channels.data();
+    for (int i = 0; i < data.constantCount; i++)
+    {
+        po[data.constantChannels[i]] = data.constantValues[i];
+    }
+}
+
+int AnimationClip::findKey(float time, ClipCursor &cursor) const
+{
+    const float *keyTimes = data.times;
+    int last = data.keyCount - 2; // início do último segmento
+    if (last <= 0)
+    {
+        cursor.key = 0;
+        return 0;
+    }
+
+    int k = Clamp(cursor.key, 0, last);
+    if (time >= keyTimes[k])
+    {
+        for (int step = 0; step < CURSOR_MAX_STEPS && k < last && time >= keyTimes[k + 1]; step++)
+        {
+            k++;
+        }
+        if (k == last || time < keyTimes[k + 1])
+        {
+            cursor.key = k;
+            return k;
+        }
+    }
+
+    k = (int)(std::upper_bound(keyTimes, keyTimes + data.keyCount, time) - keyTimes) - 1;
+    k = Clamp(k, 0, last);
+    cursor.key = k;
+    return k;
+}
+
+void AnimationClip::sample(float time, ClipCursor &cursor, Pose &out) const
+{
+    if (data.animatedCount == 0)
+        return;
+
+    assert(out.channelCount() == channelCount && "AnimationClip: pose was not initialized for this clip");
+
+    const float *keyTimes = data.times;
+    int k = findKey(time, cursor);
+    float span = keyTimes[k + 1] - keyTimes[k];
+    float t = (span > 0.0f) ? Clamp((time - keyTimes[k]) / span, 0.0f, 1.0f) : 0.0f;
+
+    int animated = data.animatedCount;
+    const int32_t *channel = data.animatedChannels;
+    float *po = out.channels.data();
+
+    bool hasNext = k + 2 < data.keyCount;
+
+    if (data.coefficients)
+    {
+        // Um passo de Horner por track, em blocos como a descompressão
+        int coefficientStride = data.coefficientStride;
+        const float *segment = &data.coefficients[(size_t)k * 4 * coefficientStride];
+        if (hasNext)
+            PrefetchRow(segment + 4 * coefficientStride);
+        float block[SAMPLE_BLOCK];
+        for (int base = 0; base < animated; base += SAMPLE_BLOCK)
+        {
+            int count = Min(SAMPLE_BLOCK, coefficientStride - base);
+            EvaluateCubics(segment + base, coefficientStride, t, block, count);
+            count = Min(count, animated - base);
+            for (int i = 0; i < count; i++)
+            {
+                po[channel[base + i]] = block[i];
+            }
+        }
+        return;
+    }
+
+    if (!data.quantized)
+    {
+        const float *v0 = &data.values[(size_t)k * animated];
+        const float *v1 = v0 + animated;
+        if (hasNext)
+            PrefetchRow(v1 + animated);
+        for (int a = 0; a < animated; a++)
+        {
+            po[channel[a]] = v0[a] * (1 - t) + v1[a] * t;
+        }
+        return;
+    }
+
+    // Descomprime blocos contíguos com o kernel SIMD e só depois espalha pelos canais da pose
+    int quantizedStride = data.quantizedStride;
+    const uint16_t *q0 = &data.quantized[(size_t)k * quantizedStride];
+    const uint16_t *q1 = q0 + quantizedStride;
+    if (hasNext)
+        PrefetchRow(q1 + quantizedStride);
+    const float *offset = data.trackRanges;
+    const float *scale = offset + quantizedStride;
+    float block[SAMPLE_BLOCK];
+    if (animated <= INLINE_DEQUANTIZE_TRACKS)
+    {
+        // As linhas têm quantizedStride (múltiplo de QUANTIZE_LANES) tracks, por isso ler a linha toda é seguro
+        for (int base = 0; base < animated; base += QUANTIZE_LANES)
+            DequantizeLerpRow(q0 + base, q1 + base, offset + base, scale + base, t, block + base);
+        for (int a = 0; a < animated; a++)
+            po[channel[a]] = block[a];
+        return;
+    }
+    for (int base = 0; base < animated; base += SAMPLE_BLOCK)
+    {
+        int count = Min(SAMPLE_BLOCK, quantizedStride - base);
+        DequantizeLerp(q0 + base, q1 + base, offset + base, scale + base, t, block, count);
+        count = Min(count, animated - base);
+        for (int i = 0; i < count; i++)
+        {
+            po[channel[base + i]] = block[i];
+        }
+    }
+}
+
+void AnimationClip::sampleRoot(float time, ClipCursor &cursor, Pose &out) const
+{
+    // Sem joints completos não há raiz (e o % abaixo dividiria por zero)
+    int jointCount = channelCount / 4;
+    if (data.animatedCount == 0 || jointCount == 0)
+        return;
+
+    assert(out.channelCount() == channelCount && "AnimationClip: pose was not initialized for this clip");
+
+    const float *keyTimes = data.times;
+    int k = findKey(time, cursor);
+    float span = keyTimes[k + 1] - keyTimes[k];
+    float t = (span > 0.0f) ? Clamp((time - keyTimes[k]) / span, 0.0f, 1.0f) : 0.0f;
+
+    // Canal c pertence ao joint c % jointCount; os canais animados estão por ordem
+    float *po = out.channels.data();
+    for (int a = 0; a < data.animatedCount; a++)
+    {
+        int channel = data.animatedChannels[a];
+        if (channel % jointCount != 0)
+            continue;
+
+        float v;
+        if (data.coefficients)
+        {
+            int stride = data.coefficientStride;
+            const float *c = &data.coefficients[(size_t)k * 4 * stride + a];
+            v = ((c[0] * t + c[stride]) * t + c[2 * stride]) * t + c[3 * stride];
+        }
+        else if (!data.quantized)
+        {
+            const float *v0 = &data.values[(size_t)k * data.animatedCount];
+            v = v0[a] * (1 - t) + v0[data.animatedCount + a] * t;
+        }
+        else
+        {
+            const uint16_t *q0 = &data.quantized[(size_t)k * data.quantizedStride];
+            float q = (float)q0[a] * (1 - t) + (float)q0[data.quantizedStride + a] * t;
+            v = data.trackRanges[a] + data.trackRanges[data.quantizedStride + a] * q;
+        }
+        po[channel] = v;
+    }
+}
+
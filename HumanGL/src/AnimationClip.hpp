@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Skeleton.hpp"
+
+class Animation;
+
+// Posição de leitura de um player dentro de um clip: key no início do segmento atual.
+// Em reprodução para a frente o próximo segmento está quase sempre a 0 ou 1 keys de distância.
+struct ClipCursor
+{
+    int key = 0;
+};
+
+// Interpolação entre os keys de uma Animation
+enum class AnimationCurve
+{
+    LINEAR = 0,
+    // Hermite cúbica: tangentes dos keys (Keyframe::tangents) ou, sem elas, Catmull-Rom
+    // (diferenças centradas; nas pontas de um clip com loop dão a volta, sem loop usam o segmento da ponta)
+    CUBIC,
+};
+
+// Parâmetros de compressão de um clip. As tolerâncias são o erro máximo aceite por canal
+// (rotações em radianos, translações em unidades do mundo).
+struct ClipCompression
+{
+    bool quantize = true;   // tracks animadas em 16 bits relativas ao intervalo [min, max] de cada track
+    bool reduceKeys = true; // remove keys que a interpolação entre os vizinhos reproduz dentro da tolerância
+    float rotationTolerance = ToRadians(0.1f);
+    float translationTolerance = 0.001f;
+
+    static ClipCompression Lossless()
+    {
+        ClipCompression c;
+        c.quantize = false;
+        c.reduceKeys = false;
+        c.rotationTolerance = 0.0f;
+        c.translationTolerance = 0.0f;
+        return c;
+    }
+};
+
+// Resultado de compile(): tamanho antes/depois e erro máximo medido em todos os keys originais
+struct ClipStats
+{
+    int sourceKeys = 0;
+    int keys = 0;
+    size_t sourceBytes = 0; // tempos + poses completas dos keyframes
+    size_t bytes = 0;       // dados do clip compilado
+    float maxRotationError = 0.0f;    // radianos
+    float maxTranslationError = 0.0f;
+
+    float ratio() const { return bytes ? (float)sourceBytes / (float)bytes : 0.0f; }
+};
+
+// Vista sobre os dados de um clip compilado. Aponta para os vectors do próprio clip ou, num clip
+// carregado de um ficheiro binário (ClipFile), diretamente para a memória mapeada do ficheiro.
+struct ClipData
+{
+    int keyCount = 0;
+    int animatedCount = 0;
+    int constantCount = 0;
+    int quantizedStride = 0; // 0 = valores em float
+    int coefficientStride = 0; // > 0 = tracks cúbicas (sem values nem quantized)
+
+    const float *times = nullptr;            // keyCount
+    const int32_t *animatedChannels = nullptr; // animatedCount
+    const float *values = nullptr;           // keyCount x animatedCount (sem quantização)
+    const uint16_t *quantized = nullptr;     // keyCount x quantizedStride
+    const float *trackRanges = nullptr;      // [offset x quantizedStride][scale x quantizedStride]
+    const float *coefficients = nullptr;     // (keyCount - 1) segmentos x 4 linhas x coefficientStride
+    const int32_t *constantChannels = nullptr; // constantCount
+    const float *constantValues = nullptr;     // constantCount
+};
+
+// Clip compilado a partir de uma Animation (keyframes com poses completas).
+// Cada canal da pose vira uma track:
+//   - canais com o mesmo valor em todos os keys (ou clip com um só key) são constantes
+//     e escritos uma única vez por initPose();
+//   - os restantes são guardados key-major (values[key * animados + track]), por isso
+//     os dois keys de um segmento ficam em memória contígua.
+// Com compressão, os keys redundantes são removidos (para todas as tracks ao mesmo tempo, o
+// cursor continua a ser um só) e os valores passam a u16: v = offset + scale * q.
+// Clips AnimationCurve::CUBIC guardam, em vez dos valores, os coeficientes de cada segmento já
+// calculados (v = ((a * u + b) * u + c) * u + d, u em [0, 1] dentro do segmento), em float e com
+// todos os keys; amostrar é um passo de Horner por track.
+class AnimationClip
+{
+public:
+    AnimationClip() {}
+    explicit AnimationClip(const Animation &anim) { compile(anim); }
+    AnimationClip(const Animation &anim, const ClipCompression &compression) { compile(anim, compression); }
+
+    // A vista tem de voltar a apontar para os vectors da cópia
+    AnimationClip(const AnimationClip &other) { *this = other; }
+    AnimationClip &operator=(const AnimationClip &other);
+    AnimationClip(AnimationClip &&other) { *this = other; }
+    AnimationClip &operator=(AnimationClip &&other) { return *this = other; }
+
+    void compile(const Animation &anim) { compile(anim, ClipCompression::Lossless()); }
+    void compile(const Animation &anim, const ClipCompression &compression);
+
+    // Usa dados externos sem os copiar (p.ex. um ficheiro mapeado), que têm de viver mais que o clip
+    void attach(const ClipData &external, float duration, bool loop, int channelCount, const ClipStats &stats);
+    bool isAttached() const { return attached; }
+    const ClipData &getData() const { return data; }
+
+    const ClipStats &getStats() const { return stats; }
+    bool isQuantized() const { return data.quantizedStride > 0; }
+    bool isCubic() const { return data.coefficientStride > 0; }
+
+    float getDuration() const { return duration; }
+    bool isLooping() const { return loop; }
+    int getKeyCount() const { return data.keyCount; }
+    int getChannelCount() const { return channelCount; }
+    int getAnimatedChannelCount() const { return data.animatedCount; }
+    int getConstantChannelCount() const { return data.constantCount; }
+
+    // Dimensiona a pose e escreve os canais constantes; chamar ao trocar de clip
+    void initPose(Pose &out) const;
+
+    // Escreve apenas os canais animados; out tem de ter passado por initPose()
+    void sample(float time, ClipCursor &cursor, Pose &out) const;
+
+    // Como sample(), mas só os canais do joint 0 (a raiz do rig: rotação e translação);
+    // para personagens longe da câmara (animation LOD)
+    void sampleRoot(float time, ClipCursor &cursor, Pose &out) const;
+
+    // Segmento [times[k], times[k + 1]) que contém time. Avança o cursor alguns keys
+    // e, se não chegar (seek, volta do loop), cai numa pesquisa binária.
+    int findKey(float time, ClipCursor &cursor) const;
+
+private:
+    bool loop = true;
+    float duration = 0.0f;
+    int channelCount = 0;
+    bool attached = false;
+    ClipData data;
+
+    // Dados de um clip compilado em memória (vazios num clip attach())
+    std::vector<float> times;
+    std::vector<int32_t> animatedChannels;
+    std::vector<float> values;
+    std::vector<uint16_t> quantized; // key-major, quantizedStride u16 por key
+    std::vector<float> trackRanges;
+    std::vector<float> coefficients;
+    std::vector<int32_t> constantChannels;
+    std::vector<float> constantValues;
+    ClipStats stats;
+
+    void bindStorage(int quantizedStride, int coefficientStride);
+    void measure(const std::vector<float> &sourceTimes, const std::vector<float> &sourceValues);
+};
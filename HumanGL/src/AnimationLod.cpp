@@ -0,0 +1,96 @@
+#include "AnimationLod.hpp"
+#include <cstring>
+
+void AnimationLod::begin(const Camera &camera)
+{
+    cameraPosition = camera.getPosition();
+    projectionScale = camera.getProjectionMatrix().m[5];
+    frame++;
+
+    if (workers.empty())
+    {
+        timerOverhead = ~(Uint64)0;
+        for (int i = 0; i < 16; i++)
+        {
+            Uint64 start = SDL_GetPerformanceCounter();
+            timerOverhead = Min(timerOverhead, SDL_GetPerformanceCounter() - start);
+        }
+    }
+    workers.resize(GetJobWorkerCount());
+    std::memset(workers.data(), 0, workers.size() * sizeof(WorkerStats));
+}
+
+void AnimationLod::end()
+{
+    double toMs = 1000.0 / SDL_GetPerformanceFrequency();
+    for (int level = 0; level < ANIM_LOD_COUNT; level++)
+    {
+        int count = 0;
+        int timed = 0;
+        Uint64 ticks = 0;
+        for (const WorkerStats &worker : workers)
+        {
+            count += worker.count[level];
+            timed += worker.timed[level];
+            ticks += worker.ticks[level];
+        }
+        stats.count[level] = count;
+        stats.ms[level] = timed > 0 ? (float)(ticks * toMs * count / timed) : 0.0f;
+    }
+}
+
+float AnimationLod::projectedSize(const Vec3 &position) const
+{
+    float distance = (position - cameraPosition).length();
+    if (distance <= 0.0f)
+        return Maxloat;
+    return settings.characterHeight * projectionScale / (2.0f * distance);
+}
+
+AnimationLodLevel AnimationLod::select(const Vec3 &position) const
+{
+    if (!enabled)
+        return ANIM_LOD_FULL;
+
+    float size = projectedSize(position);
+    if (size >= settings.fullSize)
+        return ANIM_LOD_FULL;
+    if (size >= settings.interpolatedSize)
+        return ANIM_LOD_INTERPOLATED;
+    if (size >= settings.rootSize)
+        return ANIM_LOD_ROOT;
+    return ANIM_LOD_FROZEN;
+}
+
+int AnimationLod::getInterval(AnimationLodLevel level) const
+{
+    switch (level)
+    {
+    case ANIM_LOD_INTERPOLATED:
+        return Max(1, settings.interpolatedInterval);
+    case ANIM_LOD_ROOT:
+        return Max(1, settings.rootInterval);
+    default:
+        return 1;
+    }
+}
+
+bool AnimationLod::isUpdateFrame(AnimationLodLevel level, int phase) const
+{
+    return (frame + (unsigned int)phase) % (unsigned int)getInterval(level) == 0;
+}
+
+void AnimationLod::record(AnimationLodLevel level, bool timed, Uint64 ticks)
+{
+    if (workers.empty())
+        return;
+    int worker = GetJobWorkerIndex();
+    if (worker < 0 || worker >= (int)workers.size())
+        worker = 0;
+    workers[worker].count[level]++;
+    if (timed)
+    {
+        workers[worker].timed[level]++;
+        workers[worker].ticks[level] += ticks > timerOverhead ? ticks - timerOverhead : 0;
+    }
+}
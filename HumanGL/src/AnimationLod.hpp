@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+#include "Core.hpp"
+
+// Níveis de detalhe da animação, do mais perto para o mais longe da câmara
+enum AnimationLodLevel
+{
+    ANIM_LOD_FULL = 0,     // amostrado todos os frames
+    ANIM_LOD_INTERPOLATED, // amostrado a cada interpolatedInterval frames; entre amostras interpola até à pose seguinte
+    ANIM_LOD_ROOT,         // só os canais da raiz, a cada rootInterval frames
+    ANIM_LOD_FROZEN,       // a pose fica parada (o tempo do clip continua a andar)
+    ANIM_LOD_COUNT
+};
+
+struct AnimationLodSettings
+{
+    // Limites pela altura do personagem no ecrã, em fração da altura da janela
+    float fullSize = 0.15f;
+    float interpolatedSize = 0.05f;
+    float rootSize = 0.015f;
+    int interpolatedInterval = 4;
+    int rootInterval = 8;
+    float characterHeight = 4.0f; // altura do rig em unidades do mundo
+};
+
+// Escolhe o nível de cada personagem a partir da câmara e junta o tempo gasto por nível.
+// begin() uma vez por frame antes da animação, end() depois; entre os dois, select()/isUpdateFrame()
+// e record() podem ser chamados de qualquer worker do job system.
+class AnimationLod
+{
+public:
+    struct Stats
+    {
+        int count[ANIM_LOD_COUNT] = {};
+        float ms[ANIM_LOD_COUNT] = {};
+    };
+
+    AnimationLodSettings settings;
+    bool enabled = true;
+
+    void begin(const Camera &camera);
+    void end();
+
+    // Altura projetada de um personagem em position, em fração da altura do ecrã
+    float projectedSize(const Vec3 &position) const;
+    AnimationLodLevel select(const Vec3 &position) const;
+
+    // Os personagens com fases diferentes atualizam em frames diferentes, para o custo dos níveis
+    // reduzidos ficar distribuído em vez de cair todo no mesmo frame
+    bool isUpdateFrame(AnimationLodLevel level, int phase) const;
+    int getInterval(AnimationLodLevel level) const;
+
+    // Ler o relógio custa tanto como animar um personagem dos níveis baratos, por isso só uma
+    // amostra (1 em TIMING_STRIDE, rodando a cada frame) é cronometrada e os tempos são extrapolados.
+    // A amostra é feita por blocos de fases consecutivas para apanhar todas as fases de atualização.
+    bool isTimed(int phase) const { return (frame + (unsigned int)phase / TIMING_STRIDE) % TIMING_STRIDE == 0; }
+    void record(AnimationLodLevel level, bool timed, Uint64 ticks);
+
+    // Contagens e tempos do último frame terminado com end()
+    const Stats &getStats() const { return stats; }
+
+private:
+    static const unsigned int TIMING_STRIDE = 8;
+
+    struct alignas(64) WorkerStats
+    {
+        int count[ANIM_LOD_COUNT];
+        int timed[ANIM_LOD_COUNT];
+        Uint64 ticks[ANIM_LOD_COUNT];
+    };
+
+    Vec3 cameraPosition;
+    float projectionScale = 1.0f; // 1 / tan(fov / 2)
+    unsigned int frame = 0;
+    Uint64 timerOverhead = 0; // ticks entre duas leituras seguidas do relógio, descontados a cada medida
+    std::vector<WorkerStats> workers;
+    Stats stats;
+};
@@ -0,0 +1,275 @@
+#include "AnimationPalette.hpp"
+#include <cmath>
+
+static const int PALETTE_MAGIC = 0x4C415048; // "HPAL"
+static const int PALETTE_VERSION = 1;
+
+// Lista de clips a amostrar sem repetidos; vazia quer dizer a biblioteca toda
+static bool ResolveClips(const AnimationLibrary &library, const std::vector<ClipId> &requested, std::vector<ClipId> &out)
+{
+    out.clear();
+    if (requested.empty())
+    {
+        for (ClipId id = 0; id < library.getClipCount(); id++)
+            out.push_back(id);
+    }
+    for (ClipId id : requested)
+    {
+        if (id < 0 || id >= library.getClipCount())
+        {
+            LogError("[BAKE] Invalid clip id %d", id);
+            return false;
+        }
+        bool repeated = false;
+        for (ClipId other : out)
+            repeated = repeated || other == id;
+        if (!repeated)
+            out.push_back(id);
+    }
+    if ((int)out.size() > AnimationPalette::MAX_CLIPS)
+    {
+        LogError("[BAKE] %d clips do not fit in the shader clip table (max %d)", (int)out.size(), AnimationPalette::MAX_CLIPS);
+        return false;
+    }
+    return true;
+}
+
+bool AnimationPalette::bake(const AnimationLibrary &library, const Skeleton &skeleton, float rate, const std::vector<ClipId> &requested)
+{
+    jointCount = skeleton.getJointCount();
+    sampleRate = rate;
+    frameCount = 0;
+    clips.clear();
+    ids.clear();
+    names.clear();
+    frames.clear();
+
+    std::vector<ClipId> selected;
+    if (!ResolveClips(library, requested, selected))
+        return false;
+
+    // Personagem na origem: o shader soma a posição de cada instância
+    TransformHierarchy transforms;
+    skeleton.buildHierarchy(transforms);
+    Pose pose;
+
+    int rowFloats = getWidth() * 4;
+    for (ClipId id : selected)
+    {
+        const AnimationClip &clip = library.getClip(id);
+        float duration = clip.getDuration();
+
+        BakedClip baked;
+        baked.firstFrame = frameCount;
+        baked.loop = clip.isLooping();
+        int segments = (duration > 0.0f) ? Max(1, (int)std::ceil(duration * rate - 0.001f)) : 0;
+        baked.frameCount = baked.loop ? Max(1, segments) : segments + 1;
+        baked.frameRate = (segments > 0) ? (float)segments / duration : 0.0f;
+
+        ClipCursor cursor;
+        clip.initPose(pose);
+        for (int f = 0; f < baked.frameCount; f++)
+        {
+            float time = (baked.frameRate > 0.0f) ? Min((float)f / baked.frameRate, duration) : 0.0f;
+            clip.sample(time, cursor, pose);
+            skeleton.applyPose(pose, transforms);
+            transforms.update();
+
+            size_t row = frames.size();
+            frames.resize(row + rowFloats);
+            float *out = &frames[row];
+            for (int joint = 0; joint < jointCount; joint++)
+            {
+                const float *m = transforms.getWorld(skeleton.getShapeNode(joint)).m;
+                for (int r = 0; r < 3; r++)
+                {
+                    *out++ = m[r];
+                    *out++ = m[4 + r];
+                    *out++ = m[8 + r];
+                    *out++ = m[12 + r];
+                }
+            }
+        }
+
+        frameCount += baked.frameCount;
+        clips.push_back(baked);
+        ids.push_back(id);
+        names.push_back(library.getName(id));
+
+        LogInfo("[BAKE] Clip %s: %d frames at %.1f fps, %d joints, %.1f KB",
+                library.getName(id).c_str(), baked.frameCount, baked.frameRate, jointCount, baked.bytes(jointCount) / 1024.0f);
+    }
+
+    LogInfo("[BAKE] Palette: %d clips, %d frames at %.0f fps, %dx%d RGBA32F, %.1f KB",
+            getClipCount(), frameCount, sampleRate, getWidth(), frameCount, getBytes() / 1024.0f);
+    return true;
+}
+
+int AnimationPalette::getSlot(ClipId id) const
+{
+    for (size_t slot = 0; slot < ids.size(); slot++)
+        if (ids[slot] == id)
+            return (int)slot;
+    return -1;
+}
+
+bool AnimationPalette::save(const std::string &path) const
+{
+    FileStream file;
+    if (!file.Create(path, true))
+    {
+        LogError("[BAKE] Cannot write %s", path.c_str());
+        return false;
+    }
+
+    file.WriteInt(PALETTE_MAGIC);
+    file.WriteInt(PALETTE_VERSION);
+    file.WriteFloat(sampleRate);
+    file.WriteInt(jointCount);
+    file.WriteInt(frameCount);
+    file.WriteInt(getClipCount());
+    for (size_t i = 0; i < clips.size(); i++)
+    {
+        file.WriteString(names[i]);
+        file.WriteInt(clips[i].firstFrame);
+        file.WriteInt(clips[i].frameCount);
+        file.WriteFloat(clips[i].frameRate);
+        file.WriteByte(clips[i].loop ? 1 : 0);
+    }
+    file.Write(frames.data(), (int)getBytes());
+    file.Close();
+
+    LogInfo("[BAKE] Saved %s (%.1f KB)", path.c_str(), getBytes() / 1024.0f);
+    return true;
+}
+
+bool AnimationPalette::load(const std::string &path, const AnimationLibrary &library, const Skeleton &skeleton, const std::vector<ClipId> &requested)
+{
+    if (!FileExists(path.c_str()))
+        return false;
+
+    FileStream file;
+    if (!file.Open(path, "rb"))
+        return false;
+
+    if (file.ReadInt() != PALETTE_MAGIC || file.ReadInt() != PALETTE_VERSION)
+    {
+        LogWarning("[BAKE] %s is not a palette file", path.c_str());
+        file.Close();
+        return false;
+    }
+
+    float rate = file.ReadFloat();
+    int joints = file.ReadInt();
+    int totalFrames = file.ReadInt();
+    int clipCount = file.ReadInt();
+    if (joints != skeleton.getJointCount())
+    {
+        LogWarning("[BAKE] %s was baked for another rig", path.c_str());
+        file.Close();
+        return false;
+    }
+    if (clipCount <= 0 || clipCount > MAX_CLIPS || totalFrames <= 0)
+    {
+        LogWarning("[BAKE] %s: invalid table (%d clips, %d frames)", path.c_str(), clipCount, totalFrames);
+        file.Close();
+        return false;
+    }
+
+    std::vector<BakedClip> loadedClips(clipCount);
+    std::vector<ClipId> loadedIds(clipCount);
+    std::vector<std::string> loadedNames(clipCount);
+    for (int i = 0; i < clipCount; i++)
+    {
+        loadedNames[i] = file.ReadString();
+        loadedClips[i].firstFrame = file.ReadInt();
+        loadedClips[i].frameCount = file.ReadInt();
+        loadedClips[i].frameRate = file.ReadFloat();
+        loadedClips[i].loop = file.ReadByte() != 0;
+        loadedIds[i] = library.find(loadedNames[i]);
+        if (loadedIds[i] == INVALID_CLIP)
+        {
+            LogWarning("[BAKE] %s: clip %s is not in the library", path.c_str(), loadedNames[i].c_str());
+            file.Close();
+            return false;
+        }
+        // O shader lê firstFrame + frameCount - 1 sem verificar limites
+        const BakedClip &clip = loadedClips[i];
+        if (clip.firstFrame < 0 || clip.frameCount <= 0 || (int64_t)clip.firstFrame + clip.frameCount > totalFrames ||
+            !std::isfinite(clip.frameRate) || clip.frameRate < 0.0f)
+        {
+            LogWarning("[BAKE] %s: clip %s has frames %d..%d outside of %d", path.c_str(), loadedNames[i].c_str(),
+                       clip.firstFrame, clip.firstFrame + clip.frameCount, totalFrames);
+            file.Close();
+            return false;
+        }
+    }
+
+    std::vector<ClipId> selected;
+    if (!ResolveClips(library, requested, selected))
+    {
+        file.Close();
+        return false;
+    }
+    for (ClipId id : selected)
+    {
+        bool found = false;
+        for (ClipId other : loadedIds)
+            found = found || other == id;
+        if (!found)
+        {
+            LogWarning("[BAKE] %s does not have clip %s", path.c_str(), library.getName(id).c_str());
+            file.Close();
+            return false;
+        }
+    }
+
+    std::vector<float> loadedFrames((size_t)totalFrames * joints * 3 * 4);
+    size_t bytes = loadedFrames.size() * sizeof(float);
+    bool complete = file.Read(loadedFrames.data(), (int)bytes) == bytes;
+    file.Close();
+    if (!complete)
+    {
+        LogWarning("[BAKE] %s is truncated", path.c_str());
+        return false;
+    }
+
+    sampleRate = rate;
+    jointCount = joints;
+    frameCount = totalFrames;
+    clips.swap(loadedClips);
+    ids.swap(loadedIds);
+    names.swap(loadedNames);
+    frames.swap(loadedFrames);
+
+    LogInfo("[BAKE] Loaded %s: %d clips, %d frames, %.1f KB", path.c_str(), clipCount, frameCount, getBytes() / 1024.0f);
+    return true;
+}
+
+bool AnimationPalette::upload()
+{
+    if (frames.empty())
+        return false;
+    return texture.LoadFloat(frames.data(), getWidth(), frameCount);
+}
+
+void AnimationPalette::bind(Shader &shader, unsigned int unit)
+{
+    // Tabela de clips: (primeiro frame, nº de frames, frames por segundo, loop)
+    // bake()/load() garantem que a tabela cabe no uniform; os registos guardam o slot
+    float table[MAX_CLIPS * 4] = {};
+    assert(getClipCount() <= MAX_CLIPS && "AnimationPalette: clip table overflow");
+    int count = getClipCount();
+    for (int i = 0; i < count; i++)
+    {
+        table[i * 4 + 0] = (float)clips[i].firstFrame;
+        table[i * 4 + 1] = (float)clips[i].frameCount;
+        table[i * 4 + 2] = clips[i].frameRate;
+        table[i * 4 + 3] = clips[i].loop ? 1.0f : 0.0f;
+    }
+
+    texture.Use(unit);
+    shader.SetInt("palette", (int)unit);
+    shader.SetInt("jointCount", jointCount);
+    shader.SetFloat4Array("clipTable", table, count);
+}
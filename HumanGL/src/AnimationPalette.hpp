@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Core.hpp"
+#include "Animation.hpp"
+
+// Onde ficam os frames de um clip dentro da palette
+struct BakedClip
+{
+    int firstFrame = 0;
+    int frameCount = 0;
+    float frameRate = 0.0f; // frames por segundo deste clip (ajustado para a duração caber num número inteiro de frames)
+    bool loop = true;
+
+    size_t bytes(int jointCount) const { return (size_t)frameCount * jointCount * 3 * 4 * sizeof(float); }
+};
+
+// Clips da AnimationLibrary pré-amostrados a uma taxa fixa numa textura de matrizes por joint
+// ("matrix palette"), para a multidão ser avaliada no vertex shader.
+//   - cada linha da textura é um frame; cada joint ocupa 3 texels RGBA32F com as 3 primeiras
+//     linhas da matriz do cubo do joint (afim, relativa à raiz do personagem);
+//   - os clips ficam uns a seguir aos outros; clips em loop não repetem o frame final
+//     (é igual ao primeiro), os restantes guardam-no para o shader poder parar nele;
+//   - o shader não vê ids da biblioteca: cada clip amostrado ocupa uma entrada ("slot") da
+//     tabela de clips, no máximo MAX_CLIPS, e os registos das instâncias guardam o slot.
+// Pode ser gerada ao arrancar (bake) ou num passo offline e lida depois (save/load).
+class AnimationPalette
+{
+public:
+    AnimationPalette() {}
+
+    // Amostra os clips pedidos (toda a biblioteca se a lista vier vazia) a sampleRate frames
+    // por segundo, pela ordem dada. Recusa se forem mais do que MAX_CLIPS.
+    bool bake(const AnimationLibrary &library, const Skeleton &skeleton, float sampleRate,
+              const std::vector<ClipId> &ids = std::vector<ClipId>());
+
+    // Ficheiro binário com a tabela de clips (por nome) e os frames. load() resolve os nomes na
+    // biblioteca e falha se algum não existir ou se faltar algum dos clips pedidos.
+    bool save(const std::string &path) const;
+    bool load(const std::string &path, const AnimationLibrary &library, const Skeleton &skeleton,
+              const std::vector<ClipId> &ids = std::vector<ClipId>());
+
+    // Cria a textura; os dados ficam em CPU (getFrames) para poderem ser gravados
+    bool upload();
+    void bind(Shader &shader, unsigned int unit = 0);
+
+    void release() { texture.Release(); }
+
+    int getJointCount() const { return jointCount; }
+    int getFrameCount() const { return frameCount; }
+    int getClipCount() const { return (int)clips.size(); }
+    float getSampleRate() const { return sampleRate; }
+    const BakedClip &getClip(int slot) const { return clips[slot]; }
+    // Slot do clip na tabela do shader, -1 se não foi amostrado
+    int getSlot(ClipId id) const;
+    const std::vector<float> &getFrames() const { return frames; }
+    size_t getBytes() const { return frames.size() * sizeof(float); }
+
+    // Largura da textura em texels e tamanhos das tabelas uniformes do shader
+    int getWidth() const { return jointCount * 3; }
+    static constexpr int MAX_CLIPS = 64;
+    static constexpr int MAX_JOINTS = 32;
+
+private:
+    AnimationPalette(const AnimationPalette &) = delete;
+    AnimationPalette &operator=(const AnimationPalette &) = delete;
+
+    int jointCount = 0;
+    int frameCount = 0;
+    float sampleRate = 0.0f;
+    std::vector<BakedClip> clips;
+    std::vector<ClipId> ids; // slot -> id na biblioteca
+    std::vector<std::string> names;
+    std::vector<float> frames; // frameCount x jointCount x 3 x vec4
+    Texture2D texture;
+};
@@ -0,0 +1,508 @@
+#include "ClipFile.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+static const char CLIP_FILE_MAGIC[4] = {'H', 'C', 'L', 'P'};
+static const uint32_t CLIP_FILE_ALIGN = 16;
+// Limite de sanidade: a duração dimensiona os baldes do PoseCache e os frames da palette
+static const float CLIP_FILE_MAX_DURATION = 3600.0f;
+// AnimationClip lê as linhas u16 em grupos de 8 tracks (compile() arredonda quantizedStride a este múltiplo)
+static const size_t CLIP_FILE_QUANTIZE_LANES = 8;
+
+//***********************************************************************************************************
+// Texto
+
+static bool ParseAxis(const std::string &name, JointAxis &axis)
+{
+    if (name == "X" || name == "x")
+        axis = JointAxis::X;
+    else if (name == "Y" || name == "y")
+        axis = JointAxis::Y;
+    else if (name == "Z" || name == "z")
+        axis = JointAxis::Z;
+    else
+        return false;
+    return true;
+}
+
+bool ParseClipText(const char *text, Skeleton &skeleton, std::vector<Animation> &animations)
+{
+    std::istringstream stream(text);
+    std::string line;
+    int lineNumber = 0;
+    const Skeleton *rig = &Skeleton::Humanoid();
+    Animation *clip = nullptr;
+    Keyframe *key = nullptr;
+
+    while (std::getline(stream, line))
+    {
+        lineNumber++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+
+        std::istringstream in(line);
+        std::string command;
+        if (!(in >> command))
+            continue;
+
+        if (command == "joint")
+        {
+            if (!animations.empty())
+            {
+                LogError("[CLIPS] line %d: joints must come before the first clip", lineNumber);
+                return false;
+            }
+            if (rig != &skeleton)
+            {
+                skeleton = Skeleton();
+                rig = &skeleton;
+            }
+
+            std::string name, parentName, axisName;
+            Vec3 offset, shapeOffset, shapeScale;
+            int r, g, b;
+            JointAxis axis;
+            in >> name >> parentName >> offset.x >> offset.y >> offset.z >> axisName >> shapeOffset.x >> shapeOffset.y >> shapeOffset.z >> shapeScale.x >> shapeScale.y >> shapeScale.z >> r >> g >> b;
+            int parent = (parentName == "-") ? -1 : skeleton.findJoint(parentName);
+            if (in.fail() || !ParseAxis(axisName, axis) || (parentName != "-" && parent < 0))
+            {
+                LogError("[CLIPS] line %d: bad joint", lineNumber);
+                return false;
+            }
+            skeleton.addJoint(name, parent, offset, axis, shapeOffset, shapeScale, Color((u8)r, (u8)g, (u8)b));
+        }
+        else if (command == "clip")
+        {
+            std::string name, mode = "loop", curve = "linear";
+            in >> name >> mode >> curve;
+            if (name.empty() || (mode != "loop" && mode != "once") || (curve != "linear" && curve != "cubic"))
+            {
+                LogError("[CLIPS] line %d: bad clip", lineNumber);
+                return false;
+            }
+            animations.emplace_back(name, mode == "loop");
+            clip = &animations.back();
+            clip->curve = (curve == "cubic") ? AnimationCurve::CUBIC : AnimationCurve::LINEAR;
+            key = nullptr;
+        }
+        else if (command == "key")
+        {
+            float time = 0.0f;
+            if (!clip || !(in >> time))
+            {
+                LogError("[CLIPS] line %d: key outside a clip", lineNumber);
+                return false;
+            }
+            clip->addKeyframe(rig->createPose(), time);
+            key = &clip->keyframes.back();
+        }
+        else if (command == "rot" || command == "pos" || command == "tanrot" || command == "tanpos")
+        {
+            std::string jointName;
+            in >> jointName;
+            int joint = rig->findJoint(jointName);
+            if (!key || joint < 0)
+            {
+                LogError("[CLIPS] line %d: unknown joint '%s' or channel outside a key", lineNumber, jointName.c_str());
+                return false;
+            }
+
+            // Tangentes por preencher ficam NaN (automáticas)
+            bool tangent = command == "tanrot" || command == "tanpos";
+            if (tangent && key->tangents.channelCount() == 0)
+                key->tangents.channels.assign(key->pose.channelCount(), NAN);
+            Pose &target = tangent ? key->tangents : key->pose;
+
+            if (command == "rot" || command == "tanrot")
+            {
+                float degrees = 0.0f;
+                in >> degrees;
+                target.rotation(joint) = ToRadians(degrees);
+            }
+            else
+            {
+                Vec3 t;
+                in >> t.x >> t.y >> t.z;
+                target.setTranslation(joint, t);
+            }
+            if (in.fail())
+            {
+                LogError("[CLIPS] line %d: bad channel value", lineNumber);
+                return false;
+            }
+        }
+        else
+        {
+            LogError("[CLIPS] line %d: unknown command '%s'", lineNumber, command.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+//***********************************************************************************************************
+// Escrita
+
+namespace
+{
+    struct ClipFileWriter
+    {
+        std::vector<unsigned char> bytes;
+
+        uint32_t align()
+        {
+            while (bytes.size() % CLIP_FILE_ALIGN)
+                bytes.push_back(0);
+            return (uint32_t)bytes.size();
+        }
+
+        uint32_t append(const void *data, size_t size)
+        {
+            if (!data || size == 0)
+                return 0;
+            uint32_t offset = align();
+            const unsigned char *p = (const unsigned char *)data;
+            bytes.insert(bytes.end(), p, p + size);
+            return offset;
+        }
+
+        template <typename T>
+        T *at(uint32_t offset) { return (T *)&bytes[offset]; }
+    };
+}
+
+bool WriteClipFile(const std::string &path, const Skeleton &skeleton, const std::vector<std::string> &names,
+                   const std::vector<const AnimationClip *> &clips)
+{
+    if (SDL_BYTEORDER != SDL_LIL_ENDIAN)
+    {
+        LogError("[CLIPS] The clip format is little-endian only");
+        return false;
+    }
+
+    ClipFileWriter writer;
+    writer.bytes.resize(sizeof(ClipFileHeader), 0);
+
+    int jointCount = skeleton.getJointCount();
+    uint32_t jointTable = jointCount ? writer.align() : 0;
+    writer.bytes.resize(writer.bytes.size() + jointCount * sizeof(ClipFileJoint), 0);
+    uint32_t clipTable = writer.align();
+    writer.bytes.resize(writer.bytes.size() + clips.size() * sizeof(ClipFileClip), 0);
+
+    // Strings: joints e depois clips
+    std::string strings;
+    std::vector<uint32_t> jointNames, clipNames;
+    for (int j = 0; j < jointCount; j++)
+    {
+        jointNames.push_back((uint32_t)strings.size());
+        strings += skeleton.getName(j);
+        strings += '\0';
+    }
+    for (const std::string &name : names)
+    {
+        clipNames.push_back((uint32_t)strings.size());
+        strings += name;
+        strings += '\0';
+    }
+    uint32_t stringTable = writer.append(strings.data(), strings.size());
+
+    for (int j = 0; j < jointCount; j++)
+    {
+        ClipFileJoint joint = {};
+        const Color &color = skeleton.getColor(j);
+        joint.name = jointNames[j];
+        joint.parent = skeleton.getParent(j);
+        joint.axis = (uint32_t)skeleton.getAxis(j);
+        joint.color = (uint32_t)color.r | ((uint32_t)color.g << 8) | ((uint32_t)color.b << 16) | ((uint32_t)color.a << 24);
+        const Vec3 &offset = skeleton.getOffset(j), &shapeOffset = skeleton.getShapeOffset(j), &shapeScale = skeleton.getShapeScale(j);
+        joint.offset[0] = offset.x, joint.offset[1] = offset.y, joint.offset[2] = offset.z;
+        joint.shapeOffset[0] = shapeOffset.x, joint.shapeOffset[1] = shapeOffset.y, joint.shapeOffset[2] = shapeOffset.z;
+        joint.shapeScale[0] = shapeScale.x, joint.shapeScale[1] = shapeScale.y, joint.shapeScale[2] = shapeScale.z;
+        *writer.at<ClipFileJoint>(jointTable + j * sizeof(ClipFileJoint)) = joint;
+    }
+
+    for (size_t i = 0; i < clips.size(); i++)
+    {
+        const AnimationClip &clip = *clips[i];
+        const ClipData &data = clip.getData();
+        const ClipStats &stats = clip.getStats();
+
+        ClipFileClip record = {};
+        record.name = clipNames[i];
+        record.flags = (clip.isLooping() ? uint32_t(ClipFileClip::LOOP) : 0u) | (clip.isCubic() ? uint32_t(ClipFileClip::CUBIC) : 0u);
+        record.duration = clip.getDuration();
+        record.channelCount = clip.getChannelCount();
+        record.keyCount = data.keyCount;
+        record.animatedCount = data.animatedCount;
+        record.constantCount = data.constantCount;
+        record.quantizedStride = data.quantizedStride;
+        record.coefficientStride = data.coefficientStride;
+
+        size_t rows = (size_t)data.keyCount;
+        record.times = writer.append(data.times, rows * sizeof(float));
+        record.animatedChannels = writer.append(data.animatedChannels, data.animatedCount * sizeof(int32_t));
+        if (data.coefficientStride > 0)
+        {
+            record.coefficients = writer.append(data.coefficients, (rows - 1) * 4 * data.coefficientStride * sizeof(float));
+        }
+        else if (data.quantizedStride > 0)
+        {
+            record.quantized = writer.append(data.quantized, rows * data.quantizedStride * sizeof(uint16_t));
+            record.trackRanges = writer.append(data.trackRanges, data.quantizedStride * 2 * sizeof(float));
+        }
+        else
+        {
+            record.values = writer.append(data.values, rows * data.animatedCount * sizeof(float));
+        }
+        record.constantChannels = writer.append(data.constantChannels, data.constantCount * sizeof(int32_t));
+        record.constantValues = writer.append(data.constantValues, data.constantCount * sizeof(float));
+
+        record.sourceKeys = stats.sourceKeys;
+        record.sourceBytes = (uint32_t)stats.sourceBytes;
+        record.maxRotationError = stats.maxRotationError;
+        record.maxTranslationError = stats.maxTranslationError;
+        *writer.at<ClipFileClip>(clipTable + (uint32_t)(i * sizeof(ClipFileClip))) = record;
+    }
+    writer.align();
+
+    ClipFileHeader header = {};
+    memcpy(header.magic, CLIP_FILE_MAGIC, 4);
+    header.version = CLIP_FILE_VERSION;
+    header.fileSize = (uint32_t)writer.bytes.size();
+    header.jointCount = (uint32_t)jointCount;
+    header.jointTable = jointTable;
+    header.clipCount = (uint32_t)clips.size();
+    header.clipTable = clipTable;
+    header.stringTable = stringTable;
+    *writer.at<ClipFileHeader>(0) = header;
+
+    FileStream file;
+    if (!file.Create(path, true))
+    {
+        LogError("[CLIPS] Cannot write %s", path.c_str());
+        return false;
+    }
+    bool written = file.Write(writer.bytes.data(), (int)writer.bytes.size()) == writer.bytes.size();
+    file.Close();
+    if (!written)
+    {
+        LogError("[CLIPS] Failed writing %s", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool ConvertClipText(const std::string &textPath, const std::string &binaryPath)
+{
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    char *text = LoadTextFile(textPath.c_str());
+    if (!text)
+        return false;
+
+    Skeleton skeleton;
+    std::vector<Animation> animations;
+    bool parsed = ParseClipText(text, skeleton, animations);
+    free(text);
+    if (!parsed)
+        return false;
+
+    const ClipCompression &compression = AnimationLibrary::Instance().getCompression();
+    std::vector<AnimationClip> compiled(animations.size());
+    std::vector<std::string> names;
+    std::vector<const AnimationClip *> clips;
+    for (size_t i = 0; i < animations.size(); i++)
+    {
+        compiled[i].compile(animations[i], compression);
+        names.push_back(animations[i].name);
+        clips.push_back(&compiled[i]);
+    }
+
+    if (!WriteClipFile(binaryPath, skeleton, names, clips))
+        return false;
+
+    double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    LogInfo("[CLIPS] Converted %s -> %s: %d clips in %.2f ms", textPath.c_str(), binaryPath.c_str(), (int)clips.size(), ms);
+    return true;
+}
+
+//***********************************************************************************************************
+// Leitura
+
+// Mesma contagem que AnimationClip::measure()
+static size_t ClipBytes(const ClipFileClip &r)
+{
+    size_t rows = (size_t)r.keyCount;
+    size_t bytes = rows * sizeof(float) + r.animatedCount * sizeof(int32_t) + r.constantCount * (sizeof(int32_t) + sizeof(float));
+    if (r.flags & ClipFileClip::CUBIC)
+        bytes += (rows - 1) * 4 * r.coefficientStride * sizeof(float);
+    else if (r.quantizedStride > 0)
+        bytes += rows * r.quantizedStride * sizeof(uint16_t) + r.quantizedStride * 2 * sizeof(float);
+    else
+        bytes += rows * r.animatedCount * sizeof(float);
+    return bytes;
+}
+
+static bool InFile(uint32_t offset, size_t size, size_t fileSize, size_t alignment)
+{
+    if (size == 0)
+        return true;
+    return offset != 0 && offset % alignment == 0 && (size_t)offset <= fileSize && size <= fileSize - offset;
+}
+
+int LoadClipFile(const std::string &path, AnimationLibrary &library, Skeleton *skeleton)
+{
+    if (SDL_BYTEORDER != SDL_LIL_ENDIAN)
+    {
+        LogError("[CLIPS] The clip format is little-endian only");
+        return -1;
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    MappedFile *file = new MappedFile();
+    if (!file->Open(path))
+    {
+        delete file;
+        return -1;
+    }
+
+    const unsigned char *base = file->GetData();
+    size_t fileSize = (size_t)file->Size();
+    const ClipFileHeader *header = (const ClipFileHeader *)base;
+    if (fileSize < sizeof(ClipFileHeader) || memcmp(header->magic, CLIP_FILE_MAGIC, 4) != 0 ||
+        header->version != CLIP_FILE_VERSION || header->fileSize > fileSize ||
+        !InFile(header->jointTable, (size_t)header->jointCount * sizeof(ClipFileJoint), fileSize, 4) ||
+        !InFile(header->clipTable, (size_t)header->clipCount * sizeof(ClipFileClip), fileSize, 4) ||
+        header->stringTable >= fileSize)
+    {
+        LogError("[CLIPS] %s is not a version %d clip file", path.c_str(), (int)CLIP_FILE_VERSION);
+        delete file;
+        return -1;
+    }
+
+    const char *strings = (const char *)base + header->stringTable;
+    size_t stringsSize = fileSize - header->stringTable;
+    auto name = [&](uint32_t offset) -> const char *
+    {
+        return (offset < stringsSize && memchr(strings + offset, 0, stringsSize - offset)) ? strings + offset : nullptr;
+    };
+
+    if (skeleton && header->jointCount > 0)
+    {
+        const ClipFileJoint *joints = (const ClipFileJoint *)(base + header->jointTable);
+        Skeleton rig;
+        for (uint32_t j = 0; j < header->jointCount; j++)
+        {
+            const ClipFileJoint &joint = joints[j];
+            const char *jointName = name(joint.name);
+            if (!jointName || joint.parent >= (int32_t)j || joint.axis > (uint32_t)JointAxis::Z)
+            {
+                LogError("[CLIPS] %s: bad joint %d", path.c_str(), (int)j);
+                delete file;
+                return -1;
+            }
+            Color color((u8)joint.color, (u8)(joint.color >> 8), (u8)(joint.color >> 16), (u8)(joint.color >> 24));
+            rig.addJoint(jointName, joint.parent, Vec3(joint.offset[0], joint.offset[1], joint.offset[2]), (JointAxis)joint.axis,
+                         Vec3(joint.shapeOffset[0], joint.shapeOffset[1], joint.shapeOffset[2]),
+                         Vec3(joint.shapeScale[0], joint.shapeScale[1], joint.shapeScale[2]), color);
+        }
+        *skeleton = rig;
+    }
+
+    // Valida tudo antes de registar, para um ficheiro corrompido não deixar clips a meio
+    const ClipFileClip *records = (const ClipFileClip *)(base + header->clipTable);
+    for (uint32_t i = 0; i < header->clipCount; i++)
+    {
+        const ClipFileClip &r = records[i];
+
+        // Contagens primeiro: a partir daqui os tamanhos são calculados em size_t, sem overflow
+        bool valid = name(r.name) && std::isfinite(r.duration) && r.duration >= 0.0f && r.duration <= CLIP_FILE_MAX_DURATION &&
+                     r.channelCount >= 0 && r.channelCount % 4 == 0 && r.keyCount >= 0 && r.animatedCount >= 0 &&
+                     r.constantCount >= 0 && r.quantizedStride >= 0 && r.coefficientStride >= 0 &&
+                     (int64_t)r.animatedCount + (int64_t)r.constantCount <= (int64_t)r.channelCount &&
+                     (r.animatedCount == 0 || r.keyCount >= 2);
+        if (valid)
+        {
+            size_t rows = (size_t)r.keyCount;
+            size_t animatedCount = (size_t)r.animatedCount;
+            size_t constantCount = (size_t)r.constantCount;
+            size_t quantizedStride = (size_t)r.quantizedStride;
+            size_t coefficientStride = (size_t)r.coefficientStride;
+            bool quantized = quantizedStride > 0;
+            bool cubic = (r.flags & ClipFileClip::CUBIC) != 0;
+            bool tracks;
+            if (cubic)
+                tracks = rows >= 2 && !quantized && coefficientStride >= animatedCount &&
+                         InFile(r.coefficients, (rows - 1) * 4 * coefficientStride * sizeof(float), fileSize, 4);
+            else if (quantized)
+                tracks = coefficientStride == 0 && quantizedStride >= animatedCount && quantizedStride % CLIP_FILE_QUANTIZE_LANES == 0 &&
+                         InFile(r.quantized, rows * quantizedStride * sizeof(uint16_t), fileSize, 2) &&
+                         InFile(r.trackRanges, quantizedStride * 2 * sizeof(float), fileSize, 4);
+            else
+                tracks = coefficientStride == 0 && InFile(r.values, rows * animatedCount * sizeof(float), fileSize, 4);
+            valid = tracks &&
+                    InFile(r.times, rows * sizeof(float), fileSize, 4) &&
+                    InFile(r.animatedChannels, animatedCount * sizeof(int32_t), fileSize, 4) &&
+                    InFile(r.constantChannels, constantCount * sizeof(int32_t), fileSize, 4) &&
+                    InFile(r.constantValues, constantCount * sizeof(float), fileSize, 4);
+        }
+
+        // Os índices de canal são escritos sem verificação no sample()
+        const int32_t *animated = (const int32_t *)(base + r.animatedChannels);
+        const int32_t *constants = (const int32_t *)(base + r.constantChannels);
+        for (int32_t c = 0; valid && c < r.animatedCount; c++)
+            valid = animated[c] >= 0 && animated[c] < r.channelCount;
+        for (int32_t c = 0; valid && c < r.constantCount; c++)
+            valid = constants[c] >= 0 && constants[c] < r.channelCount;
+
+        if (!valid)
+        {
+            LogError("[CLIPS] %s: clip %d is corrupted", path.c_str(), (int)i);
+            delete file;
+            return -1;
+        }
+    }
+
+    for (uint32_t i = 0; i < header->clipCount; i++)
+    {
+        const ClipFileClip &r = records[i];
+
+        ClipData data;
+        data.keyCount = r.keyCount;
+        data.animatedCount = r.animatedCount;
+        data.constantCount = r.constantCount;
+        data.quantizedStride = r.quantizedStride;
+        data.coefficientStride = (r.flags & ClipFileClip::CUBIC) ? r.coefficientStride : 0;
+        data.times = r.times ? (const float *)(base + r.times) : nullptr;
+        data.animatedChannels = r.animatedChannels ? (const int32_t *)(base + r.animatedChannels) : nullptr;
+        data.values = r.values ? (const float *)(base + r.values) : nullptr;
+        data.quantized = r.quantized ? (const uint16_t *)(base + r.quantized) : nullptr;
+        data.trackRanges = r.trackRanges ? (const float *)(base + r.trackRanges) : nullptr;
+        data.coefficients = (data.coefficientStride > 0 && r.coefficients) ? (const float *)(base + r.coefficients) : nullptr;
+        data.constantChannels = r.constantChannels ? (const int32_t *)(base + r.constantChannels) : nullptr;
+        data.constantValues = r.constantValues ? (const float *)(base + r.constantValues) : nullptr;
+
+        ClipStats stats;
+        stats.sourceKeys = r.sourceKeys;
+        stats.keys = r.keyCount;
+        stats.sourceBytes = r.sourceBytes;
+        stats.bytes = ClipBytes(r);
+        stats.maxRotationError = r.maxRotationError;
+        stats.maxTranslationError = r.maxTranslationError;
+
+        AnimationClip clip;
+        clip.attach(data, r.duration, (r.flags & ClipFileClip::LOOP) != 0, r.channelCount, stats);
+        library.add(name(r.name), clip);
+    }
+
+    library.addStorage(file);
+
+    double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+    LogInfo("[CLIPS] Loaded %s: %d clips, %.1f KB %s in %.3f ms", path.c_str(), (int)header->clipCount,
+            fileSize / 1024.0f, file->IsMapped() ? "mapped" : "read", ms);
+    return (int)header->clipCount;
+}
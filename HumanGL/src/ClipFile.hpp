@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Animation.hpp"
+
+// Formato binário de clips (.clips), versão 2 (a 1 não tinha curvas cúbicas). Little-endian, secções alinhadas a 16 bytes e
+// referenciadas por offsets em bytes desde o início do ficheiro, para os dados dos clips serem
+// usados diretamente a partir do ficheiro mapeado (AnimationClip::attach), sem cópias.
+//
+//   ClipFileHeader
+//   ClipFileJoint[jointCount]   rig opcional (jointCount = 0 se não houver)
+//   ClipFileClip[clipCount]
+//   tabela de strings           nomes terminados em 0
+//   dados                       arrays de cada clip (ver ClipData)
+//
+// Os clips são gravados já compilados/comprimidos; carregar não faz parsing nem compilação.
+
+static const uint32_t CLIP_FILE_VERSION = 2;
+
+struct ClipFileHeader
+{
+    char magic[4]; // "HCLP"
+    uint32_t version;
+    uint32_t fileSize;
+    uint32_t jointCount;
+    uint32_t jointTable;
+    uint32_t clipCount;
+    uint32_t clipTable;
+    uint32_t stringTable;
+};
+
+struct ClipFileJoint
+{
+    uint32_t name;   // offset na tabela de strings
+    int32_t parent;  // -1 = raiz
+    uint32_t axis;   // JointAxis
+    uint32_t color;  // RGBA8
+    float offset[3];
+    float shapeOffset[3];
+    float shapeScale[3];
+    uint32_t reserved[3];
+};
+
+struct ClipFileClip
+{
+    enum Flags : uint32_t
+    {
+        LOOP = 1 << 0,
+        CUBIC = 1 << 1, // tracks em coeficientes cúbicos (coefficients) em vez de values/quantized
+    };
+
+    uint32_t name;
+    uint32_t flags;
+    float duration;
+    int32_t channelCount;
+
+    int32_t keyCount;
+    int32_t animatedCount;
+    int32_t constantCount;
+    int32_t quantizedStride;
+    int32_t coefficientStride;
+
+    // Offsets dos arrays (0 = ausente)
+    uint32_t times;
+    uint32_t animatedChannels;
+    uint32_t values;
+    uint32_t quantized;
+    uint32_t trackRanges;
+    uint32_t coefficients;
+    uint32_t constantChannels;
+    uint32_t constantValues;
+
+    // ClipStats da compilação
+    int32_t sourceKeys;
+    uint32_t sourceBytes;
+    float maxRotationError;
+    float maxTranslationError;
+    uint32_t reserved[3];
+};
+
+static_assert(sizeof(ClipFileHeader) == 32, "ClipFileHeader layout");
+static_assert(sizeof(ClipFileJoint) == 64, "ClipFileJoint layout");
+static_assert(sizeof(ClipFileClip) == 96, "ClipFileClip layout");
+
+// Formato de texto para autoria (.anim), uma instrução por linha, '#' para comentários:
+//   joint <nome> <pai|-> <offset x y z> <eixo X|Y|Z> <offset do cubo x y z> <escala do cubo x y z> <r g b>
+//   clip <nome> [loop|once] [linear|cubic]
+//   key <tempo em segundos>
+//   rot <joint> <graus>
+//   pos <joint> <x> <y> <z>
+//   tanrot <joint> <graus por segundo>     tangente de Hermite (só cubic; sem ela é automática)
+//   tanpos <joint> <x> <y> <z>             idem, por segundo
+// Sem linhas joint os clips são para o rig Skeleton::Humanoid() e skeleton fica vazio.
+// Canais que um key não refere ficam a 0.
+bool ParseClipText(const char *text, Skeleton &skeleton, std::vector<Animation> &animations);
+
+// Grava clips já compilados (e o rig, se skeleton tiver joints)
+bool WriteClipFile(const std::string &path, const Skeleton &skeleton, const std::vector<std::string> &names,
+                   const std::vector<const AnimationClip *> &clips);
+
+// .anim -> .clips, compilando com as definições de compressão da AnimationLibrary
+bool ConvertClipText(const std::string &textPath, const std::string &binaryPath);
+
+// Mapeia o ficheiro e regista os clips na AnimationLibrary (o mapeamento fica com a biblioteca).
+// skeleton, se não for nulo e o ficheiro tiver um rig, recebe-o. Devolve o número de clips ou -1.
+int LoadClipFile(const std::string &path, AnimationLibrary &library, Skeleton *skeleton = nullptr);
@@ -0,0 +1,94 @@
+#include "Crowd.hpp"
+#include "Animation.hpp"
+#include "AnimationPalette.hpp"
+#include <cstring>
+
+CrowdRenderer::CrowdRenderer(unsigned int initialCapacity)
+{
+    cubeMesh = CreateCube();
+
+    VertexFormat format;
+    format.addElement(VertexType::TEXCOORD1, 16); // model, locations 1..4
+    format.addElement(VertexType::COLOR, 4);      // cor, location 5
+    cubeMesh->CreateInstanceBuffer(format, initialCapacity);
+
+    instances.reserve(initialCapacity);
+}
+
+CrowdRenderer::~CrowdRenderer()
+{
+    if (cubeMesh)
+    {
+        delete cubeMesh;
+    }
+}
+
+void CrowdRenderer::add(const Mat4 &model, const Color &color)
+{
+    instances.emplace_back();
+    CubeInstance &instance = instances.back();
+    std::memcpy(instance.model, model.m, sizeof(instance.model));
+    instance.color[0] = color.r / 255.0f;
+    instance.color[1] = color.g / 255.0f;
+    instance.color[2] = color.b / 255.0f;
+    instance.color[3] = color.a / 255.0f;
+}
+
+void CrowdRenderer::render()
+{
+    if (instances.empty())
+        return;
+
+    cubeMesh->SetInstanceData(instances.data(), (unsigned int)instances.size());
+    cubeMesh->RenderInstanced(static_cast<int>(PrimitiveType::TRIANGLES), 36, (int)instances.size());
+}
+
+BakedCrowdRenderer::BakedCrowdRenderer(const Skeleton &skeleton, unsigned int capacity) : skeleton(skeleton)
+{
+    cubeMesh = CreateCube();
+
+    VertexFormat format;
+    format.addElement(VertexType::TEXCOORD1, 4); // posição + início, location 1
+    format.addElement(VertexType::TEXCOORD2, 1); // clip, location 2
+    cubeMesh->CreateInstanceBuffer(format, capacity, (unsigned int)skeleton.getJointCount());
+
+    instances.reserve(capacity);
+    dirty = true;
+}
+
+BakedCrowdRenderer::~BakedCrowdRenderer()
+{
+    if (cubeMesh)
+    {
+        delete cubeMesh;
+    }
+}
+
+void BakedCrowdRenderer::render(Shader &shader, AnimationPalette &palette, float time)
+{
+    if (instances.empty())
+        return;
+
+    // Os registos só são reenviados quando algum personagem muda de clip
+    if (dirty)
+    {
+        cubeMesh->SetInstanceData(instances.data(), (unsigned int)instances.size());
+        dirty = false;
+    }
+
+    float colors[AnimationPalette::MAX_JOINTS * 4] = {};
+    int joints = Min(skeleton.getJointCount(), AnimationPalette::MAX_JOINTS);
+    for (int joint = 0; joint < joints; joint++)
+    {
+        const Color &color = skeleton.getColor(joint);
+        colors[joint * 4 + 0] = color.r / 255.0f;
+        colors[joint * 4 + 1] = color.g / 255.0f;
+        colors[joint * 4 + 2] = color.b / 255.0f;
+        colors[joint * 4 + 3] = 1.0f;
+    }
+
+    palette.bind(shader);
+    shader.SetFloat("crowdTime", time);
+    shader.SetFloat4Array("jointColors", colors, joints);
+    cubeMesh->RenderInstanced(static_cast<int>(PrimitiveType::TRIANGLES), 36, (int)instances.size() * skeleton.getJointCount());
+}
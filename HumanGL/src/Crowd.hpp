@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+#include "Core.hpp"
+#include "Skeleton.hpp"
+
+class AnimationPalette;
+
+// Dados por instância do cubo: matriz world (4 colunas) + cor
+struct CubeInstance
+{
+    float model[16];
+    float color[4];
+};
+
+// Junta as partes de todos os personagens num buffer por instância e desenha-as com um único
+// glDrawElementsInstanced sobre o cubo partilhado.
+// O shader usa position em location 0, a matriz em 1..4 e a cor em 5.
+class CrowdRenderer
+{
+public:
+    explicit CrowdRenderer(unsigned int initialCapacity = 1024);
+    ~CrowdRenderer();
+
+    // Cubo partilhado; os Humanoid da multidão desenham-se com este mesmo buffer
+    MeshBuffer *getCubeMesh() const { return cubeMesh; }
+
+    void begin() { instances.clear(); }
+    void add(const Mat4 &model, const Color &color);
+    void render();
+
+    int getInstanceCount() const { return (int)instances.size(); }
+
+private:
+    CrowdRenderer(const CrowdRenderer &) = delete;
+    CrowdRenderer &operator=(const CrowdRenderer &) = delete;
+
+    MeshBuffer *cubeMesh;
+    std::vector<CubeInstance> instances;
+};
+
+// Um registo por personagem para a multidão avaliada na GPU: posição, instante em que o clip
+// começou (no relógio do shader) e slot do clip na AnimationPalette (não o ClipId da biblioteca).
+// Só muda quando o personagem troca de clip.
+struct BakedInstance
+{
+    float position[3];
+    float startTime;
+    float clip;
+};
+
+// Desenha personagens cujas poses vêm de uma AnimationPalette: cada personagem são jointCount
+// instâncias do cubo (o registo avança a cada jointCount instâncias) e o vertex shader lê as
+// matrizes do joint no frame do clip, interpolando entre os dois frames vizinhos.
+// O shader usa position em location 0, o registo em 1 (posição + início) e 2 (clip).
+class BakedCrowdRenderer
+{
+public:
+    BakedCrowdRenderer(const Skeleton &skeleton, unsigned int capacity);
+    ~BakedCrowdRenderer();
+
+    std::vector<BakedInstance> &getInstances() { return instances; }
+    void markDirty() { dirty = true; }
+
+    // time é o relógio comparado com startTime
+    void render(Shader &shader, AnimationPalette &palette, float time);
+
+private:
+    BakedCrowdRenderer(const BakedCrowdRenderer &) = delete;
+    BakedCrowdRenderer &operator=(const BakedCrowdRenderer &) = delete;
+
+    const Skeleton &skeleton;
+    MeshBuffer *cubeMesh;
+    std::vector<BakedInstance> instances;
+    bool dirty;
+};
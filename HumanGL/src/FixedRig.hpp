@@ -0,0 +1,134 @@
+#pragma once
+
+#include <utility>
+#include "Skeleton.hpp"
+
+// Descrição de um joint em compile time (os mesmos campos que Skeleton::addJoint)
+struct RigJoint
+{
+    const char *name;
+    int parent; // -1 = raiz do rig
+    float offset[3];
+    JointAxis axis;
+    float shapeOffset[3];
+    float shapeScale[3];
+    unsigned char color[3];
+};
+
+// Rig humanoide em tabela constexpr, na ordem de HumanJoint; Skeleton::Humanoid() é construído a partir dela
+struct HumanoidRig
+{
+    static constexpr int JOINT_COUNT = HUMAN_JOINT_COUNT;
+    static constexpr RigJoint JOINTS[JOINT_COUNT] = {
+        // Torso: raiz do rig; o centro fica a 2 unidades do chão para os pés tocarem na grelha
+        {"torso", -1, {0.0f, 2.0f, 0.0f}, JointAxis::Y, {0.0f, 0.0f, 0.0f}, {1.0f, 1.6f, 0.5f}, {45, 100, 25}},
+        {"head", JOINT_TORSO, {0.0f, 1.4f, 0.0f}, JointAxis::Y, {0.0f, 0.0f, 0.0f}, {0.7f, 0.7f, 0.7f}, {255, 224, 185}},
+        {"upper_arm_l", JOINT_TORSO, {-0.7f, 0.75f, 0.0f}, JointAxis::X, {0.0f, -0.3f, 0.0f}, {0.4f, 0.6f, 0.4f}, {255, 224, 185}},
+        {"forearm_l", JOINT_UPPER_ARM_L, {0.0f, -0.6f, 0.0f}, JointAxis::X, {0.0f, -0.3f, 0.0f}, {0.3f, 0.6f, 0.3f}, {255, 224, 185}},
+        {"upper_arm_r", JOINT_TORSO, {0.7f, 0.75f, 0.0f}, JointAxis::X, {0.0f, -0.3f, 0.0f}, {0.4f, 0.6f, 0.4f}, {255, 224, 185}},
+        {"forearm_r", JOINT_UPPER_ARM_R, {0.0f, -0.6f, 0.0f}, JointAxis::X, {0.0f, -0.3f, 0.0f}, {0.3f, 0.6f, 0.3f}, {255, 224, 185}},
+        {"thigh_l", JOINT_TORSO, {-0.3f, -0.85f, 0.0f}, JointAxis::X, {0.0f, -0.3f, 0.0f}, {0.4f, 0.8f, 0.4f}, {0, 0, 255}},
+        {"calf_l", JOINT_THIGH_L, {0.0f, -0.6f, 0.0f}, JointAxis::X, {0.0f, -0.3f, 0.0f}, {0.35f, 0.6f, 0.35f}, {0, 0, 255}},
+        {"thigh_r", JOINT_TORSO, {0.3f, -0.85f, 0.0f}, JointAxis::X, {0.0f, -0.3f, 0.0f}, {0.4f, 0.8f, 0.4f}, {0, 0, 255}},
+        {"calf_r", JOINT_THIGH_R, {0.0f, -0.6f, 0.0f}, JointAxis::X, {0.0f, -0.3f, 0.0f}, {0.35f, 0.6f, 0.35f}, {0, 0, 255}},
+    };
+};
+
+// Pose -> matrizes world para um rig conhecido em compile time. Pais, eixos e offsets são constantes,
+// por isso cada joint é expandido no seu próprio código: sem loop sobre os joints, sem índices de pais
+// lidos da memória e sem ramos no eixo; a rotação de um eixo fixo só mexe em duas colunas da matriz do pai.
+// O resultado é o mesmo que Skeleton::applyPose() + TransformHierarchy::update() para todos os nós.
+template <typename Rig>
+struct FixedRig
+{
+    static constexpr int JOINT_COUNT = Rig::JOINT_COUNT;
+    static constexpr int NODE_COUNT = 1 + 2 * JOINT_COUNT;
+
+    // worlds recebe NODE_COUNT matrizes na ordem de Skeleton::buildHierarchy() (colocação, joints, cubos);
+    // channels tem 4 * JOINT_COUNT canais no layout de Pose (nullptr = pose de bind)
+    static void Evaluate(const Vec3 &position, const float *channels, Mat4 *worlds)
+    {
+        static constexpr float BIND_POSE[4 * JOINT_COUNT] = {};
+        if (!channels)
+            channels = BIND_POSE;
+
+        worlds[0] = Mat4::Identity();
+        worlds[0].m[12] = position.x;
+        worlds[0].m[13] = position.y;
+        worlds[0].m[14] = position.z;
+        EvaluateJoints(channels, worlds, std::make_index_sequence<JOINT_COUNT>());
+    }
+
+private:
+    template <size_t... J>
+    static void EvaluateJoints(const float *channels, Mat4 *worlds, std::index_sequence<J...>)
+    {
+        // Os joints estão por ordem (pais antes dos filhos), por isso a expansão em ordem chega
+        (EvaluateJoint<(int)J>(channels, worlds), ...);
+    }
+
+    template <int J>
+    static void EvaluateJoint(const float *channels, Mat4 *worlds)
+    {
+        constexpr RigJoint joint = Rig::JOINTS[J];
+        static_assert(joint.parent < J, "FixedRig: parent must come before its children");
+        constexpr int parentNode = joint.parent < 0 ? 0 : 1 + joint.parent;
+
+        // Cópia local: o compilador não tem de reler o pai depois de cada escrita no filho
+        const Mat4 parent = worlds[parentNode];
+        const float *p = parent.m;
+        float *w = worlds[1 + J].m;
+
+        float s, c;
+        SinCos(channels[J], s, c);
+        float tx = joint.offset[0] + channels[JOINT_COUNT + J];
+        float ty = joint.offset[1] + channels[2 * JOINT_COUNT + J];
+        float tz = joint.offset[2] + channels[3 * JOINT_COUNT + J];
+
+        // Colunas 0..2 = colunas do pai rodadas à volta do eixo do joint; coluna 3 = pai * translação
+        for (int r = 0; r < 3; r++)
+        {
+            float p0 = p[r], p1 = p[4 + r], p2 = p[8 + r];
+            if constexpr (joint.axis == JointAxis::X)
+            {
+                w[r] = p0;
+                w[4 + r] = c * p1 + s * p2;
+                w[8 + r] = c * p2 - s * p1;
+            }
+            else if constexpr (joint.axis == JointAxis::Y)
+            {
+                w[r] = c * p0 - s * p2;
+                w[4 + r] = p1;
+                w[8 + r] = s * p0 + c * p2;
+            }
+            else
+            {
+                w[r] = c * p0 + s * p1;
+                w[4 + r] = c * p1 - s * p0;
+                w[8 + r] = p2;
+            }
+            w[12 + r] = p0 * tx + p1 * ty + p2 * tz + p[12 + r];
+        }
+        w[3] = w[7] = w[11] = 0.0f;
+        w[15] = 1.0f;
+
+        // Cubo: joint * translação(shapeOffset) * escala(shapeScale)
+        float *shape = worlds[1 + JOINT_COUNT + J].m;
+        for (int r = 0; r < 3; r++)
+        {
+            shape[r] = w[r] * joint.shapeScale[0];
+            shape[4 + r] = w[4 + r] * joint.shapeScale[1];
+            shape[8 + r] = w[8 + r] * joint.shapeScale[2];
+            float t = w[12 + r];
+            if constexpr (joint.shapeOffset[0] != 0.0f)
+                t += w[r] * joint.shapeOffset[0];
+            if constexpr (joint.shapeOffset[1] != 0.0f)
+                t += w[4 + r] * joint.shapeOffset[1];
+            if constexpr (joint.shapeOffset[2] != 0.0f)
+                t += w[8 + r] * joint.shapeOffset[2];
+            shape[12 + r] = t;
+        }
+        shape[3] = shape[7] = shape[11] = 0.0f;
+        shape[15] = 1.0f;
+    }
+};
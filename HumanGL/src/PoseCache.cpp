@@ -0,0 +1,155 @@
+#include "PoseCache.hpp"
+#include <cmath>
+#include <cstring>
+
+PoseCache::PoseCache(const Skeleton &skeleton, float bucketWidth) : skeleton(skeleton), bucketWidth(bucketWidth)
+{
+    assert(bucketWidth > 0.0f && "PoseCache: bucket width must be positive");
+}
+
+PoseCache::~PoseCache()
+{
+    release();
+}
+
+void PoseCache::release()
+{
+    for (ClipBuckets *buckets : clips)
+    {
+        BucketStorage *storage = buckets->storage.load(std::memory_order_relaxed);
+        if (storage)
+        {
+            delete[] storage->states;
+            delete[] storage->channels;
+            delete[] storage->locals;
+            delete storage;
+        }
+        delete buckets;
+    }
+    clips.clear();
+}
+
+void PoseCache::setBucketWidth(float width)
+{
+    assert(width > 0.0f && "PoseCache: bucket width must be positive");
+    if (width == bucketWidth)
+        return;
+    bucketWidth = width;
+    release();
+}
+
+int PoseCache::getBucketCount() const
+{
+    int count = 0;
+    for (const ClipBuckets *buckets : clips)
+    {
+        if (buckets->storage.load(std::memory_order_acquire))
+            count += buckets->count;
+    }
+    return count;
+}
+
+void PoseCache::begin()
+{
+    // Clips registados desde o último frame; a biblioteca não muda durante a animação.
+    // Aqui só se cria o descritor, os baldes ficam para o primeiro acquire()
+    const AnimationLibrary &library = AnimationLibrary::Instance();
+    for (ClipId id = (ClipId)clips.size(); id < library.getClipCount(); id++)
+    {
+        const AnimationClip &clip = library.getClip(id);
+        float duration = clip.getDuration();
+        if (!std::isfinite(duration) || duration < 0.0f)
+            duration = 0.0f;
+
+        ClipBuckets *buckets = new ClipBuckets();
+        buckets->width = Max(bucketWidth, duration / (float)MAX_CLIP_BUCKETS);
+        buckets->count = Min((int)(duration / buckets->width) + 1, MAX_CLIP_BUCKETS);
+        buckets->channelCount = clip.getChannelCount();
+        clips.push_back(buckets);
+    }
+
+    workers.resize(GetJobWorkerCount());
+    for (WorkerStats &worker : workers)
+        worker.stats = Stats();
+}
+
+void PoseCache::end()
+{
+    stats = Stats();
+    for (const WorkerStats &worker : workers)
+    {
+        stats.requests += worker.stats.requests;
+        stats.hits += worker.stats.hits;
+        stats.evaluations += worker.stats.evaluations;
+        stats.contended += worker.stats.contended;
+    }
+}
+
+PoseCache::BucketStorage *PoseCache::allocate(ClipBuckets &buckets)
+{
+    BucketStorage *storage = new BucketStorage();
+    storage->states = new std::atomic<int>[buckets.count];
+    for (int i = 0; i < buckets.count; i++)
+        storage->states[i].store(BUCKET_EMPTY, std::memory_order_relaxed);
+    storage->channels = new float[(size_t)buckets.count * buckets.channelCount];
+    storage->locals = new JointLocal[(size_t)buckets.count * skeleton.getJointCount()];
+
+    // Dois workers podem chegar ao mesmo clip novo; fica a primeira alocação publicada
+    BucketStorage *expected = nullptr;
+    if (buckets.storage.compare_exchange_strong(expected, storage, std::memory_order_acq_rel, std::memory_order_acquire))
+        return storage;
+    delete[] storage->states;
+    delete[] storage->channels;
+    delete[] storage->locals;
+    delete storage;
+    return expected;
+}
+
+const JointLocal *PoseCache::acquire(ClipId clip, float time, Pose &pose)
+{
+    if (clip < 0 || clip >= (int)clips.size() || workers.empty())
+        return nullptr;
+
+    int worker = GetJobWorkerIndex();
+    if (worker < 0 || worker >= (int)workers.size())
+        worker = 0;
+    Stats &counters = workers[worker].stats;
+    counters.requests++;
+
+    ClipBuckets &buckets = *clips[clip];
+    BucketStorage *storage = buckets.storage.load(std::memory_order_acquire);
+    if (!storage)
+        storage = allocate(buckets);
+
+    int bucket = Clamp((int)(time / buckets.width), 0, buckets.count - 1);
+    float *channels = storage->channels + (size_t)bucket * buckets.channelCount;
+    JointLocal *locals = storage->locals + (size_t)bucket * skeleton.getJointCount();
+    std::atomic<int> &state = storage->states[bucket];
+
+    int current = state.load(std::memory_order_acquire);
+    if (current == BUCKET_READY)
+    {
+        counters.hits++;
+        pose.channels.assign(channels, channels + buckets.channelCount);
+        return locals;
+    }
+
+    if (current != BUCKET_EMPTY || !state.compare_exchange_strong(current, BUCKET_BUILDING, std::memory_order_acquire))
+    {
+        // Outro worker está a preencher o balde; não vale a pena esperar por ele
+        counters.contended++;
+        return nullptr;
+    }
+
+    // Primeiro pedido: amostra no início do balde (o cursor local cai numa pesquisa binária)
+    const AnimationClip &source = AnimationLibrary::Instance().getClip(clip);
+    ClipCursor cursor;
+    source.initPose(pose);
+    source.sample(Min(bucket * buckets.width, source.getDuration()), cursor, pose);
+    skeleton.computeLocals(pose, locals);
+    std::memcpy(channels, pose.channels.data(), buckets.channelCount * sizeof(float));
+    state.store(BUCKET_READY, std::memory_order_release);
+
+    counters.evaluations++;
+    return locals;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include "Animation.hpp"
+
+// Partilha de poses entre personagens que tocam o mesmo clip em fases próximas.
+// O tempo de cada clip é dividido em baldes de bucketWidth segundos; o primeiro personagem a pedir
+// um balde amostra o clip no início do balde e resolve as transformações locais dos joints, e os
+// seguintes copiam o resultado. Os clips não mudam depois de registados, por isso um balde, uma vez
+// preenchido, fica válido até a largura mudar (e não só dentro do frame em que foi avaliado).
+// Os baldes de um clip só são alocados no primeiro acquire() desse clip (numa biblioteca grande
+// a maioria dos clips não está a tocar) e nunca passam de MAX_CLIP_BUCKETS; num clip mais longo
+// os baldes ficam mais largos.
+//
+// begin() e end() no thread principal à volta da animação; acquire() pode ser chamado de qualquer worker.
+class PoseCache
+{
+public:
+    struct Stats
+    {
+        int requests = 0;
+        int hits = 0;        // avaliações poupadas
+        int evaluations = 0; // baldes preenchidos
+        int contended = 0;   // balde a ser preenchido por outro worker: o personagem amostrou sozinho
+
+        float hitRate() const { return requests > 0 ? (float)hits / (float)requests : 0.0f; }
+    };
+
+    static constexpr int MAX_CLIP_BUCKETS = 1024;
+
+    bool enabled = true;
+
+    explicit PoseCache(const Skeleton &skeleton, float bucketWidth = 1.0f / 60.0f);
+    ~PoseCache();
+
+    PoseCache(const PoseCache &) = delete;
+    PoseCache &operator=(const PoseCache &) = delete;
+
+    // Larguras maiores partilham mais mas a animação avança aos saltos; descarta os baldes preenchidos
+    void setBucketWidth(float width);
+    float getBucketWidth() const { return bucketWidth; }
+
+    void begin();
+    void end();
+
+    // Escreve em pose a pose do balde de (clip, time) e devolve as transformações locais para
+    // Skeleton::applyLocals(), ou nullptr (pose intocada) se o balde estiver a ser preenchido noutro worker
+    const JointLocal *acquire(ClipId clip, float time, Pose &pose);
+
+    const Skeleton &getSkeleton() const { return skeleton; }
+    // Baldes alocados (só dos clips já pedidos)
+    int getBucketCount() const;
+
+    // Contagens do último frame terminado com end()
+    const Stats &getStats() const { return stats; }
+
+private:
+    enum BucketState : int
+    {
+        BUCKET_EMPTY = 0,
+        BUCKET_BUILDING,
+        BUCKET_READY,
+    };
+
+    // Baldes de um clip em arrays contíguos: estado, canais da pose e transformações locais
+    struct BucketStorage
+    {
+        std::atomic<int> *states = nullptr;
+        float *channels = nullptr;
+        JointLocal *locals = nullptr;
+    };
+
+    // Descritor criado em begin() para cada clip registado; storage fica nullptr até ao primeiro pedido
+    struct ClipBuckets
+    {
+        int count = 0;
+        int channelCount = 0;
+        float width = 0.0f; // bucketWidth, ou mais se o clip passar de MAX_CLIP_BUCKETS
+        std::atomic<BucketStorage *> storage{nullptr};
+    };
+
+    struct alignas(64) WorkerStats
+    {
+        Stats stats;
+    };
+
+    const Skeleton &skeleton;
+    float bucketWidth;
+    std::vector<ClipBuckets *> clips;
+    std::vector<WorkerStats> workers;
+    Stats stats;
+
+    void release();
+    BucketStorage *allocate(ClipBuckets &buckets);
+};
@@ -0,0 +1,125 @@
+#include "Skeleton.hpp"
+#include "FixedRig.hpp"
+
+int Skeleton::addJoint(const std::string &name, int parent, const Vec3 &offset, JointAxis axis,
+                       const Vec3 &shapeOffset, const Vec3 &shapeScale, const Color &color)
+{
+    int index = getJointCount();
+    assert(parent < index && "Skeleton: parent must be added before its children");
+    names.push_back(name);
+    parents.push_back(parent);
+    offsets.push_back(offset);
+    axes.push_back(axis);
+    shapeOffsets.push_back(shapeOffset);
+    shapeScales.push_back(shapeScale);
+    colors.push_back(color);
+    return index;
+}
+
+int Skeleton::findJoint(const std::string &name) const
+{
+    for (int i = 0; i < getJointCount(); i++)
+    {
+        if (names[i] == name)
+            return i;
+    }
+    return -1;
+}
+
+void Skeleton::buildHierarchy(TransformHierarchy &transforms) const
+{
+    int count = getJointCount();
+    transforms.clear();
+    transforms.reserve(1 + count * 2);
+
+    transforms.addNode(-1);
+
+    for (int i = 0; i < count; i++)
+    {
+        int parent = (parents[i] < 0) ? GetRootNode() : GetJointNode(parents[i]);
+        transforms.addNode(parent, offsets[i]);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        transforms.addNode(GetJointNode(i), shapeOffsets[i], Quat(), shapeScales[i]);
+    }
+}
+
+static Quat AxisRotation(JointAxis axis, float angle)
+{
+    float s, c;
+    SinCos(angle * 0.5f, s, c);
+    switch (axis)
+    {
+    case JointAxis::X:
+        return Quat(c, s, 0.0f, 0.0f);
+    case JointAxis::Y:
+        return Quat(c, 0.0f, s, 0.0f);
+    default:
+        return Quat(c, 0.0f, 0.0f, s);
+    }
+}
+
+void Skeleton::applyPose(const Pose &pose, TransformHierarchy &transforms) const
+{
+    // Canais que faltam na pose (pose vazia ou de um rig menor) contam como zero
+    int count = getJointCount();
+    int posed = Min(count, pose.jointCount());
+
+    for (int i = 0; i < posed; i++)
+    {
+        transforms.setTranslation(GetJointNode(i), offsets[i] + pose.translation(i));
+        transforms.setRotation(GetJointNode(i), AxisRotation(axes[i], pose.rotation(i)));
+    }
+    for (int i = posed; i < count; i++)
+    {
+        transforms.setTranslation(GetJointNode(i), offsets[i]);
+        transforms.setRotation(GetJointNode(i), Quat());
+    }
+}
+
+void Skeleton::computeLocals(const Pose &pose, JointLocal *locals) const
+{
+    int count = getJointCount();
+    int posed = Min(count, pose.jointCount());
+
+    for (int i = 0; i < posed; i++)
+    {
+        locals[i].translation = offsets[i] + pose.translation(i);
+        locals[i].rotation = AxisRotation(axes[i], pose.rotation(i));
+    }
+    for (int i = posed; i < count; i++)
+    {
+        locals[i].translation = offsets[i];
+        locals[i].rotation = Quat();
+    }
+}
+
+void Skeleton::applyLocals(const JointLocal *locals, TransformHierarchy &transforms) const
+{
+    int count = getJointCount();
+    for (int i = 0; i < count; i++)
+    {
+        transforms.setTranslation(GetJointNode(i), locals[i].translation);
+        transforms.setRotation(GetJointNode(i), locals[i].rotation);
+    }
+}
+
+const Skeleton &Skeleton::Humanoid()
+{
+    static Skeleton skeleton;
+    if (skeleton.getJointCount() > 0)
+        return skeleton;
+
+    // A descrição do rig vive em HumanoidRig, partilhada com o caminho especializado (FixedRig)
+    for (const RigJoint &joint : HumanoidRig::JOINTS)
+    {
+        skeleton.addJoint(joint.name, joint.parent, Vec3(joint.offset[0], joint.offset[1], joint.offset[2]), joint.axis,
+                          Vec3(joint.shapeOffset[0], joint.shapeOffset[1], joint.shapeOffset[2]),
+                          Vec3(joint.shapeScale[0], joint.shapeScale[1], joint.shapeScale[2]),
+                          Color(joint.color[0], joint.color[1], joint.color[2]));
+    }
+
+    return skeleton;
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Core.hpp"
+
+enum class JointAxis
+{
+    X = 0,
+    Y,
+    Z
+};
+
+// Joints do rig humanoide, na ordem em que Skeleton::Humanoid() os cria (pais antes dos filhos)
+enum HumanJoint
+{
+    JOINT_TORSO = 0,
+    JOINT_HEAD,
+    JOINT_UPPER_ARM_L,
+    JOINT_FOREARM_L,
+    JOINT_UPPER_ARM_R,
+    JOINT_FOREARM_R,
+    JOINT_THIGH_L,
+    JOINT_CALF_L,
+    JOINT_THIGH_R,
+    JOINT_CALF_R,
+    HUMAN_JOINT_COUNT
+};
+
+// Pose de N joints em SoA: um ângulo por joint (à volta do eixo do joint) e uma
+// translação por joint (somada ao offset de bind).
+// Layout de channels: [rotação 0..N-1][tx 0..N-1][ty 0..N-1][tz 0..N-1]
+struct Pose
+{
+    std::vector<float> channels;
+
+    Pose() {}
+    explicit Pose(int jointCount) : channels(jointCount * 4, 0.0f) {}
+
+    int jointCount() const { return (int)channels.size() / 4; }
+    int channelCount() const { return (int)channels.size(); }
+
+    float &rotation(int joint) { return channels[joint]; }
+    float rotation(int joint) const { return channels[joint]; }
+
+    Vec3 translation(int joint) const
+    {
+        int n = jointCount();
+        return Vec3(channels[n + joint], channels[2 * n + joint], channels[3 * n + joint]);
+    }
+
+    void setTranslation(int joint, const Vec3 &t)
+    {
+        int n = jointCount();
+        channels[n + joint] = t.x;
+        channels[2 * n + joint] = t.y;
+        channels[3 * n + joint] = t.z;
+    }
+
+    // Um único loop sobre floats contíguos
+    static void lerp(const Pose &a, const Pose &b, float t, Pose &out)
+    {
+        size_t count = Min(a.channels.size(), b.channels.size());
+        out.channels.resize(count);
+        const float *pa = a.channels.data();
+        const float *pb = b.channels.data();
+        float *po = out.channels.data();
+        for (size_t i = 0; i < count; i++)
+        {
+            po[i] = pa[i] * (1 - t) + pb[i] * t;
+        }
+    }
+
+    static Pose lerp(const Pose &a, const Pose &b, float t)
+    {
+        Pose result;
+        lerp(a, b, t, result);
+        return result;
+    }
+};
+
+// Transformação local de um joint já resolvida a partir de uma pose (offset de bind + translação,
+// ângulo convertido em quaternião); é o que applyPose() escreve em cada nó da hierarquia
+struct JointLocal
+{
+    Vec3 translation;
+    Quat rotation;
+};
+
+// Asset de esqueleto: N joints com índice do pai, offset de bind, eixo de rotação
+// e a escala/cor do cubo desenhado em cada joint.
+// Layout dos nós na TransformHierarchy criada por buildHierarchy():
+//   nó 0              -> colocação do personagem (posição/orientação no mundo)
+//   nós 1 .. N        -> joints
+//   nós N+1 .. 2N     -> cubos (o array de matrizes world destas partes é contíguo)
+class Skeleton
+{
+public:
+    int addJoint(const std::string &name, int parent, const Vec3 &offset, JointAxis axis,
+                 const Vec3 &shapeOffset, const Vec3 &shapeScale, const Color &color);
+
+    int findJoint(const std::string &name) const;
+    int getJointCount() const { return (int)parents.size(); }
+
+    const std::string &getName(int joint) const { return names[joint]; }
+    int getParent(int joint) const { return parents[joint]; }
+    const Vec3 &getOffset(int joint) const { return offsets[joint]; }
+    JointAxis getAxis(int joint) const { return axes[joint]; }
+    const Vec3 &getShapeOffset(int joint) const { return shapeOffsets[joint]; }
+    const Vec3 &getShapeScale(int joint) const { return shapeScales[joint]; }
+    const Color &getColor(int joint) const { return colors[joint]; }
+
+    static int GetRootNode() { return 0; }
+    static int GetJointNode(int joint) { return 1 + joint; }
+    int getShapeNode(int joint) const { return 1 + getJointCount() + joint; }
+
+    void buildHierarchy(TransformHierarchy &transforms) const;
+    void applyPose(const Pose &pose, TransformHierarchy &transforms) const;
+
+    // applyPose() em dois passos, para o resultado do primeiro poder ser partilhado (PoseCache);
+    // locals tem getJointCount() entradas
+    void computeLocals(const Pose &pose, JointLocal *locals) const;
+    void applyLocals(const JointLocal *locals, TransformHierarchy &transforms) const;
+
+    Pose createPose() const { return Pose(getJointCount()); }
+
+    static const Skeleton &Humanoid();
+
+private:
+    std::vector<std::string> names;
+    std::vector<int> parents;
+    std::vector<Vec3> offsets;
+    std::vector<JointAxis> axes;
+    std::vector<Vec3> shapeOffsets;
+    std::vector<Vec3> shapeScales;
+    std::vector<Color> colors;
+};
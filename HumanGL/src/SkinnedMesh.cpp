@@ -0,0 +1,188 @@
+#include "SkinnedMesh.hpp"
+#include <cstring>
+
+// Mesma ordem de cantos e de faces que CreateCube()
+static const float CUBE_CORNERS[8][3] = {
+    {-0.5f, -0.5f, 0.5f}, {0.5f, -0.5f, 0.5f}, {0.5f, 0.5f, 0.5f}, {-0.5f, 0.5f, 0.5f},
+    {-0.5f, -0.5f, -0.5f}, {0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, -0.5f}, {-0.5f, 0.5f, -0.5f}};
+
+static const unsigned int CUBE_INDICES[36] = {
+    0, 1, 2, 0, 2, 3,  // Frente
+    1, 5, 6, 1, 6, 2,  // Direita
+    5, 4, 7, 5, 7, 6,  // Trás
+    4, 0, 3, 4, 3, 7,  // Esquerda
+    3, 2, 6, 3, 6, 7,  // Topo
+    4, 5, 1, 4, 1, 0}; // Base
+
+SkinnedMesh::SkinnedMesh(const Skeleton &skeleton) : skeleton(skeleton)
+{
+    int jointCount = skeleton.getJointCount();
+
+    // Bind pose: pose a zero com o personagem na origem
+    TransformHierarchy bind;
+    skeleton.buildHierarchy(bind);
+    bind.update();
+
+    inverseBind.resize(jointCount);
+    std::vector<SkinnedVertex> vertices;
+    vertices.reserve(jointCount * 8);
+    indices.reserve(jointCount * 36);
+    for (int joint = 0; joint < jointCount; joint++)
+    {
+        inverseBind[joint] = bind.getWorld(Skeleton::GetJointNode(joint)).inverseAffine();
+
+        const Mat4 &shape = bind.getWorld(skeleton.getShapeNode(joint));
+        const Color &color = skeleton.getColor(joint);
+        unsigned int first = (unsigned int)vertices.size();
+        for (int corner = 0; corner < 8; corner++)
+        {
+            Vec3 p = shape.transform(Vec3(CUBE_CORNERS[corner][0], CUBE_CORNERS[corner][1], CUBE_CORNERS[corner][2]));
+            SkinnedVertex v = {{p.x, p.y, p.z},
+                               {color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f},
+                               {(float)joint, 0.0f, 0.0f, 0.0f},
+                               {1.0f, 0.0f, 0.0f, 0.0f}};
+            vertices.push_back(v);
+        }
+        for (int i = 0; i < 36; i++)
+        {
+            indices.push_back(first + CUBE_INDICES[i]);
+        }
+    }
+    vertexCount = (int)vertices.size();
+    indexCount = (int)indices.size();
+
+    bindPositions.reserve(vertexCount);
+    jointStreams.resize(MAX_INFLUENCES * vertexCount);
+    weightStreams.resize(MAX_INFLUENCES * vertexCount);
+    colors.reserve(vertexCount * 4);
+    influenceCount = 1;
+    for (int i = 0; i < vertexCount; i++)
+    {
+        const SkinnedVertex &v = vertices[i];
+        bindPositions.push(Vec3(v.position[0], v.position[1], v.position[2]));
+        for (int k = 0; k < MAX_INFLUENCES; k++)
+        {
+            jointStreams[k * vertexCount + i] = (int32_t)v.joints[k];
+            weightStreams[k * vertexCount + i] = v.weights[k];
+            if (v.weights[k] != 0.0f)
+                influenceCount = Max(influenceCount, k + 1);
+        }
+        colors.insert(colors.end(), v.color, v.color + 4);
+    }
+
+    VertexFormat format;
+    format.addElement(VertexType::POSITION, 3);
+    format.addElement(VertexType::COLOR, 4);
+    format.addElement(VertexType::BLENDINDICES, MAX_INFLUENCES); // índices em float, o shader converte
+    format.addElement(VertexType::BLENDWEIGHTS, MAX_INFLUENCES);
+
+    mesh = new MeshBuffer();
+    mesh->CreateVertexBuffer(format, (unsigned int)vertices.size());
+    mesh->SetVertexData(vertices.data());
+    mesh->CreateIndexBuffer((unsigned int)indices.size());
+    mesh->SetIndexData(indices.data());
+
+    LogInfo("[SKIN] Mesh: %d joints, %d vertices, %d triangles", jointCount, getVertexCount(), indexCount / 3);
+}
+
+SkinnedMesh::~SkinnedMesh()
+{
+    paletteBuffer.Release();
+    if (mesh)
+    {
+        delete mesh;
+    }
+}
+
+void SkinnedMesh::computePalette(const Mat4 *worlds, SkinMatrix *out) const
+{
+    int jointCount = skeleton.getJointCount();
+    for (int joint = 0; joint < jointCount; joint++)
+    {
+        Mat4 skin = worlds[Skeleton::GetJointNode(joint)] * inverseBind[joint];
+        float *rows = out[joint].rows;
+        for (int r = 0; r < 3; r++)
+        {
+            *rows++ = skin.m[r];
+            *rows++ = skin.m[4 + r];
+            *rows++ = skin.m[8 + r];
+            *rows++ = skin.m[12 + r];
+        }
+    }
+}
+
+void SkinnedMesh::render(Shader &shader, const SkinMatrix *palettes, int count)
+{
+    if (count <= 0)
+        return;
+
+    paletteBuffer.SetData(palettes, (size_t)count * getJointCount() * sizeof(SkinMatrix));
+    paletteBuffer.Bind(PALETTE_BINDING);
+    shader.SetInt("jointCount", getJointCount());
+    mesh->RenderInstanced(static_cast<int>(PrimitiveType::TRIANGLES), indexCount, count);
+}
+
+//***********************************************************************************************************
+
+CpuSkinnedBatch::CpuSkinnedBatch(const SkinnedMesh &mesh, int capacity) : mesh(mesh), capacity(capacity)
+{
+    int meshVertices = mesh.getVertexCount();
+    int meshIndices = mesh.getIndexCount();
+
+    // A cor não muda: fica escrita de uma vez e o skin() só reescreve as posições
+    vertices.resize((size_t)capacity * meshVertices * VERTEX_FLOATS);
+    const std::vector<float> &colors = mesh.getColors();
+    for (int c = 0; c < capacity; c++)
+    {
+        float *v = &vertices[(size_t)c * meshVertices * VERTEX_FLOATS];
+        for (int i = 0; i < meshVertices; i++, v += VERTEX_FLOATS)
+            std::memcpy(v + 3, &colors[i * 4], 4 * sizeof(float));
+    }
+
+    std::vector<unsigned int> indices((size_t)capacity * meshIndices);
+    const std::vector<unsigned int> &meshIndexData = mesh.getIndices();
+    for (int c = 0; c < capacity; c++)
+    {
+        for (int i = 0; i < meshIndices; i++)
+            indices[(size_t)c * meshIndices + i] = (unsigned int)(c * meshVertices) + meshIndexData[i];
+    }
+
+    VertexFormat format;
+    format.addElement(VertexType::POSITION, 3);
+    format.addElement(VertexType::COLOR, 4);
+
+    buffer = new MeshBuffer(true);
+    buffer->CreateVertexBuffer(format, (unsigned int)(capacity * meshVertices));
+    buffer->CreateIndexBuffer((unsigned int)indices.size());
+    buffer->SetIndexData(indices.data());
+
+    LogInfo("[SKIN] CPU batch: %d characters, %.1f KB of vertices per frame", capacity,
+            vertices.size() * sizeof(float) / 1024.0f);
+}
+
+CpuSkinnedBatch::~CpuSkinnedBatch()
+{
+    if (buffer)
+    {
+        delete buffer;
+    }
+}
+
+void CpuSkinnedBatch::skin(int index, const SkinMatrix *palette)
+{
+    assert(index >= 0 && index < capacity);
+    float *out = &vertices[(size_t)index * mesh.getVertexCount() * VERTEX_FLOATS];
+    SkinPoints(palette[0].rows, mesh.getBindPositions(), mesh.getJointStreams(), mesh.getWeightStreams(),
+               mesh.getInfluenceCount(), out, VERTEX_FLOATS);
+}
+
+void CpuSkinnedBatch::render(int count)
+{
+    count = Min(count, capacity);
+    if (count <= 0)
+        return;
+
+    buffer->SetVertexData(vertices.data(), (unsigned int)(count * mesh.getVertexCount()));
+    buffer->Render(static_cast<int>(PrimitiveType::TRIANGLES), count * mesh.getIndexCount());
+}
+
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include "Core.hpp"
+#include "Skeleton.hpp"
+
+// Vértice skinned: posição em bind pose (espaço do personagem), cor e até 4 joints com pesos.
+// Locations 0 (position), 1 (color), 2 (BLENDINDICES) e 3 (BLENDWEIGHTS).
+struct SkinnedVertex
+{
+    float position[3];
+    float color[4];
+    float joints[4];
+    float weights[4];
+};
+
+// Matriz de skinning de um joint (pose atual * inversa do bind) guardada como as 3 primeiras
+// linhas da matriz afim, o mesmo layout que a AnimationPalette usa por joint
+struct SkinMatrix
+{
+    float rows[12];
+};
+
+// Todas as partes do personagem num só MeshBuffer com índices e pesos de joints, desenhadas com
+// um draw por chamada a render(): as matrizes dos joints vão num shader storage buffer
+// (binding 0, vec4 skinRows[], 3 por joint e jointCount por personagem) e o vertex shader faz o
+// skinning. As partes do rig são cubos rígidos (um joint com peso 1), mas o formato aceita um mesh
+// contínuo com vértices partilhados entre joints.
+class SkinnedMesh
+{
+public:
+    static constexpr int MAX_INFLUENCES = 4;
+    static constexpr int PALETTE_BINDING = 0;
+
+    explicit SkinnedMesh(const Skeleton &skeleton);
+    ~SkinnedMesh();
+
+    int getJointCount() const { return skeleton.getJointCount(); }
+    int getVertexCount() const { return vertexCount; }
+    int getIndexCount() const { return indexCount; }
+    // Influências com peso em algum vértice (1 para as partes rígidas); o resto das streams é zero
+    int getInfluenceCount() const { return influenceCount; }
+
+    // Cópia em SoA para o skinning na CPU (SkinPoints): posições em bind pose e, por influência k,
+    // joints[k * vértices + i] / weights[k * vértices + i]; colors tem RGBA por vértice
+    const Vec3Stream &getBindPositions() const { return bindPositions; }
+    const int32_t *getJointStreams() const { return jointStreams.data(); }
+    const float *getWeightStreams() const { return weightStreams.data(); }
+    const std::vector<float> &getColors() const { return colors; }
+    const std::vector<unsigned int> &getIndices() const { return indices; }
+
+    // Matrizes de skinning a partir das matrizes world dos nós, na ordem de Skeleton::buildHierarchy()
+    // (Humanoid::getWorldMatrices()); out recebe getJointCount() matrizes. Pode correr num job.
+    void computePalette(const Mat4 *worlds, SkinMatrix *out) const;
+
+    // Desenha count personagens; palettes tem count * getJointCount() matrizes contíguas
+    void render(Shader &shader, const SkinMatrix *palettes, int count);
+
+private:
+    SkinnedMesh(const SkinnedMesh &) = delete;
+    SkinnedMesh &operator=(const SkinnedMesh &) = delete;
+
+    const Skeleton &skeleton;
+    std::vector<Mat4> inverseBind;
+    Vec3Stream bindPositions;
+    std::vector<int32_t> jointStreams;
+    std::vector<float> weightStreams;
+    std::vector<float> colors;
+    std::vector<unsigned int> indices;
+    MeshBuffer *mesh;
+    ShaderBuffer paletteBuffer;
+    int vertexCount;
+    int indexCount;
+    int influenceCount;
+};
+
+// Skinning na CPU, para GL por software (llvmpipe) onde o vertex shader de skinning é o custo
+// maior: os vértices de todos os personagens são transformados com o kernel SIMD SkinPoints para
+// um único MeshBuffer dinâmico (posição + cor, índices já deslocados por personagem), enviado uma
+// vez por frame e desenhado com um draw. O shader só aplica view/projection.
+class CpuSkinnedBatch
+{
+public:
+    CpuSkinnedBatch(const SkinnedMesh &mesh, int capacity);
+    ~CpuSkinnedBatch();
+
+    int getCapacity() const { return capacity; }
+
+    // Escreve os vértices do personagem index (só toca na sua parte do buffer, por isso
+    // personagens diferentes podem ser transformados em jobs diferentes)
+    void skin(int index, const SkinMatrix *palette);
+
+    // Envia os count primeiros personagens e desenha-os
+    void render(int count);
+
+private:
+    CpuSkinnedBatch(const CpuSkinnedBatch &) = delete;
+    CpuSkinnedBatch &operator=(const CpuSkinnedBatch &) = delete;
+
+    static const int VERTEX_FLOATS = 7; // posição + cor
+
+    const SkinnedMesh &mesh;
+    int capacity;
+    std::vector<float> vertices;
+    MeshBuffer *buffer;
+};
+
@@ -1,39 +1,120 @@
 
 #include "Core.hpp"
 #include "Animation.hpp"
+#include "Crowd.hpp"
+#include "AnimationPalette.hpp"
+#include "ClipFile.hpp"
+#include "SkinnedMesh.hpp"
+#include "PoseCache.hpp"
 
 int main(int argc, char *argv[])
 {
+    // --crowd N : N humanoides animados desenhados com instancing (sem vsync, para medir o frame time)
+    // --workers N : threads do job system (0 = uma por core, 1 = tudo na thread principal)
+    // --palette FILE : palette de animação pré-calculada; se não existir é gerada ao arrancar e gravada
+    // --gpu : a multidão começa com a animação avaliada na GPU (tecla B alterna)
+    // --clips FILE : clips binários (.clips) mapeados ao arrancar; substituem os clips de demonstração com o mesmo nome
+    // --convert IN OUT : converte um .anim de texto num .clips e sai
+    // --cpuskin : skinning na CPU para um buffer dinâmico em vez do vertex shader (tecla C alterna)
+    // --bucket MS : largura dos baldes de poses partilhadas pela multidão (0 desliga; tecla P alterna)
+    // --hierarchy : a multidão começa com a hierarquia genérica em vez do rig especializado (tecla R alterna)
+    // --shadercache DIR : pasta dos programas já linkados (por omissão a pasta de preferências do SDL; "" desliga)
+    int crowdSize = 0;
+    int workerCount = 0;
+    std::string palettePath;
+    std::string clipsPath;
+    bool crowdBaked = false;
+    bool cpuSkinning = false;
+    float poseBucketMs = 1000.0f / 60.0f;
+    bool fixedRig = true;
+    std::string shaderCachePath;
+    bool shaderCacheSet = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--crowd") == 0 && i + 1 < argc)
+        {
+            crowdSize = Max(0, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--workers") == 0 && i + 1 < argc)
+        {
+            workerCount = Max(0, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--palette") == 0 && i + 1 < argc)
+        {
+            palettePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--gpu") == 0)
+        {
+            crowdBaked = true;
+        }
+        else if (strcmp(argv[i], "--cpuskin") == 0)
+        {
+            cpuSkinning = true;
+        }
+        else if (strcmp(argv[i], "--bucket") == 0 && i + 1 < argc)
+        {
+            poseBucketMs = Max(0.0f, (float)atof(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--hierarchy") == 0)
+        {
+            fixedRig = false;
+        }
+        else if (strcmp(argv[i], "--shadercache") == 0 && i + 1 < argc)
+        {
+            shaderCachePath = argv[++i];
+            shaderCacheSet = true;
+        }
+        else if (strcmp(argv[i], "--clips") == 0 && i + 1 < argc)
+        {
+            clipsPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--convert") == 0 && i + 2 < argc)
+        {
+            return ConvertClipText(argv[i + 1], argv[i + 2]) ? 0 : 1;
+        }
+    }
+
+    InitJobs(workerCount);
+
     Device *window = Device::GetInstance();
 
     bool ABORT = false;
 
-    if (!window->Init("HumanGL BY Luis Santos AKA DJOKER", 800, 600))
+    if (!window->Init("HumanGL BY Luis Santos AKA DJOKER", 800, 600, crowdSize == 0))
     {
         return 1;
     }
 
+    if (!shaderCacheSet)
+    {
+        char *prefPath = SDL_GetPrefPath("djoker", "HumanGL");
+        if (prefPath)
+        {
+            shaderCachePath = std::string(prefPath) + "shaders";
+            SDL_free(prefPath);
+        }
+    }
+    Shader::SetBinaryCache(shaderCachePath);
+
     RenderBatch batch;
     batch.Init(1, 1024);
     Shader shader;
-    Shader shaderCube;
+    Shader shaderBaked;
     Font font;
 
 
     {
-        const char *vShader = GLSL(
+        const char *vShader = GLSL_FRAME(
             layout(location = 0) in vec3 position;
             layout(location = 1) in vec2 texCoord;
             layout(location = 2) in vec4 color;
 
             uniform mat4 model;
-            uniform mat4 view;
-            uniform mat4 projection;
 
             out vec2 TexCoord;
             out vec4 vertexColor;
             void main() {
-                gl_Position = projection * view * model * vec4(position, 1.0);
+                gl_Position = viewProj * model * vec4(position, 1.0);
                 TexCoord = texCoord;
                 vertexColor = color;
             });
@@ -51,45 +132,255 @@ int main(int argc, char *argv[])
         shader.LoadDefaults();
     }
 
+    // O shader do batch fica pronto já (desenha o ecrã de loading); os restantes compilam todos ao mesmo tempo
+    ShaderCompileQueue compileQueue;
+
+    // Personagens: um só shader com variantes (em vez de quatro cópias quase iguais), cada draw usa
+    // a mais simples que lhe serve:
+    //   sem features - cubo a cubo, model e difusse em uniforms (Humanoid::render)
+    //   INSTANCED    - matriz e cor por instância (CrowdRenderer)
+    //   VERTEX_COLOR - vértices já no mundo com cor por vértice (CpuSkinnedBatch)
+    //   SKINNED      - skinning com a palette no storage buffer, 3 linhas por joint e jointCount por
+    //                  instância (SkinnedMesh); usa também a cor por vértice
+    const char *actorVertex = GLSL_VERSION FRAME_UNIFORMS_GLSL R"(
+        layout(location = 0) in vec3 position;
+    #if defined(INSTANCED)
+        layout(location = 1) in mat4 instanceModel;
+        layout(location = 5) in vec4 instanceColor;
+    #elif defined(VERTEX_COLOR) || defined(SKINNED)
+        layout(location = 1) in vec4 color;
+    #else
+        uniform mat4 model;
+        uniform vec3 difusse;
+    #endif
+    #if defined(SKINNED)
+        layout(location = 2) in vec4 jointIndices;
+        layout(location = 3) in vec4 jointWeights;
+
+        layout(std430, binding = 0) readonly buffer SkinPalette {
+            vec4 skinRows[];
+        };
+
+        uniform int jointCount;
+    #endif
+
+        out vec3 diffuse;
+
+        void main() {
+            vec4 p = vec4(position, 1.0);
+    #if defined(SKINNED)
+            int base = gl_InstanceID * jointCount;
+            vec3 world = vec3(0.0);
+            for (int i = 0; i < 4; i++)
+            {
+                float w = jointWeights[i];
+                if (w > 0.0)
+                {
+                    int row = (base + int(jointIndices[i])) * 3;
+                    world += w * vec3(dot(skinRows[row], p), dot(skinRows[row + 1], p), dot(skinRows[row + 2], p));
+                }
+            }
+            gl_Position = viewProj * vec4(world, 1.0);
+            diffuse = color.rgb;
+    #elif defined(INSTANCED)
+            gl_Position = viewProj * instanceModel * p;
+            diffuse = instanceColor.rgb;
+    #elif defined(VERTEX_COLOR)
+            gl_Position = viewProj * p;
+            diffuse = color.rgb;
+    #else
+            gl_Position = viewProj * model * p;
+            diffuse = difusse;
+    #endif
+        }
+    )";
+
+    const char *actorFragment = GLSL(
+        in vec3 diffuse;
+        out vec4 color;
+        void main() {
+            color = vec4(diffuse, 1.0);
+        });
+
+    ShaderVariants actorShaders(actorVertex, actorFragment, {"INSTANCED", "VERTEX_COLOR", "SKINNED"});
+    const ShaderFeatures ACTOR_INSTANCED = actorShaders.GetFeature("INSTANCED");
+    const ShaderFeatures ACTOR_VERTEX_COLOR = actorShaders.GetFeature("VERTEX_COLOR");
+    const ShaderFeatures ACTOR_SKINNED = actorShaders.GetFeature("SKINNED");
+    const ShaderFeatures actorVariants[] = {0, ACTOR_INSTANCED, ACTOR_VERTEX_COLOR, ACTOR_SKINNED};
+    actorShaders.Prewarm(compileQueue, actorVariants, 4);
+
     {
-        const char *vShader = GLSL(
+        // Multidão avaliada na GPU: a matriz de cada cubo vem da palette (3 linhas por joint),
+        // interpolada entre os dois frames do clip à volta de crowdTime - início da instância
+        // (time já é o relógio global do bloco Frame)
+        const char *vShader = GLSL_FRAME(
             layout(location = 0) in vec3 position;
+            layout(location = 1) in vec4 instancePlacement;
+            layout(location = 2) in float instanceClip;
 
-            uniform mat4 model;
-            uniform mat4 view;
-            uniform mat4 projection;
+            uniform sampler2D palette;
+            uniform int jointCount;
+            uniform float crowdTime;
+            uniform vec4 clipTable[64];
+            uniform vec4 jointColors[32];
+
+            out vec3 difusse;
+
+            vec4 paletteRow(int column, int row0, int row1, float w) {
+                return mix(texelFetch(palette, ivec2(column, row0), 0), texelFetch(palette, ivec2(column, row1), 0), w);
+            }
 
             void main() {
-                gl_Position = projection * view * model * vec4(position, 1.0);
+                vec4 clip = clipTable[clamp(int(instanceClip), 0, 63)];
+                bool loop = clip.w > 0.5;
+                float last = clip.y - 1.0;
+                float frame = max(crowdTime - instancePlacement.w, 0.0) * clip.z;
+                frame = loop ? mod(frame, clip.y) : min(frame, last);
+                float f0 = floor(frame);
+                float f1 = (f0 + 1.0 > last) ? (loop ? 0.0 : last) : f0 + 1.0;
+                float w = frame - f0;
+                int row0 = int(clip.x + f0);
+                int row1 = int(clip.x + f1);
+
+                int joint = gl_InstanceID % jointCount;
+                vec4 p = vec4(position, 1.0);
+                vec3 world = vec3(dot(paletteRow(joint * 3, row0, row1, w), p),
+                                  dot(paletteRow(joint * 3 + 1, row0, row1, w), p),
+                                  dot(paletteRow(joint * 3 + 2, row0, row1, w), p));
+                gl_Position = viewProj * vec4(world + instancePlacement.xyz, 1.0);
+                difusse = jointColors[joint].rgb;
             });
 
         const char *fShader = GLSL(
+            in vec3 difusse;
             out vec4 color;
-            uniform vec3 difusse;
             void main() {
                 color = vec4(difusse, 1.0);
             });
 
-        if (!shaderCube.Create(vShader, fShader))
-        {
-            ABORT = true;
-        }
-        shaderCube.LoadDefaults();
+        compileQueue.Add(shaderBaked, vShader, fShader);
     }
 
     font.LoadDefaultFont();
     font.SetBatch(&batch);
     font.SetSize(12);
 
+    // Ecrã de loading enquanto o driver acaba os programas
+    Mat4 identity = Mat4::Identity();
+    while (!compileQueue.Poll())
+    {
+        if (!window->Running())
+        {
+            ABORT = true;
+            break;
+        }
+        Driver::Instance().SetViewport(0, 0, window->GetWidth(), window->GetHeight());
+        Driver::Instance().SetBlend(true);
+        Driver::Instance().SetBlendMode(BlendMode::BLEND);
+        Driver::Instance().SetDepthTest(false);
+        Driver::Instance().Clear();
+        Mat4 ortho = Mat4::Ortho(0.0f, window->GetWidth(), window->GetHeight(), 0.0f, -1.0f, 1.0f);
+        Driver::Instance().SetFrameUniforms(identity, ortho, Vec3(0.0f, 0.0f, 0.0f), 0.0f);
+        shader.Use();
+        shader.SetMatrix4("model", identity.m);
+        batch.SetColor(255, 255, 255, 255);
+        font.Print(10, 20, "Compiling shaders %d/%d", compileQueue.GetReadyCount(), compileQueue.GetCount());
+        batch.Render();
+        window->Swap();
+    }
+    compileQueue.Wait();
+    if (compileQueue.GetFailedCount() > 0)
+    {
+        ABORT = true;
+    }
+    Shader &shaderCube = actorShaders.Get(0);
+    Shader &shaderCrowd = actorShaders.Get(ACTOR_INSTANCED);
+    Shader &shaderColor = actorShaders.Get(ACTOR_VERTEX_COLOR);
+    Shader &shaderSkinned = actorShaders.Get(ACTOR_SKINNED);
+    shaderCube.LoadDefaults();
+    shaderCrowd.LoadDefaults();
+    shaderBaked.LoadDefaults();
+    shaderSkinned.LoadDefaults();
+    shaderColor.LoadDefaults();
+    Shader::LogBuildStats();
+
     Camera camera(800.0f / 600.0f);
 
     Driver::Instance().SetClearColor(0.2f, 0.3f, 0.3f, 1.0);
 
+    float elapsedTime = 0.0f;
     float cameraSpeed = 0.5f;
     float mouseSensitivity = 0.1f;
 
+    // Os clips do ficheiro entram primeiro, por isso ficam com os nomes dos clips de demonstração
+    if (!clipsPath.empty() && LoadClipFile(clipsPath, AnimationLibrary::Instance()) < 0)
+        LogError("Failed to load clips from %s", clipsPath.c_str());
+
     Humanoid human;
 
+    // Personagem inteiro num só draw (tecla K volta aos cubos separados)
+    SkinnedMesh skinnedMesh(Skeleton::Humanoid());
+    std::vector<SkinMatrix> skinPalettes(Max(crowdSize, 1) * skinnedMesh.getJointCount());
+    bool skinned = true;
+    CpuSkinnedBatch cpuSkinned(skinnedMesh, Max(crowdSize, 1));
+
+    // Multidão: todos os personagens partilham os clips da AnimationLibrary (o `human` já os registou)
+    CrowdRenderer *crowd = nullptr;
+    std::vector<Humanoid *> crowdHumans;
+    bool crowdInstanced = true;
+    float crowdUpdateMs = 0.0f;
+    AnimationPalette *palette = nullptr;
+    BakedCrowdRenderer *bakedCrowd = nullptr;
+    float crowdTime = 0.0f;
+    AnimationLod animationLod; // L liga/desliga
+    PoseCache poseCache(Skeleton::Humanoid(), poseBucketMs > 0.0f ? poseBucketMs / 1000.0f : 1.0f / 60.0f);
+    poseCache.enabled = poseBucketMs > 0.0f; // P liga/desliga
+    if (crowdSize > 0)
+    {
+        crowd = new CrowdRenderer(crowdSize * HUMAN_JOINT_COUNT);
+
+        AnimationLibrary &library = AnimationLibrary::Instance();
+        ClipId clips[] = {library.find("walk"), library.find("dance"), library.find("fight"), library.find("jump")};
+        int side = (int)ceilf(sqrtf((float)crowdSize));
+        crowdHumans.reserve(crowdSize);
+        for (int i = 0; i < crowdSize; i++)
+        {
+            Humanoid *h = new Humanoid(crowd->getCubeMesh());
+            h->setPosition(Vec3((i % side - side / 2) * 3.0f, 0.0f, -(i / side) * 3.0f));
+            h->playAnimation(clips[i % 4]);
+            h->setAnimationTime(fmodf(i * 0.37f, 1.0f));
+            h->setLodPhase(i);
+            h->setPoseCache(&poseCache);
+            h->setFixedRig(fixedRig);
+            crowdHumans.push_back(h);
+        }
+        LogInfo("[CROWD] %d humanoids, %d cubes", crowdSize, crowdSize * HUMAN_JOINT_COUNT);
+
+        // Mesma multidão para o caminho da GPU (tecla B): só os clips que a demo usa (os mesmos
+        // das teclas 1-4), pré-amostrados a 30 fps; com --clips a biblioteca não cabe na tabela
+        palette = new AnimationPalette();
+        std::vector<ClipId> bakedClips(clips, clips + 4);
+        if (palettePath.empty() || !palette->load(palettePath, library, Skeleton::Humanoid(), bakedClips))
+        {
+            palette->bake(library, Skeleton::Humanoid(), 30.0f, bakedClips);
+            if (!palettePath.empty())
+                palette->save(palettePath);
+        }
+        palette->upload();
+
+        bakedCrowd = new BakedCrowdRenderer(Skeleton::Humanoid(), crowdSize);
+        for (int i = 0; i < crowdSize; i++)
+        {
+            BakedInstance instance;
+            instance.position[0] = (i % side - side / 2) * 3.0f;
+            instance.position[1] = 0.0f;
+            instance.position[2] = -(i / side) * 3.0f;
+            instance.startTime = -fmodf(i * 0.37f, 1.0f);
+            instance.clip = (float)palette->getSlot(clips[i % 4]);
+            bakedCrowd->getInstances().push_back(instance);
+        }
+    }
+
 
     GUI *widgets = GUI::Instance();
 
@@ -171,51 +462,198 @@ int main(int argc, char *argv[])
         Driver::Instance().SetDepthWrite(true);
         Driver::Instance().Clear();
 
-        glViewport(0, 0, window->GetWidth(), window->GetHeight());
+        Driver::Instance().SetViewport(0, 0, window->GetWidth(), window->GetHeight());
 
         Mat4 projection = camera.getProjectionMatrix();
         Mat4 view = camera.getViewMatrix();
         camera.setAspectRatio(window->GetWidth() / window->GetHeight());
 
-        Mat4 identity = Mat4::Identity();
+        // view/projection de todos os shaders num só upload (bloco Frame)
+        elapsedTime += delta;
+        Driver::Instance().SetFrameUniforms(view, projection, camera.getPosition(), elapsedTime);
 
         // Render Scene
 
+        const char *playName = nullptr;
         if (Input::IsKeyDown(SDLK_1))
         {
-            human.playAnimation("walk");
+            playName = "walk";
         }
         else if (Input::IsKeyDown(SDLK_2))
         {
-            human.playAnimation("jump");
+            playName = "jump";
         }else if (Input::IsKeyDown(SDLK_3))
         {
-            human.playAnimation("dance");
+            playName = "dance";
         }
          else if (Input::IsKeyDown(SDLK_4))
         {
-            human.playAnimation("fight");
+            playName = "fight";
         }
 
-
-        shaderCube.Use();
-        shaderCube.SetMatrix4("model", identity.m);
-        shaderCube.SetMatrix4("view", view.m);
-        shaderCube.SetMatrix4("projection", projection.m);
-
-     
-        human.render(shaderCube);
-
-   
-
-        human.animate(delta);
+        if (crowd)
+        {
+            // I alterna entre um draw instanciado e um draw por cubo, para comparar;
+            // B passa a animação para a GPU (palette pré-calculada); K desenha com o mesh skinned,
+            // C faz esse skinning na CPU; L liga o LOD da animação, P a partilha de poses e R o rig especializado
+            if (Input::IsKeyPressed(SDLK_I))
+            {
+                crowdInstanced = !crowdInstanced;
+            }
+            if (Input::IsKeyPressed(SDLK_B))
+            {
+                crowdBaked = !crowdBaked;
+            }
+            if (Input::IsKeyPressed(SDLK_K))
+            {
+                skinned = !skinned;
+            }
+            if (Input::IsKeyPressed(SDLK_C))
+            {
+                cpuSkinning = !cpuSkinning;
+            }
+            if (Input::IsKeyPressed(SDLK_L))
+            {
+                animationLod.enabled = !animationLod.enabled;
+            }
+            if (Input::IsKeyPressed(SDLK_P))
+            {
+                poseCache.enabled = !poseCache.enabled;
+            }
+            if (Input::IsKeyPressed(SDLK_R))
+            {
+                fixedRig = !fixedRig;
+                for (Humanoid *h : crowdHumans)
+                    h->setFixedRig(fixedRig);
+            }
+            crowdTime += delta;
+
+            if (crowdBaked)
+            {
+                // Só os registos dos personagens que trocam de clip mudam; o resto é trabalho da GPU
+                ClipId playClip = playName ? AnimationLibrary::Instance().find(playName) : INVALID_CLIP;
+                int playSlot = palette->getSlot(playClip);
+                if (playSlot >= 0)
+                {
+                    for (BakedInstance &instance : bakedCrowd->getInstances())
+                    {
+                        instance.clip = (float)playSlot;
+                        instance.startTime = crowdTime;
+                    }
+                    bakedCrowd->markDirty();
+                }
+
+                shaderBaked.Use();
+                bakedCrowd->render(shaderBaked, *palette, crowdTime);
+                crowdUpdateMs = 0.0f;
+            }
+            else
+            {
+                // Cada humanoide só mexe no seu estado, por isso a animação corre em paralelo;
+                // o envio para o renderer fica na thread principal
+                ClipId playClip = playName ? AnimationLibrary::Instance().find(playName) : INVALID_CLIP;
+                Uint64 updateStart = SDL_GetPerformanceCounter();
+                animationLod.begin(camera);
+                poseCache.begin();
+                ParallelFor((int)crowdHumans.size(), [&](int begin, int end)
+                            {
+                    for (int i = begin; i < end; i++)
+                    {
+                        Humanoid *h = crowdHumans[i];
+                        if (playClip != INVALID_CLIP)
+                            h->playAnimation(playClip);
+                        h->animate(delta, animationLod);
+                        h->updateTransforms();
+                        if (skinned)
+                        {
+                            SkinMatrix *palette = &skinPalettes[i * skinnedMesh.getJointCount()];
+                            skinnedMesh.computePalette(h->getWorldMatrices(), palette);
+                            if (cpuSkinning)
+                                cpuSkinned.skin(i, palette);
+                        }
+                    } }, 16);
+                crowdUpdateMs = (float)((SDL_GetPerformanceCounter() - updateStart) * 1000.0 / SDL_GetPerformanceFrequency());
+                animationLod.end();
+                poseCache.end();
+
+                if (skinned && cpuSkinning)
+                {
+                    shaderColor.Use();
+                    cpuSkinned.render((int)crowdHumans.size());
+                }
+                else if (skinned)
+                {
+                    shaderSkinned.Use();
+                    skinnedMesh.render(shaderSkinned, skinPalettes.data(), (int)crowdHumans.size());
+                }
+                else if (crowdInstanced)
+                {
+                    crowd->begin();
+                    for (Humanoid *h : crowdHumans)
+                    {
+                        h->submit(*crowd);
+                    }
+
+                    shaderCrowd.Use();
+                    crowd->render();
+                }
+                else
+                {
+                    shaderCube.Use();
+                    for (Humanoid *h : crowdHumans)
+                    {
+                        h->render(shaderCube);
+                    }
+                }
+            }
+        }
+        else
+        {
+            if (playName)
+            {
+                human.playAnimation(playName);
+            }
+            if (Input::IsKeyPressed(SDLK_K))
+            {
+                skinned = !skinned;
+            }
+            if (Input::IsKeyPressed(SDLK_C))
+            {
+                cpuSkinning = !cpuSkinning;
+            }
+
+            if (skinned)
+            {
+                human.updateTransforms();
+                skinnedMesh.computePalette(human.getWorldMatrices(), skinPalettes.data());
+
+                if (cpuSkinning)
+                {
+                    cpuSkinned.skin(0, skinPalettes.data());
+                    shaderColor.Use();
+                    cpuSkinned.render(1);
+                }
+                else
+                {
+                    shaderSkinned.Use();
+                    skinnedMesh.render(shaderSkinned, skinPalettes.data(), 1);
+                }
+            }
+            else
+            {
+                shaderCube.Use();
+                shaderCube.SetMatrix4("model", identity.m);
+
+                human.render(shaderCube);
+            }
+
+            human.animate(delta);
+        }
 
         // Render 3d Batch
 
         shader.Use();
         shader.SetMatrix4("model", identity.m);
-        shader.SetMatrix4("view", view.m);
-        shader.SetMatrix4("projection", projection.m);
         batch.SetColor(255, 255, 255, 255);
 
         batch.Grid(10, 10);
@@ -229,27 +667,65 @@ int main(int argc, char *argv[])
         Driver::Instance().SetDepthTest(false);
         Driver::Instance().SetDepthWrite(false);
 
+        // O overlay 2D volta a carregar o bloco Frame com a câmara ortográfica
+        Driver::Instance().SetFrameUniforms(identity, projection, camera.getPosition(), elapsedTime);
+
         shader.Use();
         shader.SetMatrix4("model", identity.m);
-        shader.SetMatrix4("view", identity.m);
-        shader.SetMatrix4("projection", projection.m);
         batch.SetColor(255, 255, 255, 255);
 
         widgets->Render(&batch);
 
         font.Print(10, 20, "FPS %d Focus %d", window->GetFPS(), (widgets->Focus() ? 1 : 0));
+        if (crowd)
+        {
+            font.Print(10, 40, "Crowd %d  %s  frame %.2f ms", crowdSize,
+                       crowdBaked ? "GPU palette (1 draw)" : (skinned ? (cpuSkinning ? "CPU skinned (1 draw)" : "skinned (1 draw)") : (crowdInstanced ? "instanced (1 draw)" : "per cube")), delta * 1000.0f);
+            font.Print(10, 60, "Animation %.2f ms on %d worker(s), %s", crowdUpdateMs, GetJobWorkerCount(),
+                       fixedRig ? "fixed rig" : "hierarchy");
+            if (!crowdBaked)
+            {
+                // Personagens e tempo de animate() (somado em todos os workers) por nível de LOD
+                const AnimationLod::Stats &lodStats = animationLod.getStats();
+                font.Print(10, 80, "LOD %s  full %d/%.2f ms  interp %d/%.2f ms  root %d/%.2f ms  frozen %d/%.2f ms",
+                           animationLod.enabled ? "on" : "off",
+                           lodStats.count[ANIM_LOD_FULL], lodStats.ms[ANIM_LOD_FULL],
+                           lodStats.count[ANIM_LOD_INTERPOLATED], lodStats.ms[ANIM_LOD_INTERPOLATED],
+                           lodStats.count[ANIM_LOD_ROOT], lodStats.ms[ANIM_LOD_ROOT],
+                           lodStats.count[ANIM_LOD_FROZEN], lodStats.ms[ANIM_LOD_FROZEN]);
+                const PoseCache::Stats &poseStats = poseCache.getStats();
+                font.Print(10, 100, "Pose cache %s  %.1f ms buckets  hits %d/%d (%.0f%%)  evaluated %d  contended %d",
+                           poseCache.enabled ? "on" : "off", poseCache.getBucketWidth() * 1000.0f,
+                           poseStats.hits, poseStats.requests, poseStats.hitRate() * 100.0f,
+                           poseStats.evaluations, poseStats.contended);
+            }
+        }
 
         batch.Render();
 
         window->Swap();
     }
 
+    for (Humanoid *h : crowdHumans)
+    {
+        delete h;
+    }
+    delete crowd;
+    delete bakedCrowd;
+    if (palette)
+    {
+        palette->release();
+        delete palette;
+    }
+
     widgets->Clear();
     font.Release();
     batch.Release();
     shader.Release();
-    shaderCube.Release();
+    shaderBaked.Release();
+    actorShaders.Release();
     window->Cleanup();
     Device::DestroyInstance();
+    ShutdownJobs();
     return 0;
 }
\ No newline at end of file
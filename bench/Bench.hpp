@@ -0,0 +1,25 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+
+// Tiny timing helpers shared by the benchmarks. Numbers are only meaningful in a
+// Release build (-DCMAKE_BUILD_TYPE=Release).
+
+// Keeps results alive so the optimizer cannot drop the measured work
+inline volatile float g_benchSink = 0.0f;
+
+// Best of `runs` timings of body(), in nanoseconds per item
+template <typename Body>
+double BenchBest(int runs, int items, const Body &body)
+{
+    double best = 1e300;
+    for (int run = 0; run < runs; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (ns < best)
+            best = ns;
+    }
+    return best / (items > 0 ? items : 1);
+}
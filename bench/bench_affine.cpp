@@ -0,0 +1,151 @@
+#include "Bench.hpp"
+#include "Math.hpp"
+#include <cmath>
+
+// Affine3x4 vs Mat4 on the same humanoid walk (10 parts):
+//   - Mat4 full:      every translate/rotate/scale builds a Mat4 and does a 4x4 product
+//                     (MatrixStack before the in-place ops);
+//   - Mat4 in place:  Mat4::apply* on the top of a FixedMatrixStack (what MatrixStack does now);
+//   - Affine3x4:      the same apply* ops on a stack of 3x4 matrices, storing 12 floats per part.
+// The three paths are checked against each other before timing.
+//
+// Affine3x4 loses here and MatrixStack stays on Mat4: a Mat4 column is 4 floats, so each
+// apply* step is one SIMD multiply-add per column, while the 3-float columns of Affine3x4
+// do not fill a register and the same steps run mostly scalar. The 12-float type is kept
+// for the MathStreams kernels (TransformPoints/TransformNormals): there the matrix is only
+// broadcast once per stream, and the cost is in the points.
+
+static const int HUMANOIDS = 200000;
+static const int RUNS = 10;
+static const int PARTS = 10;
+
+// Mat4 stack that composes full matrices like the original MatrixStack
+struct FullMat4Stack
+{
+    Mat4 stack[8];
+    int count = 1;
+
+    void identity() { count = 1, stack[0] = Mat4(); }
+    void push() { stack[count] = stack[count - 1], count++; }
+    void pop() { count--; }
+    const Mat4 &top() const { return stack[count - 1]; }
+    void translate(float x, float y, float z) { stack[count - 1] = stack[count - 1] * Mat4::Translate(Vec3(x, y, z)); }
+    void scale(float x, float y, float z) { stack[count - 1] = stack[count - 1] * Mat4::Scale(Vec3(x, y, z)); }
+    void rotateX(float a) { stack[count - 1] = stack[count - 1] * Mat4::Rotate(Quat(a, Vec3(1.0f, 0.0f, 0.0f))); }
+    void rotateY(float a) { stack[count - 1] = stack[count - 1] * Mat4::Rotate(Quat(a, Vec3(0.0f, 1.0f, 0.0f))); }
+};
+
+struct AffineStack
+{
+    Affine3x4 stack[8];
+    int count = 1;
+
+    void identity() { count = 1, stack[0] = Affine3x4(); }
+    void push() { stack[count] = stack[count - 1], count++; }
+    void pop() { count--; }
+    const Affine3x4 &top() const { return stack[count - 1]; }
+    void translate(float x, float y, float z) { stack[count - 1].applyTranslate(x, y, z); }
+    void scale(float x, float y, float z) { stack[count - 1].applyScale(x, y, z); }
+    void rotateX(float a) { stack[count - 1].applyRotateX(a); }
+    void rotateY(float a) { stack[count - 1].applyRotateY(a); }
+};
+
+static void Store(const Mat4 &m, float *out)
+{
+    for (int i = 0; i < 16; i++)
+        out[i] = m.m[i];
+}
+
+static void Store(const Affine3x4 &a, float *out)
+{
+    for (int i = 0; i < 12; i++)
+        out[i] = a.m[i];
+}
+
+// Writes the world matrix of each part to out[PARTS][16]
+template <class Stack>
+static void Walk(Stack &stack, float angle, float (*out)[16])
+{
+    int part = 0;
+    stack.identity();
+    stack.translate(1.0f, 2.0f, 3.0f);
+    stack.rotateY(angle);
+
+    stack.push();
+    stack.scale(1.0f, 1.6f, 0.5f);
+    Store(stack.top(), out[part++]);
+    stack.pop();
+
+    stack.push();
+    stack.translate(0.0f, 1.4f, 0.0f);
+    stack.rotateY(angle);
+    stack.scale(0.7f, 0.7f, 0.7f);
+    Store(stack.top(), out[part++]);
+    stack.pop();
+
+    for (int limb = 0; limb < 4; limb++)
+    {
+        stack.push();
+        stack.translate(0.7f, 0.75f, 0.0f);
+        stack.rotateX(angle);
+
+        stack.push();
+        stack.translate(0.0f, -0.3f, 0.0f);
+        stack.scale(0.4f, 0.6f, 0.4f);
+        Store(stack.top(), out[part++]);
+        stack.pop();
+
+        stack.translate(0.0f, -0.6f, 0.0f);
+        stack.rotateX(angle * 0.5f);
+        stack.translate(0.0f, -0.3f, 0.0f);
+        stack.scale(0.3f, 0.6f, 0.3f);
+        Store(stack.top(), out[part++]);
+        stack.pop();
+    }
+}
+
+template <class Stack>
+static double Run(Stack &stack)
+{
+    static float out[PARTS][16];
+    return BenchBest(RUNS, HUMANOIDS, [&]()
+                     {
+                         for (int i = 0; i < HUMANOIDS; i++)
+                             Walk(stack, i * 1e-5f, out);
+                         g_benchSink = g_benchSink + out[PARTS - 1][12]; });
+}
+
+int main()
+{
+    FullMat4Stack full;
+    FixedMatrixStack<8> inPlace;
+    AffineStack affine;
+
+    float reference[PARTS][16], a[PARTS][16], b[PARTS][16];
+    float maxDiff = 0.0f;
+    for (int i = 0; i < 1000; i++)
+    {
+        float angle = i * 0.01f;
+        Walk(full, angle, reference);
+        Walk(inPlace, angle, a);
+        Walk(affine, angle, b);
+        for (int part = 0; part < PARTS; part++)
+            for (int col = 0; col < 4; col++)
+                for (int row = 0; row < 4; row++)
+                {
+                    float expected = reference[part][col * 4 + row];
+                    maxDiff = Max(maxDiff, std::abs(expected - a[part][col * 4 + row]));
+                    if (row < 3)
+                        maxDiff = Max(maxDiff, std::abs(expected - b[part][col * 3 + row]));
+                }
+    }
+
+    double fullNs = Run(full);
+    double inPlaceNs = Run(inPlace);
+    double affineNs = Run(affine);
+    std::printf("Humanoid walk, %d humanoids x %d parts, best of %d (max abs diff %g)\n", HUMANOIDS, PARTS, RUNS, maxDiff);
+    std::printf("  Mat4 full     %7.1f ns/humanoid\n", fullNs);
+    std::printf("  Mat4 in place %7.1f ns/humanoid\n", inPlaceNs);
+    std::printf("  Affine3x4     %7.1f ns/humanoid\n", affineNs);
+    return 0;
+}
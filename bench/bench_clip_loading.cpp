@@ -0,0 +1,137 @@
+#include "Bench.hpp"
+#include "Animation.hpp"
+#include "ClipFile.hpp"
+#include "Device.hpp"
+#include <SDL3/SDL.h>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Startup cost of registering 1,000 clips in the AnimationLibrary:
+//   - text:   LoadTextFile + ParseClipText + AnimationLibrary::add (compiles and compresses);
+//   - mapped: LoadClipFile on the same clips converted once with ConvertClipText.
+// Each run loads its own copy (clip names get a per-run prefix) because the library keeps
+// the first clip registered under a name. The files are freshly written, so both paths
+// read from the page cache. Clips are humanoid: 31 keys at 30 Hz, every joint rotating and
+// the torso moving.
+
+static const int CLIPS = 1000;
+static const int KEYS = 31;
+static const float KEY_RATE = 30.0f;
+static const int RUNS = 5;
+
+static std::string MakeClipText(const std::string &prefix)
+{
+    const Skeleton &rig = Skeleton::Humanoid();
+    std::string text;
+    char line[128];
+    for (int c = 0; c < CLIPS; c++)
+    {
+        std::snprintf(line, sizeof(line), "clip %s%d loop\n", prefix.c_str(), c);
+        text += line;
+        for (int k = 0; k < KEYS; k++)
+        {
+            float time = k / KEY_RATE;
+            std::snprintf(line, sizeof(line), "key %.4f\n", time);
+            text += line;
+            for (int j = 0; j < rig.getJointCount(); j++)
+            {
+                float degrees = 60.0f * std::sin(c * 0.13f + j * 0.71f + time * 6.2831853f);
+                std::snprintf(line, sizeof(line), "rot %s %.3f\n", rig.getName(j).c_str(), degrees);
+                text += line;
+            }
+            std::snprintf(line, sizeof(line), "pos %s 0 %.3f 0\n", rig.getName(0).c_str(), 0.2f * std::sin(time * 12.566371f));
+            text += line;
+        }
+    }
+    return text;
+}
+
+// Sums a few samples of every clip of one run, to check both paths registered the same data
+static double Checksum(const AnimationLibrary &library, const std::string &prefix)
+{
+    double sum = 0.0;
+    Pose pose;
+    ClipCursor cursor;
+    for (int c = 0; c < CLIPS; c++)
+    {
+        const AnimationClip &clip = library.getClip(library.find(prefix + std::to_string(c)));
+        clip.initPose(pose);
+        for (float t = 0.0f; t < clip.getDuration(); t += 0.37f)
+        {
+            clip.sample(t, cursor, pose);
+            for (float v : pose.channels)
+                sum += v;
+        }
+    }
+    return sum;
+}
+
+int main()
+{
+    // AnimationLibrary::add logs every clip; keep the formatting cost but not the output
+    SDL_SetLogPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_WARN);
+
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "humangl_bench_clips";
+    std::filesystem::create_directories(dir);
+
+    // Same clips under different names: run<N>.anim as "text<N>_", run<N>.clips as "mapped<N>_"
+    std::vector<std::string> textPaths, binaryPaths;
+    for (int run = 0; run < RUNS; run++)
+    {
+        std::string base = (dir / ("run" + std::to_string(run))).string();
+        std::string source = base + ".source.anim";
+        textPaths.push_back(base + ".anim");
+        binaryPaths.push_back(base + ".clips");
+        std::ofstream(textPaths.back(), std::ios::binary) << MakeClipText("text" + std::to_string(run) + "_");
+        std::ofstream(source, std::ios::binary) << MakeClipText("mapped" + std::to_string(run) + "_");
+        if (!ConvertClipText(source, binaryPaths.back()))
+        {
+            std::printf("failed to convert %s\n", source.c_str());
+            return 1;
+        }
+    }
+
+    AnimationLibrary &library = AnimationLibrary::Instance();
+    bool ok = true;
+
+    int run = 0;
+    double textNs = BenchBest(RUNS, 1, [&]()
+                              {
+                                  char *text = LoadTextFile(textPaths[run].c_str());
+                                  Skeleton skeleton;
+                                  std::vector<Animation> animations;
+                                  ok = ok && text && ParseClipText(text, skeleton, animations);
+                                  free(text);
+                                  for (const Animation &anim : animations)
+                                      library.add(anim);
+                                  run++; });
+
+    run = 0;
+    double mappedNs = BenchBest(RUNS, 1, [&]()
+                                {
+                                    ok = ok && LoadClipFile(binaryPaths[run], library) == CLIPS;
+                                    run++; });
+
+    double textSum = Checksum(library, "text0_");
+    double mappedSum = Checksum(library, "mapped0_");
+
+    uintmax_t textBytes = std::filesystem::file_size(textPaths[0]);
+    uintmax_t binaryBytes = std::filesystem::file_size(binaryPaths[0]);
+    std::filesystem::remove_all(dir);
+
+    std::printf("Loading %d clips (%d keys, %d joints), best of %d\n", CLIPS, KEYS, Skeleton::Humanoid().getJointCount(), RUNS);
+    std::printf("  text parse + compile  %9.2f ms  (%.1f MB .anim)\n", textNs / 1e6, textBytes / 1048576.0);
+    std::printf("  mapped .clips         %9.2f ms  (%.1f MB .clips)\n", mappedNs / 1e6, binaryBytes / 1048576.0);
+    std::printf("  speedup %.0fx, checksums %s\n", textNs / mappedNs, textSum == mappedSum ? "match" : "DIFFER");
+
+    if (!ok || textSum != mappedSum)
+    {
+        std::printf("FAIL\n");
+        return 1;
+    }
+    return 0;
+}
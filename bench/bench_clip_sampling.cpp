@@ -0,0 +1,122 @@
+#include "Bench.hpp"
+#include "AnimationClip.hpp"
+#include "Animation.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+// AnimationClip::sample() cost per call on clips of 10, 1k and 100k keys:
+//   - forward: playback at 60 fps over keys at 30 Hz (the cursor moves 0 or 1 key per call);
+//   - seek:    random times (findKey falls back to the binary search).
+// Each clip is compiled lossless and with the default ClipCompression (u16 tracks, key
+// reduction). The last case samples many clips round-robin, so the data no longer stays in
+// cache and the smaller compressed clips are read from memory.
+// Humanoid-sized pose (10 joints = 40 channels), 8 animated channels.
+
+static const int JOINTS = 10;
+static const int ANIMATED = 8;
+static const float KEY_RATE = 30.0f;
+static const int SAMPLES = 100000;
+static const int RUNS = 20;
+static const int MANY_CLIPS = 1000;
+static const int MANY_KEYS = 1000;
+
+static Animation MakeAnimation(int keys, float rate = KEY_RATE, float phase = 0.0f)
+{
+    Animation anim("bench", true);
+    for (int k = 0; k < keys; k++)
+    {
+        float time = k / rate;
+        Pose pose(JOINTS);
+        for (int c = 0; c < ANIMATED; c++)
+            pose.channels[c * 5] = std::sin(phase + time * (1.0f + c * 0.37f)) * 0.8f;
+        anim.addKeyframe(pose, time);
+    }
+    return anim;
+}
+
+static double Forward(const AnimationClip &clip)
+{
+    Pose pose;
+    clip.initPose(pose);
+    ClipCursor cursor;
+    return BenchBest(RUNS, SAMPLES, [&]()
+                     {
+                         float time = 0.0f;
+                         for (int i = 0; i < SAMPLES; i++)
+                         {
+                             clip.sample(time, cursor, pose);
+                             time += 1.0f / 60.0f;
+                             if (time >= clip.getDuration())
+                                 time -= clip.getDuration();
+                         }
+                         g_benchSink = g_benchSink + pose.channels[0]; });
+}
+
+static double Seek(const AnimationClip &clip, const std::vector<float> &times)
+{
+    Pose pose;
+    clip.initPose(pose);
+    ClipCursor cursor;
+    return BenchBest(RUNS, SAMPLES, [&]()
+                     {
+                         for (int i = 0; i < SAMPLES; i++)
+                             clip.sample(times[i], cursor, pose);
+                         g_benchSink = g_benchSink + pose.channels[0]; });
+}
+
+// One sample per clip per pass, every clip at its own time
+static double ManyClips(const std::vector<AnimationClip> &clips)
+{
+    Pose pose;
+    clips[0].initPose(pose);
+    std::vector<ClipCursor> cursors(clips.size());
+    int passes = Max(1, SAMPLES / (int)clips.size());
+    float time = 0.0f;
+    return BenchBest(RUNS, passes * (int)clips.size(), [&]()
+                     {
+                         for (int pass = 0; pass < passes; pass++)
+                         {
+                             time += 1.0f / 60.0f;
+                             for (size_t i = 0; i < clips.size(); i++)
+                                 clips[i].sample(std::fmod(time + i * 0.37f, clips[i].getDuration()), cursors[i], pose);
+                         }
+                         g_benchSink = g_benchSink + pose.channels[0]; });
+}
+
+int main()
+{
+    std::printf("AnimationClip::sample, %d channels (%d animated), keys at %.0f Hz, ns per sample\n",
+                JOINTS * 4, ANIMATED, KEY_RATE);
+    std::printf("  %8s %10s %10s %12s %12s %8s\n", "keys", "forward", "seek", "fwd (comp)", "seek (comp)", "ratio");
+
+    const int keyCounts[] = {10, 1000, 100000};
+    std::srand(1);
+    for (int keys : keyCounts)
+    {
+        Animation anim = MakeAnimation(keys);
+        AnimationClip clip(anim);
+        AnimationClip compressed(anim, ClipCompression());
+        std::vector<float> times(SAMPLES);
+        for (float &t : times)
+            t = (float)std::rand() / (float)RAND_MAX * clip.getDuration();
+
+        std::printf("  %8d %10.1f %10.1f %12.1f %12.1f %7.1fx\n", keys, Forward(clip), Seek(clip, times),
+                    Forward(compressed), Seek(compressed, times), compressed.getStats().ratio());
+    }
+
+    std::vector<AnimationClip> lossless, compressed;
+    size_t losslessBytes = 0, compressedBytes = 0;
+    for (int i = 0; i < MANY_CLIPS; i++)
+    {
+        Animation anim = MakeAnimation(MANY_KEYS, 120.0f, i * 0.1f);
+        lossless.emplace_back(anim);
+        compressed.emplace_back(anim, ClipCompression());
+        losslessBytes += lossless.back().getStats().bytes;
+        compressedBytes += compressed.back().getStats().bytes;
+    }
+    std::printf("  %d clips x %d keys at 120 Hz (%.1f MB -> %.1f MB): lossless %.1f, compressed %.1f\n",
+                MANY_CLIPS, MANY_KEYS, losslessBytes / 1048576.0, compressedBytes / 1048576.0,
+                ManyClips(lossless), ManyClips(compressed));
+    return 0;
+}
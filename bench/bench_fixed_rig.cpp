@@ -0,0 +1,73 @@
+#include "Bench.hpp"
+#include "FixedRig.hpp"
+#include "Transform.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+// FixedRig<HumanoidRig>::Evaluate against the generic path (Skeleton::applyPose +
+// TransformHierarchy::update) on the same random poses: pose -> 21 world matrices,
+// every node recomputed. The two results are compared before timing.
+
+static const int POSES = 1024;
+static const int RUNS = 200;
+
+static float Random(float range)
+{
+    return ((float)std::rand() / (float)RAND_MAX * 2.0f - 1.0f) * range;
+}
+
+int main()
+{
+    typedef FixedRig<HumanoidRig> Rig;
+    const Skeleton &skeleton = Skeleton::Humanoid();
+    const Vec3 position(1.0f, 0.0f, -3.0f);
+
+    std::srand(1);
+    std::vector<Pose> poses(POSES, skeleton.createPose());
+    for (Pose &pose : poses)
+    {
+        for (int joint = 0; joint < skeleton.getJointCount(); joint++)
+        {
+            pose.rotation(joint) = Random(Pi);
+            pose.setTranslation(joint, Vec3(Random(0.2f), Random(0.2f), Random(0.2f)));
+        }
+    }
+
+    TransformHierarchy transforms;
+    skeleton.buildHierarchy(transforms);
+    transforms.setTranslation(Skeleton::GetRootNode(), position);
+    Mat4 worlds[Rig::NODE_COUNT];
+
+    float maxDiff = 0.0f;
+    for (const Pose &pose : poses)
+    {
+        skeleton.applyPose(pose, transforms);
+        transforms.update();
+        Rig::Evaluate(position, pose.channels.data(), worlds);
+        for (int node = 0; node < Rig::NODE_COUNT; node++)
+            for (int i = 0; i < 16; i++)
+                maxDiff = Max(maxDiff, std::abs(worlds[node].m[i] - transforms.getWorld(node).m[i]));
+    }
+
+    double hierarchyNs = BenchBest(RUNS, POSES, [&]()
+                                   {
+                                       for (const Pose &pose : poses)
+                                       {
+                                           skeleton.applyPose(pose, transforms);
+                                           transforms.update();
+                                       }
+                                       g_benchSink = g_benchSink + transforms.getWorld(Rig::NODE_COUNT - 1).m[13]; });
+    // One output block per pose, so the compiler cannot drop the matrices of all but the last pose
+    std::vector<Mat4> output((size_t)POSES * Rig::NODE_COUNT);
+    double fixedNs = BenchBest(RUNS, POSES, [&]()
+                               {
+                                   for (int i = 0; i < POSES; i++)
+                                       Rig::Evaluate(position, poses[i].channels.data(), &output[(size_t)i * Rig::NODE_COUNT]);
+                                   g_benchSink = g_benchSink + output.back().m[13]; });
+
+    std::printf("Pose -> %d world matrices, %d random poses, best of %d (max abs diff %g)\n", Rig::NODE_COUNT, POSES, RUNS, maxDiff);
+    std::printf("  applyPose + TransformHierarchy::update %7.1f ns/pose\n", hierarchyNs);
+    std::printf("  FixedRig<HumanoidRig>::Evaluate        %7.1f ns/pose (%.1fx)\n", fixedNs, hierarchyNs / fixedNs);
+    return maxDiff < 1e-4f ? 0 : 1;
+}
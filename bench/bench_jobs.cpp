@@ -0,0 +1,64 @@
+#include "Bench.hpp"
+#include "Animation.hpp"
+#include "Jobs.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// Job system scaling: animate + updateTransforms of a crowd under one ParallelFor (the
+// crowd mode's per-frame work, without LOD or pose cache), for 1..N workers.
+// Usage: bench_jobs [maxWorkers] [humanoids]; maxWorkers defaults to the hardware threads.
+
+static const int FRAMES = 60;
+
+int main(int argc, char **argv)
+{
+    int maxWorkers = (argc > 1) ? std::atoi(argv[1]) : (int)std::thread::hardware_concurrency();
+    int count = (argc > 2) ? std::atoi(argv[2]) : 4000;
+    if (maxWorkers < 1)
+        maxWorkers = 1;
+    if (count < 1)
+        count = 1;
+
+    AnimationLibrary &library = AnimationLibrary::Instance();
+    library.createDefaultAnimations();
+    library.createDanceAnimation();
+    library.createFighterAnimation();
+    ClipId clips[] = {library.find("walk"), library.find("dance"), library.find("fight"), library.find("jump")};
+
+    std::vector<Humanoid *> crowd;
+    crowd.reserve(count);
+    for (int i = 0; i < count; i++)
+    {
+        Humanoid *h = new Humanoid(nullptr);
+        h->playAnimation(clips[i % 4]);
+        h->setAnimationTime(std::fmod(i * 0.37f, 1.0f));
+        crowd.push_back(h);
+    }
+
+    std::printf("%d humanoids, animate + updateTransforms, best of %d frames\n", count, FRAMES);
+    double single = 0.0;
+    for (int workers = 1; workers <= maxWorkers; workers++)
+    {
+        InitJobs(workers);
+        double ns = BenchBest(FRAMES, 1, [&]()
+                              { ParallelFor((int)crowd.size(), [&](int begin, int end)
+                                            {
+                                                for (int i = begin; i < end; i++)
+                                                {
+                                                    crowd[i]->animate(1.0f / 60.0f);
+                                                    crowd[i]->updateTransforms();
+                                                } }, 16); });
+        ShutdownJobs();
+
+        double ms = ns / 1e6;
+        if (workers == 1)
+            single = ms;
+        std::printf("  workers %2d: %7.3f ms  speedup %.2fx\n", workers, ms, single / ms);
+    }
+
+    for (Humanoid *h : crowd)
+        delete h;
+    return 0;
+}
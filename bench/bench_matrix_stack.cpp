@@ -0,0 +1,79 @@
+#include "Bench.hpp"
+#include "Math.hpp"
+#include "Simd.hpp"
+
+// MatrixStack throughput: one humanoid-shaped walk (10 parts: torso, head, two segments
+// per limb) per item, on the heap-backed MatrixStack and on FixedMatrixStack, for every
+// SIMD level this CPU supports.
+
+static const int HUMANOIDS = 200000;
+static const int RUNS = 10;
+
+template <class Stack>
+static float Walk(Stack &stack, float angle)
+{
+    float sink = 0.0f;
+    stack.identity();
+    stack.translate(1.0f, 2.0f, 3.0f);
+    stack.rotateY(angle);
+
+    stack.push();
+    stack.scale(1.0f, 1.6f, 0.5f);
+    sink += stack.top().m[0];
+    stack.pop();
+
+    stack.push();
+    stack.translate(0.0f, 1.4f, 0.0f);
+    stack.rotateY(angle);
+    stack.scale(0.7f, 0.7f, 0.7f);
+    sink += stack.top().m[1];
+    stack.pop();
+
+    for (int limb = 0; limb < 4; limb++)
+    {
+        stack.push();
+        stack.translate(0.7f, 0.75f, 0.0f);
+        stack.rotateX(angle);
+
+        stack.push();
+        stack.translate(0.0f, -0.3f, 0.0f);
+        stack.scale(0.4f, 0.6f, 0.4f);
+        sink += stack.top().m[2];
+        stack.pop();
+
+        stack.translate(0.0f, -0.6f, 0.0f);
+        stack.rotate(angle * 0.5f, Vec3(1.0f, 0.0f, 0.0f));
+        stack.translate(0.0f, -0.3f, 0.0f);
+        stack.scale(0.3f, 0.6f, 0.3f);
+        sink += stack.top().m[3];
+        stack.pop();
+    }
+    return sink;
+}
+
+template <class Stack>
+static double Run(Stack &stack)
+{
+    return BenchBest(RUNS, HUMANOIDS, [&]()
+                     {
+                         float sink = 0.0f;
+                         for (int i = 0; i < HUMANOIDS; i++)
+                             sink += Walk(stack, i * 1e-5f);
+                         g_benchSink = g_benchSink + sink; });
+}
+
+int main()
+{
+    std::printf("Humanoid walk, %d humanoids x 10 parts, best of %d\n", HUMANOIDS, RUNS);
+    for (int level = (int)SimdLevel::SCALAR; level <= (int)GetSupportedSimdLevel(); level++)
+    {
+        SetSimdLevel((SimdLevel)level);
+        MatrixStack heap;
+        FixedMatrixStack<8> fixed;
+        double heapNs = Run(heap);
+        double fixedNs = Run(fixed);
+        std::printf("  %-6s MatrixStack %7.1f ns/humanoid   FixedMatrixStack %7.1f ns/humanoid\n",
+                    GetSimdLevelName((SimdLevel)level), heapNs, fixedNs);
+    }
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "Bench.hpp"
+#include "MathStreams.hpp"
+#include "Simd.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+// CPU skinning kernel (SkinPoints, as used by CpuSkinnedBatch::skin) for 100 / 1k / 10k
+// characters, scalar against every supported SIMD level, on two meshes of the humanoid's size:
+//   - rigid:  10 joints x 8 cube corners, one influence per vertex (the rig's cubes);
+//   - smooth: the same vertices with 4 influences on neighbouring joints.
+// Every character gets its own palette. Results are checked against scalar before timing.
+// The GPU path needs a GL context and is measured in the app (--crowd N with/without --cpuskin).
+
+static const int JOINTS = 10;
+static const int VERTICES = JOINTS * 8;
+static const int INFLUENCES = 4;
+static const int VERTEX_FLOATS = 7; // same interleaved layout as CpuSkinnedBatch (position + color)
+static const int RUNS = 10;
+
+static float Random()
+{
+    return (float)std::rand() / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+struct SkinInput
+{
+    Vec3Stream points;
+    std::vector<int32_t> joints;
+    std::vector<float> weights;
+    int influences;
+};
+
+static SkinInput MakeMesh(bool smooth)
+{
+    SkinInput mesh;
+    mesh.influences = smooth ? INFLUENCES : 1;
+    mesh.joints.assign(INFLUENCES * VERTICES, 0);
+    mesh.weights.assign(INFLUENCES * VERTICES, 0.0f);
+    for (int i = 0; i < VERTICES; i++)
+    {
+        int joint = i / 8;
+        mesh.points.push(Vec3(Random(), Random() + joint, Random()));
+        for (int k = 0; k < mesh.influences; k++)
+        {
+            mesh.joints[k * VERTICES + i] = (joint + k) % JOINTS;
+            mesh.weights[k * VERTICES + i] = smooth ? (k == 0 ? 0.55f : 0.15f) : 1.0f;
+        }
+    }
+    return mesh;
+}
+
+static void Skin(const SkinInput &mesh, const std::vector<float> &palettes, int characters, std::vector<float> &out)
+{
+    for (int c = 0; c < characters; c++)
+        SkinPoints(&palettes[(size_t)c * JOINTS * 12], mesh.points, mesh.joints.data(), mesh.weights.data(),
+                   mesh.influences, &out[(size_t)c * VERTICES * VERTEX_FLOATS], VERTEX_FLOATS);
+}
+
+int main()
+{
+    std::srand(1);
+    const int characterCounts[] = {100, 1000, 10000};
+    const int maxCharacters = 10000;
+
+    std::vector<float> palettes((size_t)maxCharacters * JOINTS * 12);
+    for (float &v : palettes)
+        v = Random();
+    std::vector<float> expected((size_t)maxCharacters * VERTICES * VERTEX_FLOATS);
+    std::vector<float> actual(expected.size());
+
+    SimdLevel supported = GetSupportedSimdLevel();
+    std::printf("SkinPoints, %d vertices per character, ms per frame (best of %d)\n", VERTICES, RUNS);
+    for (int smooth = 0; smooth < 2; smooth++)
+    {
+        SkinInput mesh = MakeMesh(smooth != 0);
+        std::printf("  %s mesh, %d influence(s)\n", smooth ? "smooth" : "rigid", mesh.influences);
+        for (int characters : characterCounts)
+        {
+            std::printf("    %6d characters:", characters);
+            for (int level = (int)SimdLevel::SCALAR; level <= (int)supported; level++)
+            {
+                SetSimdLevel((SimdLevel)level);
+                std::vector<float> &out = (level == (int)SimdLevel::SCALAR) ? expected : actual;
+                double ns = BenchBest(RUNS, 1, [&]()
+                                      { Skin(mesh, palettes, characters, out);
+                                        g_benchSink = g_benchSink + out[0]; });
+
+                float maxDiff = 0.0f;
+                if (level != (int)SimdLevel::SCALAR)
+                    for (size_t i = 0; i < (size_t)characters * VERTICES * VERTEX_FLOATS; i++)
+                        maxDiff = Max(maxDiff, std::abs(expected[i] - actual[i]));
+                std::printf("  %s %.3f ms", GetSimdLevelName((SimdLevel)level), ns / 1e6);
+                if (level != (int)SimdLevel::SCALAR)
+                    std::printf(" (diff %g)", maxDiff);
+            }
+            std::printf("\n");
+        }
+    }
+    return 0;
+}
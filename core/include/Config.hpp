@@ -45,7 +45,8 @@ typedef long long s64;
 typedef float f32;
 typedef double f64;
 
-#define GLSL(src) "#version 460 core\n" #src
+#define GLSL_VERSION "#version 460 core\n"
+#define GLSL(src) GLSL_VERSION #src
 
 
 
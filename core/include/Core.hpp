@@ -5,6 +5,10 @@
 #include "Driver.hpp"
 #include "Input.hpp"
 #include "Math.hpp"
+#include "Simd.hpp"
+#include "MathStreams.hpp"
+#include "Jobs.hpp"
+#include "Transform.hpp"
 #include "File.hpp"
 #include "Color.hpp"
 #include "Pixmap.hpp"
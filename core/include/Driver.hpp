@@ -22,6 +22,22 @@ enum class CullMode
 
 
 
+class ShaderBuffer;
+
+// CPU copy of the Frame uniform block (FRAME_UNIFORMS_GLSL), in std140 layout
+struct FrameUniforms
+{
+    Mat4 view;
+    Mat4 projection;
+    Mat4 viewProj;          // projection * view
+    float cameraPosition[4]; // xyz, w = 1
+    float viewport[4];       // x, y, width, height in pixels
+    float time;              // seconds
+    float padding[3];
+};
+static_assert(sizeof(FrameUniforms) == 240, "FrameUniforms must match the std140 Frame block");
+
+
 enum class BlendMode
 {
     
@@ -71,6 +87,11 @@ class    Driver
  
      void Clear();
 
+     // Fills and uploads the Frame block (viewport from the last SetViewport) and binds it at
+     // FRAME_UNIFORM_BINDING; once per pass, every program that declares the block sees it
+     void SetFrameUniforms(const Mat4 &view, const Mat4 &projection, const Vec3 &cameraPosition, float time);
+     const FrameUniforms &GetFrameUniforms() const { return m_frame; }
+
      void ResetStats();
      
      void FlipImageOnLoad(bool flip);
@@ -111,6 +132,8 @@ class    Driver
      int m_height;
 
      Shader *m_currentShader;
+     ShaderBuffer *m_frameBuffer;
+     FrameUniforms m_frame;
      Texture2D *m_currentTexture[8];
      u32 currentShader;
      u32 currentTexture[8];
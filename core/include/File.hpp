@@ -131,4 +131,31 @@ public:
         u64 m_size;
 
  
-};
\ No newline at end of file
+};
+
+
+// Read-only view of a whole file. Uses the OS page cache (mmap / file mapping) where available,
+// so the data is paged in on first touch and never copied; elsewhere the file is read into memory.
+class     MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool Open(const std::string& filePath);
+    void Close();
+
+    const unsigned char* GetData() const { return m_data; }
+    u64 Size() const { return m_size; }
+    bool IsOpen() const { return m_data != nullptr; }
+    bool IsMapped() const { return m_mapped; }
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* m_data;
+    u64 m_size;
+    bool m_mapped;
+    void* m_handle;
+};
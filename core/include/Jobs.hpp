@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+
+// Work-stealing job system.
+// One worker per core: the thread that calls InitJobs() is worker 0 and the others are
+// background threads. Each worker owns a lock-free deque; it pushes and pops at the bottom
+// while idle workers steal from the top. Jobs are plain function pointers plus a range, so
+// submitting one never allocates.
+//
+// Dependencies are expressed with counters: every job run against a counter increments it
+// and decrements it when done. WaitJobs() keeps executing other jobs until the counter
+// reaches zero, so waiting from inside a job is fine.
+
+typedef void (*JobFunction)(void *data, int begin, int end);
+
+struct JobCounter
+{
+    std::atomic<int> pending{0};
+
+    bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+};
+
+// workerCount <= 0 uses one worker per hardware thread; 1 means everything runs inline
+void InitJobs(int workerCount = 0);
+void ShutdownJobs();
+int GetJobWorkerCount();   // 1 if the job system was not initialized
+int GetJobWorkerIndex();   // 0 on the main thread, -1 on threads the job system does not own
+
+// Queues function(data, begin, end) on the calling worker; runs it inline if the queue is full
+// or the caller is not a worker
+void RunJob(JobFunction function, void *data, int begin, int end, JobCounter *counter);
+void WaitJobs(JobCounter &counter);
+
+// Splits [0, count) into chunks of at least minGrain items, a few per worker so that
+// stealing can even out uneven chunks, and calls body(begin, end) on each.
+// minGrain <= 0 derives the grain from count / (workers * CHUNKS_PER_WORKER).
+// Returns once every chunk has run. Small ranges, or a single worker, run inline.
+template <typename Body>
+void ParallelFor(int count, const Body &body, int minGrain = 0)
+{
+    if (count <= 0)
+        return;
+
+    const int CHUNKS_PER_WORKER = 4;
+    int workers = GetJobWorkerCount();
+    int grain = minGrain > 0 ? minGrain : count / (workers * CHUNKS_PER_WORKER);
+    if (grain < 1)
+        grain = 1;
+    int chunks = count / grain;
+    if (chunks > workers * CHUNKS_PER_WORKER)
+        chunks = workers * CHUNKS_PER_WORKER;
+
+    if (workers <= 1 || chunks <= 1 || GetJobWorkerIndex() < 0)
+    {
+        body(0, count);
+        return;
+    }
+
+    JobFunction function = [](void *data, int begin, int end)
+    { (*static_cast<const Body *>(data))(begin, end); };
+
+    JobCounter counter;
+    void *data = const_cast<Body *>(&body);
+    int step = count / chunks;
+    int remainder = count % chunks;
+    int begin = 0;
+    for (int i = 0; i < chunks; i++)
+    {
+        int end = begin + step + (i < remainder ? 1 : 0);
+        RunJob(function, data, begin, end, &counter);
+        begin = end;
+    }
+    WaitJobs(counter);
+}
@@ -1,37 +1,47 @@
 
 #pragma once
+#include <cassert>
 #include <cmath>
 #include <vector>
+#include "Simd.hpp"
+
+// True while the compiler folds a constexpr call. The dispatched kernels are not constexpr,
+// so Quat/Vec3 fall back to their inline scalar code there and go through the table at run time.
+#if defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define MATH_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#else
+#define MATH_CONSTANT_EVALUATED() true
+#endif
 
 const unsigned int MaxUInt32 = 0xFFFFFFFF;
 const int MinInt32 = 0x80000000;
 const int MaxInt32 = 0x7FFFFFFF;
-const float Maxloat = 3.402823466e+38F;
-const float MinPosFloat = 1.175494351e-38F;
-const float MATH_FLOAT_SMALL = 1.0e-37f;
-const float MATH_TOLERANCE = 2e-37f;
-const float Pi = 3.141592654f;
-const float TwoPi = 6.283185307f;
-const float PiHalf = 1.570796327f;
+constexpr float Maxloat = 3.402823466e+38F;
+constexpr float MinPosFloat = 1.175494351e-38F;
+constexpr float MATH_FLOAT_SMALL = 1.0e-37f;
+constexpr float MATH_TOLERANCE = 2e-37f;
+constexpr float Pi = 3.141592654f;
+constexpr float TwoPi = 6.283185307f;
+constexpr float PiHalf = 1.570796327f;
 
-const float dtor = 0.0174532925199432957692369076848861f;
-const float rtod = 1 / dtor;
+constexpr float dtor = 0.0174532925199432957692369076848861f;
+constexpr float rtod = 1 / dtor;
 
-const float Epsilon = 0.000001f;
-const float ZeroEpsilon = 32.0f * MinPosFloat; // Very small epsilon for checking against 0.0f
+constexpr float Epsilon = 0.000001f;
+constexpr float ZeroEpsilon = 32.0f * MinPosFloat; // Very small epsilon for checking against 0.0f
 
-const float M_INFINITY = 1.0e30f;
+constexpr float M_INFINITY = 1.0e30f;
 
 template <typename T>
-T Min(const T &a, const T &b) { return (a < b) ? a : b; }
+constexpr T Min(const T &a, const T &b) { return (a < b) ? a : b; }
 
 template <typename T>
-T Max(const T &a, const T &b) { return (a > b) ? a : b; }
+constexpr T Max(const T &a, const T &b) { return (a > b) ? a : b; }
 
 #define powi(base, exp) (int)powf((float)(base), (float)(exp))
 
-#define ToRadians(x) (float)(((x) * Pi / 180.0f))
-#define ToDegrees(x) (float)(((x) * 180.0f / Pi))
+constexpr float ToRadians(float x) { return x * Pi / 180.0f; }
+constexpr float ToDegrees(float x) { return x * 180.0f / Pi; }
 
 inline float Sin(float a) { return sin(a * Pi / 180); }
 inline float Cos(float a) { return cos(a * Pi / 180); }
@@ -47,6 +57,15 @@ inline float ASinRad(float a) { return asin(a); }
 inline float ACosRad(float a) { return acos(a); }
 inline float ATanRad(float a) { return atan(a); }
 inline float ATan2Rad(float y, float x) { return atan2(y, x); }
+inline void SinCos(float a, float &s, float &c)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	__builtin_sincosf(a, &s, &c);
+#else
+	s = std::sin(a);
+	c = std::cos(a);
+#endif
+}
 inline int Floor(float a) { return (int)(floor(a)); }
 inline int Ceil(float a) { return (int)(ceil(a)); }
 inline int Trunc(float a)
@@ -70,13 +89,13 @@ inline float Sqrt(float a)
 	else
 		return 0;
 }
-inline float Abs(float a)
+constexpr float Abs(float a)
 {
 	if (a < 0)
 		a = -a;
 	return a;
 }
-inline int Mod(int a, int b)
+constexpr int Mod(int a, int b)
 {
 	if (b == 0)
 		return 0;
@@ -89,7 +108,7 @@ inline float FMod(float a, float b)
 	return fmod(a, b);
 }
 inline float Pow(float a, float b) { return pow(a, b); }
-inline int Sign(float a)
+constexpr int Sign(float a)
 {
 	if (a < 0)
 		return -1;
@@ -98,9 +117,9 @@ inline int Sign(float a)
 	else
 		return 0;
 }
-inline float Min(float a, float b) { return a < b ? a : b; }
-inline float Max(float a, float b) { return a > b ? a : b; }
-inline float Clamp(float a, float min, float max)
+constexpr float Min(float a, float b) { return a < b ? a : b; }
+constexpr float Max(float a, float b) { return a > b ? a : b; }
+constexpr float Clamp(float a, float min, float max)
 {
 	if (a < min)
 		a = min;
@@ -108,7 +127,7 @@ inline float Clamp(float a, float min, float max)
 		a = max;
 	return a;
 }
-inline int Clamp(int a, int min, int max)
+constexpr int Clamp(int a, int min, int max)
 {
 	if (a < min)
 		a = min;
@@ -137,22 +156,30 @@ struct Vec2
 
 	float x, y;
 
-	Vec2();
-	Vec2(float x, float y);
+	constexpr Vec2() : x(0.0f), y(0.0f) {}
+	constexpr Vec2(float x, float y) : x(x), y(y) {}
 
 	// Getters/Setters
-	float getX() const;
-	float getY() const;
-	void setX(float x);
-	void setY(float y);
+	constexpr float getX() const { return x; }
+	constexpr float getY() const { return y; }
+	constexpr void setX(float newX) { x = newX; }
+	constexpr void setY(float newY) { y = newY; }
 
 	// Operations
-	Vec2 operator+(const Vec2 &other) const;
-	Vec2 operator-(const Vec2 &other) const;
-	Vec2 operator*(float scalar) const;
-	float dot(const Vec2 &other) const;
-	float length() const;
-	Vec2 normalize() const;
+	constexpr Vec2 operator+(const Vec2 &other) const { return Vec2(x + other.x, y + other.y); }
+	constexpr Vec2 operator-(const Vec2 &other) const { return Vec2(x - other.x, y - other.y); }
+	constexpr Vec2 operator*(float scalar) const { return Vec2(x * scalar, y * scalar); }
+	constexpr float dot(const Vec2 &other) const { return x * other.x + y * other.y; }
+	float length() const { return std::sqrt(x * x + y * y); }
+	Vec2 normalize() const
+	{
+		float len = length();
+		if (len > 0)
+		{
+			return Vec2(x / len, y / len);
+		}
+		return *this;
+	}
 };
 
 struct Vec3
@@ -162,32 +189,49 @@ struct Vec3
 
 	float x, y, z;
 
-	Vec3();
-	Vec3(float x, float y, float z);
+	constexpr Vec3() : x(0.0f), y(0.0f), z(0.0f) {}
+	constexpr Vec3(float x, float y, float z) : x(x), y(y), z(z) {}
 
 	// Getters/Setters
-	float getX() const;
-	float getY() const;
-	float getZ() const;
-	void setX(float x);
-	void setY(float y);
-	void setZ(float z);
+	constexpr float getX() const { return x; }
+	constexpr float getY() const { return y; }
+	constexpr float getZ() const { return z; }
+	constexpr void setX(float newX) { x = newX; }
+	constexpr void setY(float newY) { y = newY; }
+	constexpr void setZ(float newZ) { z = newZ; }
 
 	// Operations
-	Vec3 operator+(const Vec3 &other) const;
-	Vec3 operator-(const Vec3 &other) const;
-	Vec3 operator*(float scalar) const;
-	float dot(const Vec3 &other) const;
-	Vec3 cross(const Vec3 &other) const;
-	float length() const;
-	Vec3 normalize() const;
-
-	Vec3 operator-() const
+	constexpr Vec3 operator+(const Vec3 &other) const { return Vec3(x + other.x, y + other.y, z + other.z); }
+	constexpr Vec3 operator-(const Vec3 &other) const { return Vec3(x - other.x, y - other.y, z - other.z); }
+	constexpr Vec3 operator*(float scalar) const { return Vec3(x * scalar, y * scalar, z * scalar); }
+	constexpr float dot(const Vec3 &other) const { return x * other.x + y * other.y + z * other.z; }
+	constexpr Vec3 cross(const Vec3 &other) const
+	{
+		if (!MATH_CONSTANT_EVALUATED())
+		{
+			Vec3 result;
+			GetMathKernels().vec3Cross(&x, &other.x, &result.x);
+			return result;
+		}
+		return Vec3(
+			y * other.z - z * other.y,
+			z * other.x - x * other.z,
+			x * other.y - y * other.x);
+	}
+	float length() const { return std::sqrt(x * x + y * y + z * z); }
+	Vec3 normalize() const
+	{
+		Vec3 result;
+		GetMathKernels().vec3Normalize(&x, &result.x);
+		return result;
+	}
+
+	constexpr Vec3 operator-() const
 	{ // negação
 		return Vec3(-x, -y, -z);
 	}
 
-	Vec3 &operator+=(const Vec3 &other)
+	constexpr Vec3 &operator+=(const Vec3 &other)
 	{
 		x += other.x;
 		y += other.y;
@@ -195,7 +239,7 @@ struct Vec3
 		return *this;
 	}
 
-	Vec3 &operator-=(const Vec3 &other)
+	constexpr Vec3 &operator-=(const Vec3 &other)
 	{
 		x -= other.x;
 		y -= other.y;
@@ -203,7 +247,7 @@ struct Vec3
 		return *this;
 	}
 
-	Vec3 &operator*=(float scalar)
+	constexpr Vec3 &operator*=(float scalar)
 	{
 		x *= scalar;
 		y *= scalar;
@@ -211,11 +255,11 @@ struct Vec3
 		return *this;
 	}
 
-	bool operator==(const Vec3 &other) const
+	constexpr bool operator==(const Vec3 &other) const
 	{
-		return std::abs(x - other.x) < EPSILON &&
-			   std::abs(y - other.y) < EPSILON &&
-			   std::abs(z - other.z) < EPSILON;
+		return Abs(x - other.x) < EPSILON &&
+			   Abs(y - other.y) < EPSILON &&
+			   Abs(z - other.z) < EPSILON;
 	}
 };
 
@@ -224,48 +268,431 @@ struct Quat
 
 	float w, x, y, z;
 
-	Quat();
-	Quat(float w, float x, float y, float z);
-	Quat(float angle, const Vec3 &axis); // Rotation constructor
+	constexpr Quat() : w(1.0f), x(0.0f), y(0.0f), z(0.0f) {}
+	constexpr Quat(float w, float x, float y, float z) : w(w), x(x), y(y), z(z) {}
+	Quat(float angle, const Vec3 &axis) // Rotation constructor
+	{
+		float halfAngle = angle * 0.5f;
+		float sinHalfAngle = std::sin(halfAngle);
+		Vec3 normalizedAxis = axis.normalize();
+
+		w = std::cos(halfAngle);
+		x = normalizedAxis.x * sinHalfAngle;
+		y = normalizedAxis.y * sinHalfAngle;
+		z = normalizedAxis.z * sinHalfAngle;
+	}
 
 	// Getters/Setters
-	float getW() const;
-	float getX() const;
-	float getY() const;
-	float getZ() const;
+	constexpr float getW() const { return w; }
+	constexpr float getX() const { return x; }
+	constexpr float getY() const { return y; }
+	constexpr float getZ() const { return z; }
 
 	// Operations
-	Quat operator*(const Quat &other) const;
-	Quat conjugate() const;
-	Quat normalize() const;
-	float length() const;
-	Vec3 rotate(const Vec3 &v) const;
+	constexpr Quat operator*(const Quat &other) const
+	{
+		if (!MATH_CONSTANT_EVALUATED())
+		{
+			Quat result;
+			GetMathKernels().quatMultiply(&w, &other.w, &result.w);
+			return result;
+		}
+		return Quat(
+			w * other.w - x * other.x - y * other.y - z * other.z,
+			w * other.x + x * other.w + y * other.z - z * other.y,
+			w * other.y - x * other.z + y * other.w + z * other.x,
+			w * other.z + x * other.y - y * other.x + z * other.w);
+	}
+	constexpr Quat conjugate() const { return Quat(w, -x, -y, -z); }
+	Quat normalize() const
+	{
+		float len = length();
+		if (len > 0)
+		{
+			float invLen = 1.0f / len;
+			return Quat(w * invLen, x * invLen, y * invLen, z * invLen);
+		}
+		return *this;
+	}
+	float length() const { return std::sqrt(w * w + x * x + y * y + z * z); }
+	constexpr Vec3 rotate(const Vec3 &v) const // expects a unit quaternion
+	{
+		if (!MATH_CONSTANT_EVALUATED())
+		{
+			Vec3 result;
+			GetMathKernels().quatRotate(&w, &v.x, &result.x);
+			return result;
+		}
+		// v + w * t + u x t, with t = 2 * (u x v)
+		Vec3 u(x, y, z);
+		Vec3 t = u.cross(v) * 2.0f;
+		return v + t * w + u.cross(t);
+	}
 };
 
 struct Mat4
 {
 	float m[16]; // Column-major order
 
-	Mat4(); // Identity matrix
-	Mat4(const float *values);
+	constexpr Mat4() : m{1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f} {} // Identity matrix
+	constexpr Mat4(const float *values) : m{}
+	{
+		for (int i = 0; i < 16; i++)
+			m[i] = values[i];
+	}
 
 	// Access
-	float &at(int row, int col);
-	float at(int row, int col) const;
-	const float *data() const;
+	constexpr float &at(int row, int col) { return m[col * 4 + row]; }
+	constexpr float at(int row, int col) const { return m[col * 4 + row]; }
+	constexpr const float *data() const { return m; }
 
-	// Basic operations
-	Mat4 operator*(const Mat4 &other) const;
-	Vec3 transform(const Vec3 &v) const;
+	// Basic operations (runtime-dispatched, see Simd.hpp)
+	Mat4 operator*(const Mat4 &other) const
+	{
+		Mat4 result;
+		GetMathKernels().mat4Multiply(m, other.m, result.m);
+		return result;
+	}
+	Vec3 transform(const Vec3 &v) const
+	{
+		Vec3 result;
+		GetMathKernels().mat4Transform(m, &v.x, &result.x);
+		return result;
+	}
 
 	// Create transformation matrices
-	static Mat4 Identity();
-	static Mat4 Translate(const Vec3 &v);
-	static Mat4 Rotate(const Quat &q);
-	static Mat4 Scale(const Vec3 &v);
+	static constexpr Mat4 Identity() { return Mat4(); }
+	static constexpr Mat4 Translate(const Vec3 &v)
+	{
+		Mat4 result;
+		result.m[12] = v.x;
+		result.m[13] = v.y;
+		result.m[14] = v.z;
+		return result;
+	}
+	static constexpr Mat4 Rotate(const Quat &q);
+	static constexpr Mat4 Scale(const Vec3 &v)
+	{
+		Mat4 result;
+		result.m[0] = v.x;
+		result.m[5] = v.y;
+		result.m[10] = v.z;
+		return result;
+	}
 	static Mat4 Perspective(float fov, float aspect, float near, float far);
 	static Mat4 LookAt(const Vec3 &eye, const Vec3 &center, const Vec3 &up);
-	static Mat4 Ortho(float left, float right, float bottom, float top, float near, float far);
+	static constexpr Mat4 Ortho(float left, float right, float bottom, float top, float near, float far);
+
+	// In-place post-multiplication (this = this * T) that only touches the columns T changes
+	void applyTranslate(float x, float y, float z);
+	void applyRotateX(float angle);
+	void applyRotateY(float angle);
+	void applyRotateZ(float angle);
+	void applyScale(float x, float y, float z);
+
+	// Inverse of an affine matrix (last row 0 0 0 1), e.g. a bind-pose joint matrix
+	Mat4 inverseAffine() const;
+};
+
+constexpr Mat4 Mat4::Rotate(const Quat &q)
+{
+	Mat4 result;
+	float xx = q.x * q.x;
+	float xy = q.x * q.y;
+	float xz = q.x * q.z;
+	float xw = q.x * q.w;
+	float yy = q.y * q.y;
+	float yz = q.y * q.z;
+	float yw = q.y * q.w;
+	float zz = q.z * q.z;
+	float zw = q.z * q.w;
+
+	result.at(0, 0) = 1 - 2 * (yy + zz);
+	result.at(0, 1) = 2 * (xy - zw);
+	result.at(0, 2) = 2 * (xz + yw);
+	result.at(1, 0) = 2 * (xy + zw);
+	result.at(1, 1) = 1 - 2 * (xx + zz);
+	result.at(1, 2) = 2 * (yz - xw);
+	result.at(2, 0) = 2 * (xz - yw);
+	result.at(2, 1) = 2 * (yz + xw);
+	result.at(2, 2) = 1 - 2 * (xx + yy);
+
+	return result;
+}
+
+inline Mat4 Mat4::Perspective(float fovRadians, float aspect, float near, float far)
+{
+	Mat4 result;
+	float tanHalfFov = std::tan(fovRadians / 2.0f);
+
+	result.at(0, 0) = 1.0f / (aspect * tanHalfFov);
+	result.at(1, 1) = 1.0f / tanHalfFov;
+	result.at(2, 2) = -(far + near) / (far - near);
+	result.at(2, 3) = -(2.0f * far * near) / (far - near);
+	result.at(3, 2) = -1.0f;
+	result.at(3, 3) = 0.0f;
+
+	return result;
+}
+
+inline Mat4 Mat4::LookAt(const Vec3 &eye, const Vec3 &center, const Vec3 &up)
+{
+	Vec3 f = (center - eye).normalize();
+	Vec3 s = f.cross(up).normalize();
+	Vec3 u = s.cross(f);
+
+	Mat4 result;
+	result.at(0, 0) = s.x;
+	result.at(0, 1) = s.y;
+	result.at(0, 2) = s.z;
+	result.at(0, 3) = -s.dot(eye);
+
+	result.at(1, 0) = u.x;
+	result.at(1, 1) = u.y;
+	result.at(1, 2) = u.z;
+	result.at(1, 3) = -u.dot(eye);
+
+	result.at(2, 0) = -f.x;
+	result.at(2, 1) = -f.y;
+	result.at(2, 2) = -f.z;
+	result.at(2, 3) = f.dot(eye);
+
+	result.at(3, 0) = 0.0f;
+	result.at(3, 1) = 0.0f;
+	result.at(3, 2) = 0.0f;
+	result.at(3, 3) = 1.0f;
+
+	return result;
+}
+
+constexpr Mat4 Mat4::Ortho(float left, float right, float bottom, float top, float near, float far)
+{
+	Mat4 mat;
+	mat.m[0] = 2.0f / (right - left);
+	mat.m[5] = 2.0f / (top - bottom);
+	mat.m[10] = -2.0f / (far - near);
+	mat.m[12] = -(right + left) / (right - left);
+	mat.m[13] = -(top + bottom) / (top - bottom);
+	mat.m[14] = -(far + near) / (far - near);
+	mat.m[15] = 1.0f;
+	return mat;
+}
+
+inline void Mat4::applyTranslate(float x, float y, float z)
+{
+	for (int i = 0; i < 4; i++)
+		m[12 + i] += m[i] * x + m[4 + i] * y + m[8 + i] * z;
+}
+
+inline void Mat4::applyRotateX(float angle)
+{
+	float s, c;
+	SinCos(angle, s, c);
+	for (int i = 0; i < 4; i++)
+	{
+		float c1 = m[4 + i];
+		float c2 = m[8 + i];
+		m[4 + i] = c1 * c + c2 * s;
+		m[8 + i] = c2 * c - c1 * s;
+	}
+}
+
+inline void Mat4::applyRotateY(float angle)
+{
+	float s, c;
+	SinCos(angle, s, c);
+	for (int i = 0; i < 4; i++)
+	{
+		float c0 = m[i];
+		float c2 = m[8 + i];
+		m[i] = c0 * c - c2 * s;
+		m[8 + i] = c0 * s + c2 * c;
+	}
+}
+
+inline void Mat4::applyRotateZ(float angle)
+{
+	float s, c;
+	SinCos(angle, s, c);
+	for (int i = 0; i < 4; i++)
+	{
+		float c0 = m[i];
+		float c1 = m[4 + i];
+		m[i] = c0 * c + c1 * s;
+		m[4 + i] = c1 * c - c0 * s;
+	}
+}
+
+inline void Mat4::applyScale(float x, float y, float z)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		m[i] *= x;
+		m[4 + i] *= y;
+		m[8 + i] *= z;
+	}
+}
+
+inline Mat4 Mat4::inverseAffine() const
+{
+	// Inverse of the 3x3 part by cofactors, then t' = -inv(A) * t
+	float a00 = at(0, 0), a01 = at(0, 1), a02 = at(0, 2);
+	float a10 = at(1, 0), a11 = at(1, 1), a12 = at(1, 2);
+	float a20 = at(2, 0), a21 = at(2, 1), a22 = at(2, 2);
+	float c00 = a11 * a22 - a12 * a21;
+	float c01 = a12 * a20 - a10 * a22;
+	float c02 = a10 * a21 - a11 * a20;
+	float det = a00 * c00 + a01 * c01 + a02 * c02;
+	float inv = (det != 0.0f) ? 1.0f / det : 0.0f;
+
+	Mat4 r;
+	r.at(0, 0) = c00 * inv;
+	r.at(0, 1) = (a02 * a21 - a01 * a22) * inv;
+	r.at(0, 2) = (a01 * a12 - a02 * a11) * inv;
+	r.at(1, 0) = c01 * inv;
+	r.at(1, 1) = (a00 * a22 - a02 * a20) * inv;
+	r.at(1, 2) = (a02 * a10 - a00 * a12) * inv;
+	r.at(2, 0) = c02 * inv;
+	r.at(2, 1) = (a01 * a20 - a00 * a21) * inv;
+	r.at(2, 2) = (a00 * a11 - a01 * a10) * inv;
+
+	float tx = at(0, 3), ty = at(1, 3), tz = at(2, 3);
+	for (int row = 0; row < 3; row++)
+		r.at(row, 3) = -(r.at(row, 0) * tx + r.at(row, 1) * ty + r.at(row, 2) * tz);
+	return r;
+}
+
+// Affine transform stored as a 3x4 matrix (the implicit last row is 0 0 0 1).
+// Column-major like Mat4: m[col * 3 + row], column 3 is the translation.
+// Input type of the MathStreams transform kernels. MatrixStack keeps Mat4, whose 4-float
+// columns make the in-place apply* ops faster (see bench/bench_affine.cpp).
+struct Affine3x4
+{
+	float m[12];
+
+	constexpr Affine3x4() : m{1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f} {} // Identity
+	constexpr explicit Affine3x4(const Mat4 &mat) : m{}
+	{
+		for (int col = 0; col < 4; col++)
+			for (int row = 0; row < 3; row++)
+				m[col * 3 + row] = mat.m[col * 4 + row];
+	}
+
+	constexpr float &at(int row, int col) { return m[col * 3 + row]; }
+	constexpr float at(int row, int col) const { return m[col * 3 + row]; }
+
+	constexpr Mat4 toMat4() const
+	{
+		Mat4 result;
+		for (int col = 0; col < 4; col++)
+			for (int row = 0; row < 3; row++)
+				result.m[col * 4 + row] = m[col * 3 + row];
+		return result;
+	}
+
+	constexpr Affine3x4 operator*(const Affine3x4 &other) const
+	{
+		Affine3x4 result;
+		for (int col = 0; col < 4; col++)
+		{
+			const float *b = other.m + col * 3;
+			for (int row = 0; row < 3; row++)
+			{
+				result.m[col * 3 + row] = m[row] * b[0] + m[3 + row] * b[1] + m[6 + row] * b[2] + (col == 3 ? m[9 + row] : 0.0f);
+			}
+		}
+		return result;
+	}
+
+	constexpr Vec3 transformPoint(const Vec3 &v) const
+	{
+		return Vec3(m[0] * v.x + m[3] * v.y + m[6] * v.z + m[9],
+					m[1] * v.x + m[4] * v.y + m[7] * v.z + m[10],
+					m[2] * v.x + m[5] * v.y + m[8] * v.z + m[11]);
+	}
+
+	constexpr Vec3 transformVector(const Vec3 &v) const
+	{
+		return Vec3(m[0] * v.x + m[3] * v.y + m[6] * v.z,
+					m[1] * v.x + m[4] * v.y + m[7] * v.z,
+					m[2] * v.x + m[5] * v.y + m[8] * v.z);
+	}
+
+	static constexpr Affine3x4 Translate(const Vec3 &v)
+	{
+		Affine3x4 result;
+		result.m[9] = v.x;
+		result.m[10] = v.y;
+		result.m[11] = v.z;
+		return result;
+	}
+
+	static constexpr Affine3x4 Scale(const Vec3 &v)
+	{
+		Affine3x4 result;
+		result.m[0] = v.x;
+		result.m[4] = v.y;
+		result.m[8] = v.z;
+		return result;
+	}
+
+	static constexpr Affine3x4 Rotate(const Quat &q) { return Affine3x4(Mat4::Rotate(q)); }
+
+	// In-place post-multiplication, same semantics as the Mat4 versions
+	void applyTranslate(float x, float y, float z)
+	{
+		for (int i = 0; i < 3; i++)
+			m[9 + i] += m[i] * x + m[3 + i] * y + m[6 + i] * z;
+	}
+
+	void applyRotateX(float angle)
+	{
+		float s, c;
+		SinCos(angle, s, c);
+		for (int i = 0; i < 3; i++)
+		{
+			float c1 = m[3 + i];
+			float c2 = m[6 + i];
+			m[3 + i] = c1 * c + c2 * s;
+			m[6 + i] = c2 * c - c1 * s;
+		}
+	}
+
+	void applyRotateY(float angle)
+	{
+		float s, c;
+		SinCos(angle, s, c);
+		for (int i = 0; i < 3; i++)
+		{
+			float c0 = m[i];
+			float c2 = m[6 + i];
+			m[i] = c0 * c - c2 * s;
+			m[6 + i] = c0 * s + c2 * c;
+		}
+	}
+
+	void applyRotateZ(float angle)
+	{
+		float s, c;
+		SinCos(angle, s, c);
+		for (int i = 0; i < 3; i++)
+		{
+			float c0 = m[i];
+			float c1 = m[3 + i];
+			m[i] = c0 * c + c1 * s;
+			m[3 + i] = c1 * c - c0 * s;
+		}
+	}
+
+	void applyScale(float x, float y, float z)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			m[i] *= x;
+			m[3 + i] *= y;
+			m[6 + i] *= z;
+		}
+	}
 };
 
 template <typename T>
@@ -452,4 +879,74 @@ public:
 
 	size_t size() const;
 	void clear();
-};
\ No newline at end of file
+};
+// MatrixStack with a compile-time depth on inline storage: no heap traffic.
+// Overflow is only checked in debug builds (assert).
+template <int Depth>
+class FixedMatrixStack
+{
+private:
+	Mat4 stack[Depth];
+	int count;
+
+	Mat4 &next()
+	{
+		assert(count < Depth && "FixedMatrixStack overflow");
+		return stack[count++];
+	}
+
+public:
+	FixedMatrixStack() : count(1) {}
+
+	void push()
+	{
+		Mat4 &m = next();
+		m = stack[count - 2];
+	}
+
+	void pop()
+	{
+		if (count > 1)
+		{ // Always keep at least one matrix
+			count--;
+		}
+	}
+
+	const Mat4 &top() const { return stack[count - 1]; }
+	void multiply(const Mat4 &m) { GetMathKernels().mat4Multiply(stack[count - 1].m, m.m, stack[count - 1].m); }
+
+	// Fused push + operation: the new top is written once instead of copied from the parent and then modified
+	void pushIdentity() { next() = Mat4(); }
+	void pushMultiply(const Mat4 &m)
+	{
+		Mat4 &top = next();
+		GetMathKernels().mat4Multiply(stack[count - 2].m, m.m, top.m);
+	}
+	void pushTranslate(float x, float y, float z)
+	{
+		push();
+		stack[count - 1].applyTranslate(x, y, z);
+	}
+
+	void identity()
+	{
+		count = 1;
+		stack[0] = Mat4();
+	}
+
+	void translate(const Vec3 &v) { stack[count - 1].applyTranslate(v.x, v.y, v.z); }
+	void translate(float x, float y, float z) { stack[count - 1].applyTranslate(x, y, z); }
+
+	void rotate(const Quat &q) { multiply(Mat4::Rotate(q)); }
+	void rotate(float angle, const Vec3 &axis) { multiply(Mat4::Rotate(Quat(angle, axis))); }
+	void rotateX(float a) { stack[count - 1].applyRotateX(a); }
+	void rotateY(float a) { stack[count - 1].applyRotateY(a); }
+	void rotateZ(float a) { stack[count - 1].applyRotateZ(a); }
+
+	void scale(const Vec3 &v) { stack[count - 1].applyScale(v.x, v.y, v.z); }
+	void scale(float x, float y, float z) { stack[count - 1].applyScale(x, y, z); }
+
+	size_t size() const { return (size_t)count; }
+	static constexpr int capacity() { return Depth; }
+	void clear() { identity(); }
+};
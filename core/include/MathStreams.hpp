@@ -0,0 +1,142 @@
+#pragma once
+#include "Math.hpp"
+#include <cstdint>
+#include <vector>
+
+// Structure-of-arrays containers for bulk math.
+// Each component lives in its own contiguous array so the batched kernels below
+// can load 8 lanes at a time (AVX2) and finish the remainder with a scalar tail.
+
+struct Vec3Stream
+{
+	std::vector<float> x, y, z;
+
+	size_t size() const { return x.size(); }
+	bool empty() const { return x.empty(); }
+
+	void resize(size_t count)
+	{
+		x.resize(count);
+		y.resize(count);
+		z.resize(count);
+	}
+
+	void reserve(size_t count)
+	{
+		x.reserve(count);
+		y.reserve(count);
+		z.reserve(count);
+	}
+
+	void clear()
+	{
+		x.clear();
+		y.clear();
+		z.clear();
+	}
+
+	void push(const Vec3 &v)
+	{
+		x.push_back(v.x);
+		y.push_back(v.y);
+		z.push_back(v.z);
+	}
+
+	Vec3 get(size_t i) const { return Vec3(x[i], y[i], z[i]); }
+
+	void set(size_t i, const Vec3 &v)
+	{
+		x[i] = v.x;
+		y[i] = v.y;
+		z[i] = v.z;
+	}
+};
+
+struct QuatStream
+{
+	std::vector<float> w, x, y, z;
+
+	size_t size() const { return w.size(); }
+	bool empty() const { return w.empty(); }
+
+	void resize(size_t count)
+	{
+		w.resize(count, 1.0f);
+		x.resize(count);
+		y.resize(count);
+		z.resize(count);
+	}
+
+	void reserve(size_t count)
+	{
+		w.reserve(count);
+		x.reserve(count);
+		y.reserve(count);
+		z.reserve(count);
+	}
+
+	void clear()
+	{
+		w.clear();
+		x.clear();
+		y.clear();
+		z.clear();
+	}
+
+	void push(const Quat &q)
+	{
+		w.push_back(q.w);
+		x.push_back(q.x);
+		y.push_back(q.y);
+		z.push_back(q.z);
+	}
+
+	Quat get(size_t i) const { return Quat(w[i], x[i], y[i], z[i]); }
+
+	void set(size_t i, const Quat &q)
+	{
+		w[i] = q.w;
+		x[i] = q.x;
+		y[i] = q.y;
+		z[i] = q.z;
+	}
+};
+
+// Batched kernels. Output streams are resized to the input size and may alias an input.
+
+// out[i] = m * (in[i], 1)
+void TransformPoints(const Affine3x4 &m, const Vec3Stream &in, Vec3Stream &out);
+
+// out[i] = normalize(inverseTranspose(m3x3) * in[i])
+void TransformNormals(const Affine3x4 &m, const Vec3Stream &in, Vec3Stream &out);
+
+// out[i] = a[i] * b[i]
+void MultiplyQuats(const QuatStream &a, const QuatStream &b, QuatStream &out);
+
+// out[i] = normalize(lerp(a[i], b[i], t)) along the shortest arc
+void NlerpQuats(const QuatStream &a, const QuatStream &b, float t, QuatStream &out);
+
+// out[i] = |in[i]|
+void Lengths(const Vec3Stream &in, std::vector<float> &out);
+
+// out[i] = in[i] / |in[i]| (vectors shorter than Vec3::EPSILON are copied unchanged)
+void Normalize(const Vec3Stream &in, Vec3Stream &out);
+
+// out[i] = a[i] * (1 - t) + b[i] * t
+void LerpFloats(const float *a, const float *b, float t, float *out, size_t count);
+
+// 16-bit quantized tracks: out[i] = offset[i] + scale[i] * lerp(a[i], b[i], t)
+void DequantizeLerp(const uint16_t *a, const uint16_t *b, const float *offset, const float *scale,
+					float t, float *out, size_t count);
+
+// Cubic tracks by Horner's rule: out[i] = ((c0[i] * t + c1[i]) * t + c2[i]) * t + c3[i],
+// where cj = coefficients + j * stride (the four coefficient rows of a segment, highest power first)
+void EvaluateCubics(const float *coefficients, size_t stride, float t, float *out, size_t count);
+
+// Linear blend skinning of bind-pose points: out[i] = sum over k of weights[k][i] * palette[joints[k][i]] * (in[i], 1).
+// palette holds 12 floats per joint (rows 0..2 of an affine matrix); joints and weights hold
+// `influences` streams of in.size() entries each. Point i is written to out[i * stride + 0..2],
+// so it can go straight into an interleaved vertex buffer.
+void SkinPoints(const float *palette, const Vec3Stream &in, const int32_t *joints, const float *weights,
+				int influences, float *out, size_t stride);
+
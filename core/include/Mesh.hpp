@@ -116,9 +116,19 @@ public:
     void CreateIndexBuffer(unsigned int indexCount);
 
     void SetVertexData(const void *vertexData);
+    // First vertexCount vertices; a dynamic buffer is orphaned first so the upload does not wait on the GPU
+    void SetVertexData(const void *vertexData, unsigned int vertexCount);
     void SetIndexData(const void *indexData);
 
+    // Per-instance attributes, bound after the vertex attributes. divisor is how many instances
+    // share one record (e.g. one record per character drawn as jointCount cube instances).
+    // Elements larger than 4 floats (e.g. a 16-float mat4) take consecutive attribute slots.
+    void CreateInstanceBuffer(const VertexFormat &instanceFormat, unsigned int instanceCount, unsigned int divisor = 1);
+    // Uploads instanceCount instances (orphaning the old storage), growing the buffer if needed
+    void SetInstanceData(const void *instanceData, unsigned int instanceCount);
+
     void Render(int mode, int count);
+    void RenderInstanced(int mode, int count, int instanceCount);
     void Release();
 
 private:
@@ -135,5 +145,39 @@ private:
     unsigned int m_ibo = 0;
     unsigned int m_vbo = 0;
     unsigned int m_vao = 0;
+    unsigned int m_instanceVbo = 0;
+    unsigned int m_instanceCapacity = 0;
     VertexFormat m_vertexFormat;
+    VertexFormat m_instanceFormat;
+};
+
+enum class BufferTarget
+{
+    UNIFORM = GL_UNIFORM_BUFFER,        // std140 uniform block, small and read by every invocation
+    STORAGE = GL_SHADER_STORAGE_BUFFER  // std430 shader storage block, can be large
+};
+
+// GPU buffer bound to an indexed binding point (layout(binding = N) in the shader), for data that
+// does not fit in plain uniforms: joint palettes, per-frame blocks shared by several programs.
+class ShaderBuffer
+{
+public:
+    explicit ShaderBuffer(BufferTarget target = BufferTarget::STORAGE);
+    ~ShaderBuffer();
+
+    void Create(size_t size);
+    // Uploads size bytes (orphaning the old storage), growing the buffer if needed
+    void SetData(const void *data, size_t size);
+    void Bind(unsigned int binding) const;
+    void Release();
+
+    size_t GetSize() const { return m_size; }
+
+private:
+    ShaderBuffer(const ShaderBuffer &) = delete;
+    ShaderBuffer &operator=(const ShaderBuffer &) = delete;
+
+    BufferTarget m_target;
+    unsigned int m_buffer = 0;
+    size_t m_size = 0;
 };
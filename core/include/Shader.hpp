@@ -4,7 +4,42 @@
 #include "Config.hpp"
 
 
+// Per-frame uniform block shared by every program (layout in Driver.hpp, FrameUniforms).
+// Driver::SetFrameUniforms() uploads it to this binding point and a program that declares the block
+// is bound to it at link time, so view/projection are set once per pass instead of once per shader.
+const u32 FRAME_UNIFORM_BINDING = 0;
+#define FRAME_BLOCK_NAME "Frame"
+#define FRAME_UNIFORMS_GLSL                                                                    \
+    "layout(std140) uniform Frame {\n"                                                         \
+    "    mat4 view;\n"                                                                         \
+    "    mat4 projection;\n"                                                                   \
+    "    mat4 viewProj;\n"                                                                     \
+    "    vec4 cameraPosition;\n"                                                               \
+    "    vec4 viewport;\n"                                                                     \
+    "    float time;\n"                                                                        \
+    "};\n"
 
+// GLSL() with the Frame block declared after #version
+#define GLSL_FRAME(src) GLSL_VERSION FRAME_UNIFORMS_GLSL #src
+
+
+// Index into a shader's uniform table, resolved once with Shader::GetUniformHandle()
+struct UniformHandle
+{
+    int index = -1; // -1 = not an active uniform of the program (setters ignore it)
+
+    bool IsValid() const { return index >= 0; }
+};
+
+// One active uniform, read from the program right after linking
+struct UniformInfo
+{
+    u32 hash;     // FNV-1a of the name; arrays are stored without the "[0]" suffix
+    int location;
+    u32 type;     // GL_FLOAT_MAT4, GL_SAMPLER_2D, ...
+    int size;     // array length, 1 for non-arrays
+    std::string name;
+};
 
 class  Shader 
 {
@@ -15,6 +50,20 @@ class  Shader
 
             bool Create(const char* vShaderCode, const char* fShaderCode);
             bool Create(const char* vShaderCode, const char* fShaderCode, const char* gShaderCode);
+            // Create() in two steps, for building several programs at once (ShaderCompileQueue):
+            // Submit() starts compile + link without asking for the result (a cached binary is loaded
+            // right away), IsReady() polls without blocking when the driver has
+            // GL_KHR_parallel_shader_compile, and Finish() checks the logs and fills the uniform table.
+            bool Submit(const char* vShaderCode, const char* fShaderCode, const char* gShaderCode = nullptr);
+            bool IsReady() const;
+            bool Finish();
+            bool IsPending() const { return m_pending; }
+            bool IsValid() const { return m_program > 0 && !m_pending && success; }
+
+            static bool ParallelCompileSupported();
+            // glMaxShaderCompilerThreadsKHR; false when the driver compiles on the calling thread
+            static bool SetCompilerThreads(u32 count);
+
             bool Load(const char* vShaderCode, const char* fShaderCode);
             bool Load(const char* vShaderCode, const char* fShaderCode, const char* gShaderCode);
             bool operator ==(const Shader&      other) const { return m_program == other.m_program; }
@@ -31,15 +80,57 @@ class  Shader
 
    
 
-        void SetInt(const std::string &name, int value) ;
+        // Name lookups go through the uniform table (no GL query, no allocation); a missing
+        // uniform is reported once per name instead of on every call
+        void SetInt(const char *name, int value) ;
  
-        void SetMatrix4(const std::string &name, const float *value) ;
-        void SetMatrix3(const std::string &name, const float *value) ;
+        void SetMatrix4(const char *name, const float *value) ;
+        void SetMatrix3(const char *name, const float *value) ;
+
+        void SetFloat(const char *name, float v);
+        void SetFloat(const char *name, float x, float y);
+        void SetFloat(const char *name, float x, float y, float z);
+        void SetFloat(const char *name, float x, float y, float z,float w);
+        void SetFloat4Array(const char *name, const float *values, int count); // count vec4s
+
+        // Per-draw path: the handle is an index into the table, so a set is one array read and the GL call
+        void SetInt(UniformHandle handle, int value);
 
-        void SetFloat(const std::string& name, float v);
-        void SetFloat(const std::string& name, float x, float y);
-        void SetFloat(const std::string& name, float x, float y, float z);
-        void SetFloat(const std::string& name, float x, float y, float z,float w);
+        void SetMatrix4(UniformHandle handle, const float *value);
+        void SetMatrix3(UniformHandle handle, const float *value);
+
+        void SetFloat(UniformHandle handle, float v);
+        void SetFloat(UniformHandle handle, float x, float y);
+        void SetFloat(UniformHandle handle, float x, float y, float z);
+        void SetFloat(UniformHandle handle, float x, float y, float z, float w);
+        void SetFloat4Array(UniformHandle handle, const float *values, int count);
+
+        UniformHandle GetUniformHandle(const char *name) const;
+        const UniformInfo &GetUniformInfo(UniformHandle handle) const { return m_uniforms[handle.index]; }
+        int GetUniformCount() const { return (int)m_uniforms.size(); }
+        bool UsesFrameBlock() const { return m_frameBlock; }
+
+        // Linked programs are saved to directory (one file per hash of the driver strings and sources)
+        // and loaded with glProgramBinary on the next run; a binary the driver rejects is recompiled.
+        // Empty = always compile from source.
+        static void SetBinaryCache(const std::string &directory);
+
+        // Startup breakdown: programs compiled from source vs. loaded from the cache
+        struct BuildStats
+        {
+            int compiled = 0;
+            int failed = 0; // built from source but failed to compile or link; not counted in compiled
+            int cached = 0;
+            int rejected = 0;
+            double compileMs = 0.0; // time the caller was blocked compiling (overlapped work not counted)
+            double cacheMs = 0.0;
+        };
+        static const BuildStats &GetBuildStats() { return s_buildStats; }
+        static void LogBuildStats();
+
+        // Setters use glProgramUniform* and no longer need the program bound with Use()
+        void SetDirectState(bool enable) { m_directState = enable; }
+        bool IsDirectState() const { return m_directState; }
 
 
 
@@ -71,11 +162,103 @@ private:
         int m_numAttributes;
         int m_numUniforms;
         int success;
+        bool m_directState;
+        bool m_pending;
+        u32 m_stages[3];       // vertex, fragment, geometry while a build is pending
+        std::string m_cachePath;
+        u64 m_cacheKey;
+        u64 m_buildTicks;
+        bool m_frameBlock;
+        std::vector<UniformInfo> m_uniforms;
+        mutable std::vector<u32> m_missingUniforms; // names already reported as missing
+
+        static std::string s_binaryCacheDirectory;
+        static BuildStats s_buildStats;
 
     private:
          void checkCompileErrors(unsigned int shader, const std::string &type);
+         static u64 hashProgramSources(const char *vShaderCode, const char *fShaderCode, const char *gShaderCode);
+         bool loadBinary(const std::string &path, u64 key);
+         void saveBinary(const std::string &path, u64 key);
+         void buildUniformTable();
+         void bindFrameBlock();
+         int findUniformIndex(const char *name) const;
  
            Shader& operator =(const Shader& other) = delete;
            Shader(const Shader& other) = delete;
           
-};
\ No newline at end of file
+};
+
+
+// Builds a set of programs together: every program is submitted before the first status query, so the
+// compiles overlap in the driver's compiler threads instead of stalling one after the other.
+// Call Poll() once per frame (behind a loading screen) or Wait() to block until all are linked.
+class ShaderCompileQueue
+{
+public:
+    // Lets the driver use as many compiler threads as it wants (GL_KHR_parallel_shader_compile)
+    ShaderCompileQueue();
+
+    void Add(Shader &shader, const char *vShaderCode, const char *fShaderCode, const char *gShaderCode = nullptr);
+
+    // Finishes the programs that are ready; true once none is pending
+    bool Poll();
+    // Finishes everything; true if every program linked
+    bool Wait();
+
+    int GetCount() const { return (int)m_shaders.size(); }
+    int GetReadyCount() const;
+    int GetFailedCount() const { return m_failed; }
+
+private:
+    std::vector<Shader *> m_shaders;
+    int m_failed;
+    u64 m_start;
+    bool m_logged;
+
+    void finish(Shader &shader);
+    void logDone();
+
+    ShaderCompileQueue(const ShaderCompileQueue &) = delete;
+    ShaderCompileQueue &operator=(const ShaderCompileQueue &) = delete;
+};
+
+
+// Feature bits of a shader variant: bit i set = keyword i of its ShaderVariants defined
+typedef u32 ShaderFeatures;
+
+// One GLSL source, many programs: each combination of feature keywords is a separate program with
+// "#define KEYWORD 1" lines injected right after #version, so #if/#ifdef blocks strip what a draw does
+// not use. Variants are cached by their bitmask; Get() compiles a missing one on first use and
+// Prewarm() submits a known set to a ShaderCompileQueue so they build together before the first frame.
+// Sources with preprocessor lines cannot go through GLSL() (it joins everything into one line),
+// use a raw string after GLSL_VERSION instead.
+class ShaderVariants
+{
+public:
+    // keywords[i] is the name of feature bit i (at most 32)
+    ShaderVariants(const char *vShaderCode, const char *fShaderCode, const std::vector<std::string> &keywords);
+    ~ShaderVariants();
+
+    Shader &Get(ShaderFeatures features);
+    void Prewarm(ShaderCompileQueue &queue, const ShaderFeatures *features, int count);
+
+    // Bit of a keyword, 0 if it is not one of this shader's features
+    ShaderFeatures GetFeature(const char *keyword) const;
+    int GetVariantCount() const { return (int)m_variants.size(); }
+
+    void Release();
+
+private:
+    std::string m_vertex;
+    std::string m_fragment;
+    std::vector<std::string> m_keywords;
+    std::unordered_map<ShaderFeatures, Shader *> m_variants;
+
+    Shader *create(ShaderFeatures features);
+    std::string expand(const std::string &source, ShaderFeatures features) const;
+
+    ShaderVariants(const ShaderVariants &) = delete;
+    ShaderVariants &operator=(const ShaderVariants &) = delete;
+};
+
@@ -0,0 +1,33 @@
+#pragma once
+
+// Runtime-dispatched math kernels.
+// The backend is picked once at startup from the CPU features. The Mat4/Quat/Vec3
+// operations in Math.hpp, MatrixStack and TransformHierarchy::update go through the
+// active table; constant-evaluated calls keep the inline scalar code.
+
+enum class SimdLevel
+{
+    SCALAR = 0,
+    SSE2,
+    AVX2
+};
+
+struct MathKernels
+{
+    // All matrices are 16 floats column-major, quats are (w, x, y, z), vectors (x, y, z).
+    // out may alias any input.
+    void (*mat4Multiply)(const float *a, const float *b, float *out);
+    void (*mat4Transform)(const float *m, const float *v, float *out);
+    void (*quatMultiply)(const float *a, const float *b, float *out);
+    void (*quatRotate)(const float *q, const float *v, float *out);
+    void (*vec3Normalize)(const float *v, float *out);
+    void (*vec3Cross)(const float *a, const float *b, float *out);
+};
+
+SimdLevel GetSupportedSimdLevel();          // best level this CPU can run
+SimdLevel GetSimdLevel();                   // level in use
+void SetSimdLevel(SimdLevel level);         // force a level (clamped to the supported one)
+const char *GetSimdLevelName(SimdLevel level);
+
+const MathKernels &GetMathKernels();                 // active table
+const MathKernels &GetMathKernels(SimdLevel level);  // table for a given level (clamped)
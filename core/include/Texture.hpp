@@ -101,6 +101,8 @@ class   Texture2D  : public Texture
     bool Load(const Pixmap &pixmap);
     bool Load(const char* file_name);
     bool LoadFromMemory(const unsigned char *buffer,u16 components, int width, int height);
+    // RGBA32F data texture (no mipmaps, nearest, clamped), read in shaders with texelFetch
+    bool LoadFloat(const float *buffer, int width, int height);
     u32 GetID() {return id;}
 
     static Texture2D * GetDefaultTexture();
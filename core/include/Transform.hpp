@@ -0,0 +1,43 @@
+#pragma once
+#include "Math.hpp"
+#include <vector>
+
+// Retained transform hierarchy.
+// Nodes live in flat arrays in topological order (a parent always comes before its
+// children), so update() is a single forward pass. Only nodes whose local TRS changed,
+// or whose parent was recomputed in the same pass, get a new world matrix.
+class TransformHierarchy
+{
+public:
+	TransformHierarchy() {}
+
+	// parent must be -1 (root) or an existing node; returns the new node index
+	int addNode(int parent, const Vec3 &translation = Vec3(), const Quat &rotation = Quat(), const Vec3 &scale = Vec3(1.0f, 1.0f, 1.0f));
+	void reserve(size_t count);
+	void clear();
+
+	void setTranslation(int node, const Vec3 &t);
+	void setRotation(int node, const Quat &q);
+	void setScale(int node, const Vec3 &s);
+
+	const Vec3 &getTranslation(int node) const { return translations[node]; }
+	const Quat &getRotation(int node) const { return rotations[node]; }
+	const Vec3 &getScale(int node) const { return scales[node]; }
+	int getParent(int node) const { return parents[node]; }
+	bool isDirty(int node) const { return dirty[node] != 0; }
+
+	// Recomputes the world matrix of every dirty node and its descendants, returns how many were rebuilt
+	int update();
+
+	const Mat4 &getWorld(int node) const { return worlds[node]; }
+	const Mat4 *getWorldMatrices() const { return worlds.data(); }
+	size_t size() const { return parents.size(); }
+
+private:
+	std::vector<int> parents;
+	std::vector<Vec3> translations;
+	std::vector<Quat> rotations;
+	std::vector<Vec3> scales;
+	std::vector<Mat4> worlds;
+	std::vector<unsigned char> dirty;
+};
@@ -3,6 +3,7 @@
 #include "Device.hpp"
 #include "Input.hpp"
 #include "Driver.hpp"
+#include "Simd.hpp"
 
 #if defined(PLATFORM_DESKTOP) && defined(_WIN32) && (defined(_MSC_VER) || defined(__TINYC__))
 
@@ -279,6 +280,7 @@ bool Device::initGL(bool vzync)
     LogInfo("[DEVICE] Version :  %s", glGetString(GL_VERSION));
 
     LogInfo("[DEVICE] GLSL Version: %s", glGetString(GL_SHADING_LANGUAGE_VERSION));
+    LogInfo("[DEVICE] Math SIMD :  %s", GetSimdLevelName(GetSimdLevel()));
 
     return true;
 }
@@ -1,5 +1,6 @@
 #pragma
 #include "Driver.hpp"
+#include "Mesh.hpp"
 
 
 
@@ -12,7 +13,7 @@ Driver &Driver::Instance()
 
 Driver::Driver()
 {
-   
+    m_frameBuffer = nullptr;
 }
 
 Driver::~Driver()
@@ -94,7 +95,8 @@ void Driver::Release()
 {
      LogInfo("[DRIVER] Destroyed");
 
-   
+    delete m_frameBuffer;
+    m_frameBuffer = nullptr;
 }
 
 
@@ -593,6 +595,28 @@ void Driver::Clear()
     glClear(mask);
 }
 
+void Driver::SetFrameUniforms(const Mat4 &view, const Mat4 &projection, const Vec3 &cameraPosition, float time)
+{
+    m_frame.view = view;
+    m_frame.projection = projection;
+    m_frame.viewProj = projection * view;
+    m_frame.cameraPosition[0] = cameraPosition.x;
+    m_frame.cameraPosition[1] = cameraPosition.y;
+    m_frame.cameraPosition[2] = cameraPosition.z;
+    m_frame.cameraPosition[3] = 1.0f;
+    m_frame.viewport[0] = (float)viewport.x;
+    m_frame.viewport[1] = (float)viewport.y;
+    m_frame.viewport[2] = (float)viewport.width;
+    m_frame.viewport[3] = (float)viewport.height;
+    m_frame.time = time;
+    m_frame.padding[0] = m_frame.padding[1] = m_frame.padding[2] = 0.0f;
+
+    if (!m_frameBuffer)
+        m_frameBuffer = new ShaderBuffer(BufferTarget::UNIFORM);
+    m_frameBuffer->SetData(&m_frame, sizeof(FrameUniforms));
+    m_frameBuffer->Bind(FRAME_UNIFORM_BINDING);
+}
+
  void  Driver::DrawElements(GLenum mode, GLsizei count, GLenum type,const void *indices)
 {
     glDrawElements(mode, count, type, indices);
@@ -1,6 +1,17 @@
 
 #include "File.hpp"
 
+#if defined(PLATFORM_WIN)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(PLATFORM_LINUX) || defined(PLATFORM_ANDROID)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CORE_HAS_MMAP
+#endif
+
 
 
 //********************************************************************************************************************
@@ -530,4 +541,110 @@ StreamText& operator>>(StreamText& stream, std::string& value)
     if (!stream.getline(value))
         SDL_LogError(1, "Failed to read line from stream");
     return stream;
-}
\ No newline at end of file
+}
+
+//********************************************************************************************************************
+// MAPPED FILE
+//********************************************************************************************************************
+
+MappedFile::MappedFile()
+{
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+    m_handle = nullptr;
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string &filePath)
+{
+    Close();
+
+#if defined(PLATFORM_WIN)
+    HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        SDL_LogInfo(1, " Cant open: %s", filePath.c_str());
+        return false;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(file, &size);
+    HANDLE mapping = (size.QuadPart > 0) ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+    CloseHandle(file);
+    if (mapping == NULL)
+    {
+        SDL_LogInfo(1, " Cant map: %s", filePath.c_str());
+        return false;
+    }
+    m_data = (const unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (m_data == nullptr)
+    {
+        CloseHandle(mapping);
+        return false;
+    }
+    m_handle = mapping;
+    m_size = (u64)size.QuadPart;
+    m_mapped = true;
+    return true;
+#elif defined(CORE_HAS_MMAP)
+    int fd = open(filePath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        SDL_LogInfo(1, " Cant open: %s", filePath.c_str());
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0)
+    {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        SDL_LogInfo(1, " Cant map: %s", filePath.c_str());
+        return false;
+    }
+    m_data = (const unsigned char *)data;
+    m_size = (u64)info.st_size;
+    m_mapped = true;
+    return true;
+#else
+    size_t size = 0;
+    void *data = SDL_LoadFile(filePath.c_str(), &size);
+    if (data == nullptr)
+    {
+        SDL_LogInfo(1, " Cant open: %s", filePath.c_str());
+        return false;
+    }
+    m_data = (const unsigned char *)data;
+    m_size = (u64)size;
+    m_mapped = false;
+    return true;
+#endif
+}
+
+void MappedFile::Close()
+{
+    if (m_data == nullptr)
+        return;
+
+#if defined(PLATFORM_WIN)
+    UnmapViewOfFile(m_data);
+    CloseHandle((HANDLE)m_handle);
+#elif defined(CORE_HAS_MMAP)
+    munmap((void *)m_data, (size_t)m_size);
+#else
+    SDL_free((void *)m_data);
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+    m_handle = nullptr;
+}
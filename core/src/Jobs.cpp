@@ -0,0 +1,282 @@
+#include "Jobs.hpp"
+#include "Config.hpp"
+#include <SDL3/SDL_cpuinfo.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+
+static const int MAX_JOB_WORKERS = 64;
+static const int JOB_QUEUE_SIZE = 4096; // power of two; jobs queued per worker
+static const int JOB_POOL_SIZE = JOB_QUEUE_SIZE * 2;
+static const int IDLE_SPINS = 64;       // failed steal rounds before a worker goes to sleep
+
+struct Job
+{
+    JobFunction function;
+    void *data;
+    int begin;
+    int end;
+    JobCounter *counter;
+    std::atomic<bool> queued{false}; // slot is owned by a queue until a worker takes it
+};
+
+// Chase-Lev deque over a fixed ring (Le et al., "Correct and Efficient Work-Stealing for Weak
+// Memory Models"). The owner uses push/pop at the bottom, thieves use steal at the top.
+class JobQueue
+{
+public:
+    JobQueue()
+    {
+        for (int i = 0; i < JOB_QUEUE_SIZE; i++)
+            slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+
+    bool push(Job *job)
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        if (b - t >= JOB_QUEUE_SIZE)
+            return false;
+        slots[b & (JOB_QUEUE_SIZE - 1)].store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Job *pop()
+    {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+        if (t > b)
+        {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job *job = slots[b & (JOB_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+        if (t == b)
+        {
+            // Last job: race the thieves for it
+            if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                job = nullptr;
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job *steal()
+    {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b)
+            return nullptr;
+
+        Job *job = slots[t & (JOB_QUEUE_SIZE - 1)].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return job;
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> top{0};
+    alignas(64) std::atomic<int64_t> bottom{0};
+    std::atomic<Job *> slots[JOB_QUEUE_SIZE];
+};
+
+// Per-worker state. Jobs come from a ring owned by the worker that submits them. The ring is
+// larger than the queue, so a slot that is still queued is always skipped rather than waited on.
+struct alignas(64) JobWorker
+{
+    JobQueue queue;
+    Job jobs[JOB_POOL_SIZE];
+    unsigned int nextJob = 0;
+    unsigned int random = 0;
+};
+
+static JobWorker *s_workers = nullptr;
+static int s_workerCount = 1;
+static std::vector<std::thread> s_threads;
+static std::atomic<bool> s_running{false};
+static std::atomic<int> s_queued{0};   // pushed and not yet taken, to know when sleeping is safe
+static std::atomic<int> s_sleeping{0};
+static std::mutex s_sleepMutex;
+static std::condition_variable s_wake;
+static thread_local int t_workerIndex = -1;
+
+// Copies the job out and frees its slot, so the submitter can reuse it while this one runs
+static bool TakeJob(int index, Job &out)
+{
+    JobWorker &self = s_workers[index];
+    Job *job = self.queue.pop();
+    if (!job)
+    {
+        // Start at a random victim so thieves do not all hammer the same queue
+        self.random = self.random * 1664525u + 1013904223u;
+        int start = (int)(self.random >> 16) % s_workerCount;
+        for (int i = 0; i < s_workerCount && !job; i++)
+        {
+            int victim = (start + i) % s_workerCount;
+            if (victim != index)
+                job = s_workers[victim].queue.steal();
+        }
+    }
+    if (!job)
+        return false;
+
+    s_queued.fetch_sub(1);
+    out.function = job->function;
+    out.data = job->data;
+    out.begin = job->begin;
+    out.end = job->end;
+    out.counter = job->counter;
+    job->queued.store(false, std::memory_order_release);
+    return true;
+}
+
+static void Execute(const Job &job)
+{
+    job.function(job.data, job.begin, job.end);
+    if (job.counter)
+        job.counter->pending.fetch_sub(1, std::memory_order_release);
+}
+
+static void WorkerLoop(int index)
+{
+    t_workerIndex = index;
+    int idle = 0;
+    while (s_running.load(std::memory_order_relaxed))
+    {
+        Job job;
+        if (TakeJob(index, job))
+        {
+            Execute(job);
+            idle = 0;
+            continue;
+        }
+
+        if (++idle < IDLE_SPINS)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // Nothing to do for a while: sleep until RunJob() queues something
+        std::unique_lock<std::mutex> lock(s_sleepMutex);
+        s_sleeping.fetch_add(1);
+        s_wake.wait(lock, []
+                    { return !s_running.load() || s_queued.load() > 0; });
+        s_sleeping.fetch_sub(1);
+        idle = 0;
+    }
+}
+
+void InitJobs(int workerCount)
+{
+    if (s_workers)
+        ShutdownJobs();
+
+    if (workerCount <= 0)
+        workerCount = SDL_GetNumLogicalCPUCores();
+    if (workerCount < 1)
+        workerCount = 1;
+    if (workerCount > MAX_JOB_WORKERS)
+        workerCount = MAX_JOB_WORKERS;
+
+    s_workerCount = workerCount;
+    s_workers = new JobWorker[workerCount];
+    for (int i = 0; i < workerCount; i++)
+        s_workers[i].random = (unsigned int)i * 2654435761u + 1u;
+
+    t_workerIndex = 0;
+    s_running.store(true);
+    for (int i = 1; i < workerCount; i++)
+        s_threads.emplace_back(WorkerLoop, i);
+
+    LogInfo("JOBS: %d worker(s)", workerCount);
+}
+
+void ShutdownJobs()
+{
+    if (!s_workers)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(s_sleepMutex);
+        s_running.store(false);
+    }
+    s_wake.notify_all();
+    for (std::thread &thread : s_threads)
+        thread.join();
+    s_threads.clear();
+
+    delete[] s_workers;
+    s_workers = nullptr;
+    s_workerCount = 1;
+    s_queued.store(0);
+    t_workerIndex = -1;
+}
+
+int GetJobWorkerCount() { return s_workerCount; }
+
+int GetJobWorkerIndex() { return s_workers ? t_workerIndex : 0; }
+
+void RunJob(JobFunction function, void *data, int begin, int end, JobCounter *counter)
+{
+    int index = s_workers ? t_workerIndex : -1;
+    if (index < 0)
+    {
+        function(data, begin, end);
+        return;
+    }
+
+    JobWorker &self = s_workers[index];
+    Job *job = &self.jobs[self.nextJob++ & (JOB_POOL_SIZE - 1)];
+    while (job->queued.load(std::memory_order_acquire))
+        job = &self.jobs[self.nextJob++ & (JOB_POOL_SIZE - 1)];
+    job->function = function;
+    job->data = data;
+    job->begin = begin;
+    job->end = end;
+    job->counter = counter;
+
+    if (counter)
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+    // Increment before publishing so a thief never takes the count below zero
+    job->queued.store(true, std::memory_order_relaxed);
+    s_queued.fetch_add(1);
+    if (!self.queue.push(job))
+    {
+        s_queued.fetch_sub(1);
+        job->queued.store(false, std::memory_order_relaxed);
+        Execute(*job);
+        return;
+    }
+
+    if (s_sleeping.load() > 0)
+    {
+        { std::lock_guard<std::mutex> lock(s_sleepMutex); }
+        s_wake.notify_one();
+    }
+}
+
+void WaitJobs(JobCounter &counter)
+{
+    int index = s_workers ? t_workerIndex : -1;
+    assert((index >= 0 || counter.done()) && "WaitJobs: jobs were queued from a thread the job system does not own");
+
+    while (!counter.done())
+    {
+        Job job;
+        if (TakeJob(index, job))
+            Execute(job);
+        else
+            std::this_thread::yield();
+    }
+}
@@ -1,331 +1,4 @@
-
 #include "Math.hpp"
-#include <cmath>
-#include <cstring>
-
-Vec2::Vec2() : x(0.0f), y(0.0f) {}
-Vec2::Vec2(float x, float y) : x(x), y(y) {}
-
-float Vec2::getX() const { return x; }
-float Vec2::getY() const { return y; }
-void Vec2::setX(float newX) { x = newX; }
-void Vec2::setY(float newY) { y = newY; }
-
-Vec2 Vec2::operator+(const Vec2 &other) const
-{
-    return Vec2(x + other.x, y + other.y);
-}
-
-Vec2 Vec2::operator-(const Vec2 &other) const
-{
-    return Vec2(x - other.x, y - other.y);
-}
-
-Vec2 Vec2::operator*(float scalar) const
-{
-    return Vec2(x * scalar, y * scalar);
-}
-
-float Vec2::dot(const Vec2 &other) const
-{
-    return x * other.x + y * other.y;
-}
-
-float Vec2::length() const
-{
-    return std::sqrt(x * x + y * y);
-}
-
-Vec2 Vec2::normalize() const
-{
-    float len = length();
-    if (len > 0)
-    {
-        return Vec2(x / len, y / len);
-    }
-    return *this;
-}
-
-// Vec3
-
-Vec3::Vec3() : x(0.0f), y(0.0f), z(0.0f) {}
-Vec3::Vec3(float x, float y, float z) : x(x), y(y), z(z) {}
-
-float Vec3::getX() const { return x; }
-float Vec3::getY() const { return y; }
-float Vec3::getZ() const { return z; }
-void Vec3::setX(float newX) { x = newX; }
-void Vec3::setY(float newY) { y = newY; }
-void Vec3::setZ(float newZ) { z = newZ; }
-
-Vec3 Vec3::operator+(const Vec3 &other) const
-{
-    return Vec3(x + other.x, y + other.y, z + other.z);
-}
-
-Vec3 Vec3::operator-(const Vec3 &other) const
-{
-    return Vec3(x - other.x, y - other.y, z - other.z);
-}
-
-Vec3 Vec3::operator*(float scalar) const
-{
-    return Vec3(x * scalar, y * scalar, z * scalar);
-}
-
-float Vec3::dot(const Vec3 &other) const
-{
-    return x * other.x + y * other.y + z * other.z;
-}
-
-Vec3 Vec3::cross(const Vec3 &other) const
-{
-    return Vec3(
-        y * other.z - z * other.y,
-        z * other.x - x * other.z,
-        x * other.y - y * other.x);
-}
-
-float Vec3::length() const
-{
-    return std::sqrt(x * x + y * y + z * z);
-}
-
-Vec3 Vec3::normalize() const
-{
-    float len = length();
-    if (len > EPSILON)
-    {
-        float invLen = 1.0f / len;
-        return Vec3(x * invLen, y * invLen, z * invLen);
-    }
-    return *this;
-}
-
-// Quat
-Quat::Quat() : w(1.0f), x(0.0f), y(0.0f), z(0.0f) {}
-Quat::Quat(float w, float x, float y, float z) : w(w), x(x), y(y), z(z) {}
-
-Quat::Quat(float angle, const Vec3 &axis)
-{
-    float halfAngle = angle * 0.5f;
-    float sinHalfAngle = std::sin(halfAngle);
-    Vec3 normalizedAxis = axis.normalize();
-
-    w = std::cos(halfAngle);
-    x = normalizedAxis.getX() * sinHalfAngle;
-    y = normalizedAxis.getY() * sinHalfAngle;
-    z = normalizedAxis.getZ() * sinHalfAngle;
-}
-
-float Quat::getW() const { return w; }
-float Quat::getX() const { return x; }
-float Quat::getY() const { return y; }
-float Quat::getZ() const { return z; }
-
-Quat Quat::operator*(const Quat &other) const
-{
-    return Quat(
-        w * other.w - x * other.x - y * other.y - z * other.z,
-        w * other.x + x * other.w + y * other.z - z * other.y,
-        w * other.y - x * other.z + y * other.w + z * other.x,
-        w * other.z + x * other.y - y * other.x + z * other.w);
-}
-
-Quat Quat::conjugate() const
-{
-    return Quat(w, -x, -y, -z);
-}
-
-float Quat::length() const
-{
-    return std::sqrt(w * w + x * x + y * y + z * z);
-}
-
-Quat Quat::normalize() const
-{
-    float len = length();
-    if (len > 0)
-    {
-        float invLen = 1.0f / len;
-        return Quat(w * invLen, x * invLen, y * invLen, z * invLen);
-    }
-    return *this;
-}
-
-Vec3 Quat::rotate(const Vec3 &v) const
-{
-    Quat p(0, v.getX(), v.getY(), v.getZ());
-    Quat rotated = *this * p * conjugate();
-    return Vec3(rotated.x, rotated.y, rotated.z);
-}
-
-// Mat4
-Mat4::Mat4()
-{
-    // Initialize as identity matrix
-    std::memset(m, 0, sizeof(m));
-    m[0] = m[5] = m[10] = m[15] = 1.0f;
-}
-
-Mat4::Mat4(const float *values)
-{
-    std::memcpy(m, values, sizeof(m));
-}
-
-float &Mat4::at(int row, int col)
-{
-    return m[col * 4 + row];
-}
-
-float Mat4::at(int row, int col) const
-{
-    return m[col * 4 + row];
-}
-
-const float *Mat4::data() const
-{
-    return m;
-}
-
-Mat4 Mat4::operator*(const Mat4 &other) const
-{
-    Mat4 result;
-    for (int row = 0; row < 4; row++)
-    {
-        for (int col = 0; col < 4; col++)
-        {
-            result.at(row, col) = 0;
-            for (int k = 0; k < 4; k++)
-            {
-                result.at(row, col) += at(row, k) * other.at(k, col);
-            }
-        }
-    }
-    return result;
-}
-
-Vec3 Mat4::transform(const Vec3 &v) const
-{
-    float w = m[3] * v.getX() + m[7] * v.getY() + m[11] * v.getZ() + m[15];
-    const float EPSILON = 1e-6f;
-    w = (std::abs(w) > EPSILON) ? 1.0f / w : 1.0f;
-    return Vec3(
-        (m[0] * v.getX() + m[4] * v.getY() + m[8] * v.getZ() + m[12]) * w,
-        (m[1] * v.getX() + m[5] * v.getY() + m[9] * v.getZ() + m[13]) * w,
-        (m[2] * v.getX() + m[6] * v.getY() + m[10] * v.getZ() + m[14]) * w);
-}
-
-Mat4 Mat4::Translate(const Vec3 &v)
-{
-    Mat4 result;
-    result.at(0, 3) = v.getX();
-    result.at(1, 3) = v.getY();
-    result.at(2, 3) = v.getZ();
-    return result;
-}
-
-Mat4 Mat4::Rotate(const Quat &q)
-{
-    Mat4 result;
-    float xx = q.getX() * q.getX();
-    float xy = q.getX() * q.getY();
-    float xz = q.getX() * q.getZ();
-    float xw = q.getX() * q.getW();
-    float yy = q.getY() * q.getY();
-    float yz = q.getY() * q.getZ();
-    float yw = q.getY() * q.getW();
-    float zz = q.getZ() * q.getZ();
-    float zw = q.getZ() * q.getW();
-
-    result.at(0, 0) = 1 - 2 * (yy + zz);
-    result.at(0, 1) = 2 * (xy - zw);
-    result.at(0, 2) = 2 * (xz + yw);
-    result.at(1, 0) = 2 * (xy + zw);
-    result.at(1, 1) = 1 - 2 * (xx + zz);
-    result.at(1, 2) = 2 * (yz - xw);
-    result.at(2, 0) = 2 * (xz - yw);
-    result.at(2, 1) = 2 * (yz + xw);
-    result.at(2, 2) = 1 - 2 * (xx + yy);
-
-    return result;
-}
-
-Mat4 Mat4::Scale(const Vec3 &v)
-{
-    Mat4 result;
-    result.at(0, 0) = v.getX();
-    result.at(1, 1) = v.getY();
-    result.at(2, 2) = v.getZ();
-    return result;
-}
-
-Mat4 Mat4::Perspective(float fovRadians, float aspect, float near, float far)
-{
-    Mat4 result;
-    float tanHalfFov = std::tan(fovRadians / 2.0f);
-
-    result.at(0, 0) = 1.0f / (aspect * tanHalfFov);
-    result.at(1, 1) = 1.0f / tanHalfFov;
-    result.at(2, 2) = -(far + near) / (far - near);
-    result.at(2, 3) = -(2.0f * far * near) / (far - near);
-    result.at(3, 2) = -1.0f;
-    result.at(3, 3) = 0.0f;
-
-    return result;
-}
-
-Mat4 Mat4::LookAt(const Vec3 &eye, const Vec3 &center, const Vec3 &up)
-{
-    Vec3 f = (center - eye).normalize();
-    Vec3 s = f.cross(up).normalize();
-    Vec3 u = s.cross(f);
-
-    Mat4 result;
-    result.at(0, 0) = s.getX();
-    result.at(0, 1) = s.getY();
-    result.at(0, 2) = s.getZ();
-    result.at(0, 3) = -s.dot(eye);
-
-    result.at(1, 0) = u.getX();
-    result.at(1, 1) = u.getY();
-    result.at(1, 2) = u.getZ();
-    result.at(1, 3) = -u.dot(eye);
-
-    result.at(2, 0) = -f.getX();
-    result.at(2, 1) = -f.getY();
-    result.at(2, 2) = -f.getZ();
-    result.at(2, 3) = f.dot(eye);
-
-    result.at(3, 0) = 0.0f;
-    result.at(3, 1) = 0.0f;
-    result.at(3, 2) = 0.0f;
-    result.at(3, 3) = 1.0f;
-
-    return result;
-}
-
-Mat4 Mat4::Ortho(float left, float right, float bottom, float top, float near, float far)
-{
-    Mat4 mat;
-    mat.m[0] = 2.0f / (right - left);
-    mat.m[5] = 2.0f / (top - bottom);
-    mat.m[10] = -2.0f / (far - near);
-    mat.m[12] = -(right + left) / (right - left);
-    mat.m[13] = -(top + bottom) / (top - bottom);
-    mat.m[14] = -(far + near) / (far - near);
-    mat.m[15] = 1.0f;
-    return mat;
-}
-Mat4 Mat4::Identity()
-{
-    Mat4 mat;
-    mat.m[0] = 1.0f;
-    mat.m[5] = 1.0f;
-    mat.m[10] = 1.0f;
-    mat.m[15] = 1.0f;
-    return mat;
-}
 
 MatrixStack::MatrixStack()
 {
@@ -367,12 +40,12 @@ void MatrixStack::identity()
 
 void MatrixStack::translate(const Vec3 &v)
 {
-    multiply(Mat4::Translate(v));
+    stack.back().applyTranslate(v.x, v.y, v.z);
 }
 
 void MatrixStack::translate(float x, float y, float z)
 {
-    translate(Vec3(x,y,z));
+    stack.back().applyTranslate(x, y, z);
 }
 
 void MatrixStack::rotate(const Quat &q)
@@ -386,30 +59,32 @@ void MatrixStack::rotate(float angle, const Vec3 &axis)
 }
 
 
+// Axis rotations, translations and scales are applied in place on the top matrix
+// instead of building a full Mat4 and doing a 4x4 product.
 void MatrixStack::rotateX(float a)
 {
-    rotate(a,Vec3(1.0f,0.0f,0.0f));
+    stack.back().applyRotateX(a);
 }
 
 
 void MatrixStack::rotateY(float a)
 {
-    rotate(a,Vec3(0.0f,1.0f,0.0f));
+    stack.back().applyRotateY(a);
 
 }
 void MatrixStack::rotateZ(float a)
 {
-    rotate(a,Vec3(0.0f,0.0f,1.0f));
+    stack.back().applyRotateZ(a);
 
 }
 
 void MatrixStack::scale(const Vec3 &v)
 {
-    multiply(Mat4::Scale(v));
+    stack.back().applyScale(v.x, v.y, v.z);
 }
 void MatrixStack::scale(float x, float y, float z)
 {
-    scale(Vec3(x,y,z));
+    stack.back().applyScale(x, y, z);
 }
 	
 
@@ -422,3 +97,30 @@ void MatrixStack::clear()
 {
     identity();
 }
+
+
+// Compile-time checks: the transform builders and angle helpers must fold to constants.
+
+static_assert(ToRadians(180.0f) == Pi, "ToRadians");
+static_assert(ToDegrees(Pi) == 180.0f, "ToDegrees");
+static_assert(Mat4::Identity().m[0] == 1.0f && Mat4::Identity().m[5] == 1.0f &&
+                  Mat4::Identity().m[10] == 1.0f && Mat4::Identity().m[15] == 1.0f &&
+                  Mat4::Identity().m[1] == 0.0f && Mat4::Identity().m[12] == 0.0f,
+              "Mat4::Identity");
+static_assert(Mat4::Translate(Vec3(1.0f, 2.0f, 3.0f)).at(0, 3) == 1.0f &&
+                  Mat4::Translate(Vec3(1.0f, 2.0f, 3.0f)).at(1, 3) == 2.0f &&
+                  Mat4::Translate(Vec3(1.0f, 2.0f, 3.0f)).at(2, 3) == 3.0f,
+              "Mat4::Translate");
+static_assert(Mat4::Scale(Vec3(2.0f, 3.0f, 4.0f)).at(0, 0) == 2.0f &&
+                  Mat4::Scale(Vec3(2.0f, 3.0f, 4.0f)).at(1, 1) == 3.0f &&
+                  Mat4::Scale(Vec3(2.0f, 3.0f, 4.0f)).at(2, 2) == 4.0f &&
+                  Mat4::Scale(Vec3(2.0f, 3.0f, 4.0f)).at(3, 3) == 1.0f,
+              "Mat4::Scale");
+static_assert(Mat4::Rotate(Quat()).m[0] == 1.0f && Mat4::Rotate(Quat()).m[4] == 0.0f, "Mat4::Rotate");
+static_assert(Mat4::Ortho(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f).m[10] == -1.0f, "Mat4::Ortho");
+static_assert(Affine3x4(Mat4::Translate(Vec3(1.0f, 2.0f, 3.0f))).transformPoint(Vec3()) == Vec3(1.0f, 2.0f, 3.0f), "Affine3x4(Mat4)");
+static_assert((Affine3x4::Translate(Vec3(1.0f, 0.0f, 0.0f)) * Affine3x4::Scale(Vec3(2.0f, 2.0f, 2.0f))).transformPoint(Vec3(1.0f, 1.0f, 1.0f)) == Vec3(3.0f, 2.0f, 2.0f), "Affine3x4::operator*");
+static_assert(Vec3(1.0f, 0.0f, 0.0f).cross(Vec3(0.0f, 1.0f, 0.0f)) == Vec3(0.0f, 0.0f, 1.0f), "Vec3::cross");
+static_assert(Vec3(1.0f, 2.0f, 3.0f).dot(Vec3(4.0f, 5.0f, 6.0f)) == 32.0f, "Vec3::dot");
+static_assert((Quat(0.0f, 0.0f, 0.0f, 1.0f) * Quat(0.0f, 0.0f, 0.0f, 1.0f)).w == -1.0f, "Quat::operator*");
+static_assert(Quat(0.0f, 0.0f, 0.0f, 1.0f).rotate(Vec3(1.0f, 0.0f, 0.0f)) == Vec3(-1.0f, 0.0f, 0.0f), "Quat::rotate");
@@ -0,0 +1,566 @@
+#include "MathStreams.hpp"
+#include "SimdTarget.hpp"
+#include <cmath>
+
+static bool UseAVX2()
+{
+    return GetSimdLevel() == SimdLevel::AVX2;
+}
+
+//***********************************************************************************************************
+// Scalar loops, used on their own without AVX2 and for the tail of the AVX2 loops
+
+static void TransformPointsScalar(const float *m, const float *ix, const float *iy, const float *iz,
+                                  float *ox, float *oy, float *oz, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        float x = ix[i], y = iy[i], z = iz[i];
+        ox[i] = m[0] * x + m[3] * y + m[6] * z + m[9];
+        oy[i] = m[1] * x + m[4] * y + m[7] * z + m[10];
+        oz[i] = m[2] * x + m[5] * y + m[8] * z + m[11];
+    }
+}
+
+static void TransformNormalsScalar(const float *n, const float *ix, const float *iy, const float *iz,
+                                   float *ox, float *oy, float *oz, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        float x = ix[i], y = iy[i], z = iz[i];
+        float nx = n[0] * x + n[3] * y + n[6] * z;
+        float ny = n[1] * x + n[4] * y + n[7] * z;
+        float nz = n[2] * x + n[5] * y + n[8] * z;
+        float len2 = nx * nx + ny * ny + nz * nz;
+        float inv = (len2 > Vec3::EPSILON * Vec3::EPSILON) ? 1.0f / std::sqrt(len2) : 1.0f;
+        ox[i] = nx * inv;
+        oy[i] = ny * inv;
+        oz[i] = nz * inv;
+    }
+}
+
+static void MultiplyQuatsScalar(const QuatStream &a, const QuatStream &b, QuatStream &out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        float aw = a.w[i], ax = a.x[i], ay = a.y[i], az = a.z[i];
+        float bw = b.w[i], bx = b.x[i], by = b.y[i], bz = b.z[i];
+        out.w[i] = aw * bw - ax * bx - ay * by - az * bz;
+        out.x[i] = aw * bx + ax * bw + ay * bz - az * by;
+        out.y[i] = aw * by - ax * bz + ay * bw + az * bx;
+        out.z[i] = aw * bz + ax * by - ay * bx + az * bw;
+    }
+}
+
+static void NlerpQuatsScalar(const QuatStream &a, const QuatStream &b, float t, QuatStream &out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        float aw = a.w[i], ax = a.x[i], ay = a.y[i], az = a.z[i];
+        float bw = b.w[i], bx = b.x[i], by = b.y[i], bz = b.z[i];
+        float d = aw * bw + ax * bx + ay * by + az * bz;
+        float tb = (d < 0.0f) ? -t : t;
+        float ta = 1.0f - t;
+        float w = aw * ta + bw * tb;
+        float x = ax * ta + bx * tb;
+        float y = ay * ta + by * tb;
+        float z = az * ta + bz * tb;
+        float len2 = w * w + x * x + y * y + z * z;
+        float inv = (len2 > 0.0f) ? 1.0f / std::sqrt(len2) : 1.0f;
+        out.w[i] = w * inv;
+        out.x[i] = x * inv;
+        out.y[i] = y * inv;
+        out.z[i] = z * inv;
+    }
+}
+
+static void LengthsScalar(const Vec3Stream &in, float *out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        float x = in.x[i], y = in.y[i], z = in.z[i];
+        out[i] = std::sqrt(x * x + y * y + z * z);
+    }
+}
+
+static void NormalizeScalar(const Vec3Stream &in, Vec3Stream &out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        float x = in.x[i], y = in.y[i], z = in.z[i];
+        float len = std::sqrt(x * x + y * y + z * z);
+        float inv = (len > Vec3::EPSILON) ? 1.0f / len : 1.0f;
+        out.x[i] = x * inv;
+        out.y[i] = y * inv;
+        out.z[i] = z * inv;
+    }
+}
+
+static void LerpFloatsScalar(const float *a, const float *b, float t, float *out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        out[i] = a[i] * (1.0f - t) + b[i] * t;
+    }
+}
+
+static void DequantizeLerpScalar(const uint16_t *a, const uint16_t *b, const float *offset, const float *scale,
+                                 float t, float *out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        float q = (float)a[i] * (1.0f - t) + (float)b[i] * t;
+        out[i] = offset[i] + scale[i] * q;
+    }
+}
+
+static void EvaluateCubicsScalar(const float *coefficients, size_t stride, float t, float *out, size_t begin, size_t end)
+{
+    const float *c0 = coefficients;
+    const float *c1 = c0 + stride;
+    const float *c2 = c1 + stride;
+    const float *c3 = c2 + stride;
+    for (size_t i = begin; i < end; i++)
+    {
+        out[i] = ((c0[i] * t + c1[i]) * t + c2[i]) * t + c3[i];
+    }
+}
+
+static void SkinPointsScalar(const float *palette, const Vec3Stream &in, const int32_t *joints, const float *weights,
+                             int influences, float *out, size_t stride, size_t begin, size_t end)
+{
+    size_t count = in.size();
+    for (size_t i = begin; i < end; i++)
+    {
+        float x = in.x[i], y = in.y[i], z = in.z[i];
+        float rx = 0.0f, ry = 0.0f, rz = 0.0f;
+        for (int k = 0; k < influences; k++)
+        {
+            float w = weights[k * count + i];
+            if (w == 0.0f)
+                continue;
+            const float *m = palette + joints[k * count + i] * 12;
+            rx += w * (m[0] * x + m[1] * y + m[2] * z + m[3]);
+            ry += w * (m[4] * x + m[5] * y + m[6] * z + m[7]);
+            rz += w * (m[8] * x + m[9] * y + m[10] * z + m[11]);
+        }
+        float *o = out + i * stride;
+        o[0] = rx;
+        o[1] = ry;
+        o[2] = rz;
+    }
+}
+
+//***********************************************************************************************************
+// AVX2, 8 lanes per iteration; returns how many elements were processed
+
+#if defined(MATH_HAS_AVX2)
+
+MATH_TARGET_AVX2 static size_t TransformPointsAVX2(const float *m, const float *ix, const float *iy, const float *iz,
+                                                   float *ox, float *oy, float *oz, size_t count)
+{
+    __m256 m0 = _mm256_set1_ps(m[0]), m1 = _mm256_set1_ps(m[1]), m2 = _mm256_set1_ps(m[2]);
+    __m256 m3 = _mm256_set1_ps(m[3]), m4 = _mm256_set1_ps(m[4]), m5 = _mm256_set1_ps(m[5]);
+    __m256 m6 = _mm256_set1_ps(m[6]), m7 = _mm256_set1_ps(m[7]), m8 = _mm256_set1_ps(m[8]);
+    __m256 t0 = _mm256_set1_ps(m[9]), t1 = _mm256_set1_ps(m[10]), t2 = _mm256_set1_ps(m[11]);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(ix + i);
+        __m256 y = _mm256_loadu_ps(iy + i);
+        __m256 z = _mm256_loadu_ps(iz + i);
+        __m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m0, x), _mm256_mul_ps(m3, y)), _mm256_mul_ps(m6, z)), t0);
+        __m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m1, x), _mm256_mul_ps(m4, y)), _mm256_mul_ps(m7, z)), t1);
+        __m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m2, x), _mm256_mul_ps(m5, y)), _mm256_mul_ps(m8, z)), t2);
+        _mm256_storeu_ps(ox + i, rx);
+        _mm256_storeu_ps(oy + i, ry);
+        _mm256_storeu_ps(oz + i, rz);
+    }
+    return i;
+}
+
+MATH_TARGET_AVX2 static size_t TransformNormalsAVX2(const float *n, const float *ix, const float *iy, const float *iz,
+                                                    float *ox, float *oy, float *oz, size_t count)
+{
+    __m256 n0 = _mm256_set1_ps(n[0]), n1 = _mm256_set1_ps(n[1]), n2 = _mm256_set1_ps(n[2]);
+    __m256 n3 = _mm256_set1_ps(n[3]), n4 = _mm256_set1_ps(n[4]), n5 = _mm256_set1_ps(n[5]);
+    __m256 n6 = _mm256_set1_ps(n[6]), n7 = _mm256_set1_ps(n[7]), n8 = _mm256_set1_ps(n[8]);
+    __m256 eps2 = _mm256_set1_ps(Vec3::EPSILON * Vec3::EPSILON);
+    __m256 one = _mm256_set1_ps(1.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(ix + i);
+        __m256 y = _mm256_loadu_ps(iy + i);
+        __m256 z = _mm256_loadu_ps(iz + i);
+        __m256 rx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(n0, x), _mm256_mul_ps(n3, y)), _mm256_mul_ps(n6, z));
+        __m256 ry = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(n1, x), _mm256_mul_ps(n4, y)), _mm256_mul_ps(n7, z));
+        __m256 rz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(n2, x), _mm256_mul_ps(n5, y)), _mm256_mul_ps(n8, z));
+        __m256 len2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(rx, rx), _mm256_mul_ps(ry, ry)), _mm256_mul_ps(rz, rz));
+        __m256 inv = _mm256_div_ps(one, _mm256_sqrt_ps(len2));
+        inv = _mm256_blendv_ps(one, inv, _mm256_cmp_ps(len2, eps2, _CMP_GT_OQ));
+        _mm256_storeu_ps(ox + i, _mm256_mul_ps(rx, inv));
+        _mm256_storeu_ps(oy + i, _mm256_mul_ps(ry, inv));
+        _mm256_storeu_ps(oz + i, _mm256_mul_ps(rz, inv));
+    }
+    return i;
+}
+
+MATH_TARGET_AVX2 static size_t MultiplyQuatsAVX2(const QuatStream &a, const QuatStream &b, QuatStream &out, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 aw = _mm256_loadu_ps(&a.w[i]), ax = _mm256_loadu_ps(&a.x[i]);
+        __m256 ay = _mm256_loadu_ps(&a.y[i]), az = _mm256_loadu_ps(&a.z[i]);
+        __m256 bw = _mm256_loadu_ps(&b.w[i]), bx = _mm256_loadu_ps(&b.x[i]);
+        __m256 by = _mm256_loadu_ps(&b.y[i]), bz = _mm256_loadu_ps(&b.z[i]);
+
+        __m256 w = _mm256_sub_ps(_mm256_sub_ps(_mm256_sub_ps(_mm256_mul_ps(aw, bw), _mm256_mul_ps(ax, bx)), _mm256_mul_ps(ay, by)), _mm256_mul_ps(az, bz));
+        __m256 x = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(aw, bx), _mm256_mul_ps(ax, bw)), _mm256_mul_ps(ay, bz)), _mm256_mul_ps(az, by));
+        __m256 y = _mm256_add_ps(_mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(aw, by), _mm256_mul_ps(ax, bz)), _mm256_mul_ps(ay, bw)), _mm256_mul_ps(az, bx));
+        __m256 z = _mm256_add_ps(_mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(aw, bz), _mm256_mul_ps(ax, by)), _mm256_mul_ps(ay, bx)), _mm256_mul_ps(az, bw));
+
+        _mm256_storeu_ps(&out.w[i], w);
+        _mm256_storeu_ps(&out.x[i], x);
+        _mm256_storeu_ps(&out.y[i], y);
+        _mm256_storeu_ps(&out.z[i], z);
+    }
+    return i;
+}
+
+MATH_TARGET_AVX2 static size_t NlerpQuatsAVX2(const QuatStream &a, const QuatStream &b, float t, QuatStream &out, size_t count)
+{
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 vt = _mm256_set1_ps(t);
+    const __m256 vta = _mm256_set1_ps(1.0f - t);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 aw = _mm256_loadu_ps(&a.w[i]), ax = _mm256_loadu_ps(&a.x[i]);
+        __m256 ay = _mm256_loadu_ps(&a.y[i]), az = _mm256_loadu_ps(&a.z[i]);
+        __m256 bw = _mm256_loadu_ps(&b.w[i]), bx = _mm256_loadu_ps(&b.x[i]);
+        __m256 by = _mm256_loadu_ps(&b.y[i]), bz = _mm256_loadu_ps(&b.z[i]);
+
+        // Flip t for b where the quaternions are in opposite hemispheres
+        __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(aw, bw), _mm256_mul_ps(ax, bx)), _mm256_mul_ps(ay, by)), _mm256_mul_ps(az, bz));
+        __m256 tb = _mm256_xor_ps(vt, _mm256_and_ps(_mm256_cmp_ps(d, zero, _CMP_LT_OQ), signMask));
+
+        __m256 w = _mm256_add_ps(_mm256_mul_ps(aw, vta), _mm256_mul_ps(bw, tb));
+        __m256 x = _mm256_add_ps(_mm256_mul_ps(ax, vta), _mm256_mul_ps(bx, tb));
+        __m256 y = _mm256_add_ps(_mm256_mul_ps(ay, vta), _mm256_mul_ps(by, tb));
+        __m256 z = _mm256_add_ps(_mm256_mul_ps(az, vta), _mm256_mul_ps(bz, tb));
+
+        __m256 len2 = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(w, w), _mm256_mul_ps(x, x)), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+        __m256 inv = _mm256_div_ps(one, _mm256_sqrt_ps(len2));
+        inv = _mm256_blendv_ps(one, inv, _mm256_cmp_ps(len2, zero, _CMP_GT_OQ));
+
+        _mm256_storeu_ps(&out.w[i], _mm256_mul_ps(w, inv));
+        _mm256_storeu_ps(&out.x[i], _mm256_mul_ps(x, inv));
+        _mm256_storeu_ps(&out.y[i], _mm256_mul_ps(y, inv));
+        _mm256_storeu_ps(&out.z[i], _mm256_mul_ps(z, inv));
+    }
+    return i;
+}
+
+MATH_TARGET_AVX2 static size_t LengthsAVX2(const Vec3Stream &in, float *out, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(&in.x[i]);
+        __m256 y = _mm256_loadu_ps(&in.y[i]);
+        __m256 z = _mm256_loadu_ps(&in.z[i]);
+        __m256 len2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z));
+        _mm256_storeu_ps(out + i, _mm256_sqrt_ps(len2));
+    }
+    return i;
+}
+
+MATH_TARGET_AVX2 static size_t NormalizeAVX2(const Vec3Stream &in, Vec3Stream &out, size_t count)
+{
+    const __m256 eps = _mm256_set1_ps(Vec3::EPSILON);
+    const __m256 one = _mm256_set1_ps(1.0f);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(&in.x[i]);
+        __m256 y = _mm256_loadu_ps(&in.y[i]);
+        __m256 z = _mm256_loadu_ps(&in.z[i]);
+        __m256 len = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), _mm256_mul_ps(z, z)));
+        __m256 inv = _mm256_blendv_ps(one, _mm256_div_ps(one, len), _mm256_cmp_ps(len, eps, _CMP_GT_OQ));
+        _mm256_storeu_ps(&out.x[i], _mm256_mul_ps(x, inv));
+        _mm256_storeu_ps(&out.y[i], _mm256_mul_ps(y, inv));
+        _mm256_storeu_ps(&out.z[i], _mm256_mul_ps(z, inv));
+    }
+    return i;
+}
+
+MATH_TARGET_AVX2 static size_t LerpFloatsAVX2(const float *a, const float *b, float t, float *out, size_t count)
+{
+    const __m256 vt = _mm256_set1_ps(t);
+    const __m256 vta = _mm256_set1_ps(1.0f - t);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 va = _mm256_loadu_ps(a + i);
+        __m256 vb = _mm256_loadu_ps(b + i);
+        _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(va, vta), _mm256_mul_ps(vb, vt)));
+    }
+    return i;
+}
+
+MATH_TARGET_AVX2 static size_t DequantizeLerpAVX2(const uint16_t *a, const uint16_t *b, const float *offset, const float *scale,
+                                                  float t, float *out, size_t count)
+{
+    const __m256 vt = _mm256_set1_ps(t);
+    const __m256 vta = _mm256_set1_ps(1.0f - t);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        // 8 x u16 -> 8 x i32 -> 8 x float
+        __m256 qa = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(a + i))));
+        __m256 qb = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(b + i))));
+        __m256 q = _mm256_add_ps(_mm256_mul_ps(qa, vta), _mm256_mul_ps(qb, vt));
+        __m256 r = _mm256_add_ps(_mm256_loadu_ps(offset + i), _mm256_mul_ps(_mm256_loadu_ps(scale + i), q));
+        _mm256_storeu_ps(out + i, r);
+    }
+    return i;
+}
+
+MATH_TARGET_AVX2 static size_t EvaluateCubicsAVX2(const float *coefficients, size_t stride, float t, float *out, size_t count)
+{
+    const __m256 vt = _mm256_set1_ps(t);
+    const float *c0 = coefficients;
+    const float *c1 = c0 + stride;
+    const float *c2 = c1 + stride;
+    const float *c3 = c2 + stride;
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 r = _mm256_loadu_ps(c0 + i);
+        r = _mm256_add_ps(_mm256_mul_ps(r, vt), _mm256_loadu_ps(c1 + i));
+        r = _mm256_add_ps(_mm256_mul_ps(r, vt), _mm256_loadu_ps(c2 + i));
+        r = _mm256_add_ps(_mm256_mul_ps(r, vt), _mm256_loadu_ps(c3 + i));
+        _mm256_storeu_ps(out + i, r);
+    }
+    return i;
+}
+
+// The lanes may use different joints, in which case the matrices are gathered per lane.
+// Like the scalar loop, influences with a zero weight are skipped: their joint index is never
+// read from the palette (unused slots may hold any value) and they add nothing to the result.
+MATH_TARGET_AVX2 static size_t SkinPointsAVX2(const float *palette, const Vec3Stream &in, const int32_t *joints, const float *weights,
+                                              int influences, float *out, size_t stride, size_t count)
+{
+    const __m256i twelve = _mm256_set1_epi32(12);
+    const __m256 zero = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 x = _mm256_loadu_ps(&in.x[i]);
+        __m256 y = _mm256_loadu_ps(&in.y[i]);
+        __m256 z = _mm256_loadu_ps(&in.z[i]);
+        __m256 rx = zero, ry = zero, rz = zero;
+
+        for (int k = 0; k < influences; k++)
+        {
+            __m256 w = _mm256_loadu_ps(weights + k * count + i);
+            __m256 active = _mm256_cmp_ps(w, zero, _CMP_NEQ_UQ);
+            int activeBits = _mm256_movemask_ps(active);
+            if (activeBits == 0)
+                continue;
+            __m256i joint = _mm256_loadu_si256((const __m256i *)(joints + k * count + i));
+
+            // All active lanes on one joint (parts of a rigid mesh): broadcast instead of gathering
+            __m256 r[12];
+            int lane = 0;
+            while (!(activeBits & (1 << lane)))
+                lane++;
+            const int32_t first = joints[k * count + i + lane];
+            __m256i same = _mm256_cmpeq_epi32(joint, _mm256_set1_epi32(first));
+            if ((_mm256_movemask_ps(_mm256_castsi256_ps(same)) & activeBits) == activeBits)
+            {
+                const float *m = palette + first * 12;
+                for (int e = 0; e < 12; e++)
+                    r[e] = _mm256_set1_ps(m[e]);
+            }
+            else
+            {
+                __m256i base = _mm256_mullo_epi32(joint, twelve);
+                for (int e = 0; e < 12; e++)
+                    r[e] = _mm256_mask_i32gather_ps(zero, palette + e, base, active, 4);
+            }
+
+            __m256 px = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[0], x), _mm256_mul_ps(r[1], y)), _mm256_add_ps(_mm256_mul_ps(r[2], z), r[3]));
+            __m256 py = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[4], x), _mm256_mul_ps(r[5], y)), _mm256_add_ps(_mm256_mul_ps(r[6], z), r[7]));
+            __m256 pz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r[8], x), _mm256_mul_ps(r[9], y)), _mm256_add_ps(_mm256_mul_ps(r[10], z), r[11]));
+            // Masked so a skipped lane adds exactly nothing, even with Inf/NaN inputs
+            rx = _mm256_add_ps(rx, _mm256_and_ps(active, _mm256_mul_ps(w, px)));
+            ry = _mm256_add_ps(ry, _mm256_and_ps(active, _mm256_mul_ps(w, py)));
+            rz = _mm256_add_ps(rz, _mm256_and_ps(active, _mm256_mul_ps(w, pz)));
+        }
+
+        // SoA -> vertices interleaved with the caller's stride
+        alignas(32) float bx[8], by[8], bz[8];
+        _mm256_store_ps(bx, rx);
+        _mm256_store_ps(by, ry);
+        _mm256_store_ps(bz, rz);
+        float *o = out + i * stride;
+        for (int lane = 0; lane < 8; lane++, o += stride)
+        {
+            o[0] = bx[lane];
+            o[1] = by[lane];
+            o[2] = bz[lane];
+        }
+    }
+    return i;
+}
+
+#endif
+
+//***********************************************************************************************************
+
+void TransformPoints(const Affine3x4 &m, const Vec3Stream &in, Vec3Stream &out)
+{
+    size_t count = in.size();
+    out.resize(count);
+    size_t done = 0;
+#if defined(MATH_HAS_AVX2)
+    if (UseAVX2())
+        done = TransformPointsAVX2(m.m, in.x.data(), in.y.data(), in.z.data(), out.x.data(), out.y.data(), out.z.data(), count);
+#endif
+    TransformPointsScalar(m.m, in.x.data(), in.y.data(), in.z.data(), out.x.data(), out.y.data(), out.z.data(), done, count);
+}
+
+void TransformNormals(const Affine3x4 &m, const Vec3Stream &in, Vec3Stream &out)
+{
+    // Inverse-transpose of the 3x3 part: its columns are the cross products of the
+    // original columns divided by the determinant.
+    Vec3 c0(m.m[0], m.m[1], m.m[2]);
+    Vec3 c1(m.m[3], m.m[4], m.m[5]);
+    Vec3 c2(m.m[6], m.m[7], m.m[8]);
+    Vec3 n0 = c1.cross(c2);
+    Vec3 n1 = c2.cross(c0);
+    Vec3 n2 = c0.cross(c1);
+    float det = c0.dot(n0);
+    float invDet = (std::fabs(det) > Vec3::EPSILON) ? 1.0f / det : 1.0f;
+    float n[9] = {n0.x * invDet, n0.y * invDet, n0.z * invDet,
+                  n1.x * invDet, n1.y * invDet, n1.z * invDet,
+                  n2.x * invDet, n2.y * invDet, n2.z * invDet};
+    if (std::fabs(det) <= Vec3::EPSILON)
+    {
+        for (int i = 0; i < 9; i++)
+            n[i] = m.m[i];
+    }
+
+    size_t count = in.size();
+    out.resize(count);
+    size_t done = 0;
+#if defined(MATH_HAS_AVX2)
+    if (UseAVX2())
+        done = TransformNormalsAVX2(n, in.x.data(), in.y.data(), in.z.data(), out.x.data(), out.y.data(), out.z.data(), count);
+#endif
+    TransformNormalsScalar(n, in.x.data(), in.y.data(), in.z.data(), out.x.data(), out.y.data(), out.z.data(), done, count);
+}
+
+void MultiplyQuats(const QuatStream &a, const QuatStream &b, QuatStream &out)
+{
+    size_t count = Min(a.size(), b.size());
+    out.resize(count);
+    size_t done = 0;
+#if defined(MATH_HAS_AVX2)
+    if (UseAVX2())
+        done = MultiplyQuatsAVX2(a, b, out, count);
+#endif
+    MultiplyQuatsScalar(a, b, out, done, count);
+}
+
+void NlerpQuats(const QuatStream &a, const QuatStream &b, float t, QuatStream &out)
+{
+    size_t count = Min(a.size(), b.size());
+    out.resize(count);
+    size_t done = 0;
+#if defined(MATH_HAS_AVX2)
+    if (UseAVX2())
+        done = NlerpQuatsAVX2(a, b, t, out, count);
+#endif
+    NlerpQuatsScalar(a, b, t, out, done, count);
+}
+
+void Lengths(const Vec3Stream &in, std::vector<float> &out)
+{
+    size_t count = in.size();
+    out.resize(count);
+    size_t done = 0;
+#if defined(MATH_HAS_AVX2)
+    if (UseAVX2())
+        done = LengthsAVX2(in, out.data(), count);
+#endif
+    LengthsScalar(in, out.data(), done, count);
+}
+
+void Normalize(const Vec3Stream &in, Vec3Stream &out)
+{
+    size_t count = in.size();
+    out.resize(count);
+    size_t done = 0;
+#if defined(MATH_HAS_AVX2)
+    if (UseAVX2())
+        done = NormalizeAVX2(in, out, count);
+#endif
+    NormalizeScalar(in, out, done, count);
+}
+
+void LerpFloats(const float *a, const float *b, float t, float *out, size_t count)
+{
+    size_t done = 0;
+#if defined(MATH_HAS_AVX2)
+    if (UseAVX2())
+        done = LerpFloatsAVX2(a, b, t, out, count);
+#endif
+    LerpFloatsScalar(a, b, t, out, done, count);
+}
+
+void DequantizeLerp(const uint16_t *a, const uint16_t *b, const float *offset, const float *scale,
+                    float t, float *out, size_t count)
+{
+    size_t done = 0;
+#if defined(MATH_HAS_AVX2)
+    if (UseAVX2())
+        done = DequantizeLerpAVX2(a, b, offset, scale, t, out, count);
+#endif
+    DequantizeLerpScalar(a, b, offset, scale, t, out, done, count);
+}
+
+void EvaluateCubics(const float *coefficients, size_t stride, float t, float *out, size_t count)
+{
+    size_t done = 0;
+#if defined(MATH_HAS_AVX2)
+    if (UseAVX2())
+        done = EvaluateCubicsAVX2(coefficients, stride, t, out, count);
+#endif
+    EvaluateCubicsScalar(coefficients, stride, t, out, done, count);
+}
+
+void SkinPoints(const float *palette, const Vec3Stream &in, const int32_t *joints, const float *weights,
+                int influences, float *out, size_t stride)
+{
+    size_t count = in.size();
+    size_t done = 0;
+#if defined(MATH_HAS_AVX2)
+    if (UseAVX2())
+        done = SkinPointsAVX2(palette, in, joints, weights, influences, out, stride, count);
+#endif
+    SkinPointsScalar(palette, in, joints, weights, influences, out, stride, done, count);
+}
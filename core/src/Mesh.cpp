@@ -122,6 +122,94 @@ void MeshBuffer::SetVertexData(const void *vertexData)
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
+void MeshBuffer::SetVertexData(const void *vertexData, unsigned int vertexCount)
+{
+    if (vertexCount == 0)
+        return;
+    if (vertexCount > (unsigned int)m_numVertices)
+        vertexCount = m_numVertices;
+
+    unsigned int size = m_vertexFormat.getVertexSize();
+    glBindBuffer(GL_ARRAY_BUFFER, this->m_vbo);
+    if (m_dynamic)
+    {
+        glBufferData(GL_ARRAY_BUFFER, size * m_numVertices, NULL, GL_DYNAMIC_DRAW);
+    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size * vertexCount, vertexData);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void MeshBuffer::CreateInstanceBuffer(const VertexFormat &instanceFormat, unsigned int instanceCount, unsigned int divisor)
+{
+    m_instanceFormat = instanceFormat;
+    m_instanceCapacity = instanceCount;
+    glGenBuffers(1, &this->m_instanceVbo);
+    glBindBuffer(GL_ARRAY_BUFFER, this->m_instanceVbo);
+    glBufferData(GL_ARRAY_BUFFER, instanceFormat.getVertexSize() * instanceCount, NULL, GL_STREAM_DRAW);
+
+    if (!m_vao)
+    {
+        glGenVertexArrays(1, &m_vao);
+        glBindVertexArray(m_vao);
+    }
+    else
+    {
+        glBindVertexArray(m_vao);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, this->m_instanceVbo);
+
+    unsigned int location = m_vertexFormat.getElementCount();
+    unsigned int offset = 0;
+    for (unsigned int i = 0; i < instanceFormat.getElementCount(); ++i)
+    {
+        const VertexFormat::Element &element = instanceFormat.getElement(i);
+
+        for (unsigned int column = 0; column < element.size; column += 4)
+        {
+            unsigned int size = element.size - column < 4 ? element.size - column : 4;
+            glEnableVertexAttribArray(location);
+            glVertexAttribPointer(location, (GLint)size, GL_FLOAT, GL_FALSE, (GLsizei)instanceFormat.getVertexSize(), (void *)((offset + column) * sizeof(float)));
+            glVertexAttribDivisor(location, divisor);
+            location++;
+        }
+
+        offset += element.size;
+    }
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void MeshBuffer::SetInstanceData(const void *instanceData, unsigned int instanceCount)
+{
+    if (instanceCount == 0)
+        return;
+
+    unsigned int size = m_instanceFormat.getVertexSize();
+    glBindBuffer(GL_ARRAY_BUFFER, this->m_instanceVbo);
+    if (instanceCount > m_instanceCapacity)
+    {
+        m_instanceCapacity = instanceCount;
+    }
+    // Orphan: the driver hands out fresh storage instead of waiting for last frame's draw
+    glBufferData(GL_ARRAY_BUFFER, size * m_instanceCapacity, NULL, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size * instanceCount, instanceData);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void MeshBuffer::RenderInstanced(int mode, int count, int instanceCount)
+{
+    glBindVertexArray(m_vao);
+    if (m_useIndices)
+    {
+        glDrawElementsInstanced(mode, count, GL_UNSIGNED_INT, 0, instanceCount);
+    }
+    else
+    {
+        glDrawArraysInstanced(mode, 0, count, instanceCount);
+    }
+}
+
 void MeshBuffer::Render(int mode, int count)
 {
 
@@ -156,6 +244,63 @@ void MeshBuffer::Release()
         glDeleteBuffers(1, &m_vbo);
     }
 
+    if (m_instanceVbo != 0)
+    {
+        glDeleteBuffers(1, &m_instanceVbo);
+    }
+
+    m_vao = 0;
     m_vbo = 0;
     m_ibo = 0;
-}
\ No newline at end of file
+    m_instanceVbo = 0;
+    m_instanceCapacity = 0;
+}
+
+//***********************************************************************************************************
+
+ShaderBuffer::ShaderBuffer(BufferTarget target) : m_target(target) {}
+
+ShaderBuffer::~ShaderBuffer()
+{
+    Release();
+}
+
+void ShaderBuffer::Create(size_t size)
+{
+    if (!m_buffer)
+        glGenBuffers(1, &m_buffer);
+    m_size = size;
+    glBindBuffer((GLenum)m_target, m_buffer);
+    glBufferData((GLenum)m_target, (GLsizeiptr)size, NULL, GL_STREAM_DRAW);
+    glBindBuffer((GLenum)m_target, 0);
+}
+
+void ShaderBuffer::SetData(const void *data, size_t size)
+{
+    if (size == 0)
+        return;
+    if (!m_buffer || size > m_size)
+        Create(size);
+
+    glBindBuffer((GLenum)m_target, m_buffer);
+    // Orphan: last frame's draw may still be reading the old storage
+    glBufferData((GLenum)m_target, (GLsizeiptr)m_size, NULL, GL_STREAM_DRAW);
+    glBufferSubData((GLenum)m_target, 0, (GLsizeiptr)size, data);
+    glBindBuffer((GLenum)m_target, 0);
+}
+
+void ShaderBuffer::Bind(unsigned int binding) const
+{
+    glBindBufferBase((GLenum)m_target, binding, m_buffer);
+}
+
+void ShaderBuffer::Release()
+{
+    if (m_buffer != 0)
+    {
+        glDeleteBuffers(1, &m_buffer);
+    }
+    m_buffer = 0;
+    m_size = 0;
+}
+
@@ -1,6 +1,26 @@
 
 #include "Shader.hpp"
+#include "File.hpp"
+#include <cassert>
 extern char* LoadTextFile(const char* fileName);
+extern bool FileExists(const char *fileName);
+
+static const int PROGRAM_BINARY_MAGIC = 0x42504748; // "HGPB"
+static const int PROGRAM_BINARY_VERSION = 1;
+
+std::string Shader::s_binaryCacheDirectory;
+Shader::BuildStats Shader::s_buildStats;
+
+static u32 HashUniformName(const char *name, size_t length)
+{
+    u32 hash = 2166136261u;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= (u8)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
 
 
 Shader::Shader()
@@ -8,6 +28,13 @@ Shader::Shader()
     m_program=0;
     m_numAttributes=0;
     m_numUniforms=0;
+    m_directState=false;
+    m_frameBlock=false;
+    m_pending=false;
+    m_stages[0]=m_stages[1]=m_stages[2]=0;
+    m_cacheKey=0;
+    m_buildTicks=0;
+    success=0;
 
 }
 
@@ -23,96 +50,312 @@ void Shader::Use() const
 
 void Shader::Release()
 {
+    for (u32 &stage : m_stages)
+    {
+        if (stage)
+            glDeleteShader(stage);
+        stage = 0;
+    }
+    m_pending=false;
     if (m_program>0)
     {
         LogInfo( "SHADER: [ID %i] Release shader program.", m_program);
         glDeleteProgram(m_program);
     }
     m_program=0;
+    m_uniforms.clear();
+    m_missingUniforms.clear();
+    m_frameBlock=false;
 }
 
 bool Shader::Create(const char* vShaderCode, const char* fShaderCode, const char* gShaderCode)
 {
-    // 2. compile shaders
-    unsigned int vertex, fragment, geometry;
-    
-    // vertex shader
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    checkCompileErrors(vertex, "VERTEX");
-    
-    // fragment Shader
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    checkCompileErrors(fragment, "FRAGMENT");
-    
-    // geometry shader
-    geometry = glCreateShader(GL_GEOMETRY_SHADER);
-    glShaderSource(geometry, 1, &gShaderCode, NULL);
-    glCompileShader(geometry);
-    checkCompileErrors(geometry, "GEOMETRY");
-    
-    // shader Program
-    m_program = glCreateProgram();
-    glAttachShader(m_program, vertex);
-    glAttachShader(m_program, fragment);
-    glAttachShader(m_program, geometry);
-    glLinkProgram(m_program);
-    checkCompileErrors(m_program, "PROGRAM");
-    
-    if (m_program>0)
-        LogInfo("SHADER: [ID %i] Create shader program.", m_program);
-    
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
-    glDeleteShader(geometry);
+    Submit(vShaderCode, fShaderCode, gShaderCode);
+    bool result = Finish();
     glUseProgram(m_program);
-    
-    return true;
-
-
+    return result;
 }
 
 
 bool Shader::Create(const char *vShaderCode, const char *fShaderCode)
 {
-     // 2. compile shaders
-    unsigned int vertex, fragment;
+    return Create(vShaderCode, fShaderCode, nullptr);
+}
+
+bool Shader::Submit(const char *vShaderCode, const char *fShaderCode, const char *gShaderCode)
+{
+    Release();
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    // Same sources on the same driver: reuse the linked program from the last run
+    m_cachePath.clear();
+    m_cacheKey = 0;
+    if (!s_binaryCacheDirectory.empty())
+    {
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        if (formats > 0)
+        {
+            m_cacheKey = hashProgramSources(vShaderCode, fShaderCode, gShaderCode);
+            char name[32];
+            snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)m_cacheKey);
+            m_cachePath = s_binaryCacheDirectory + "/" + name;
+            if (loadBinary(m_cachePath, m_cacheKey))
+            {
+                double ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency();
+                s_buildStats.cached++;
+                s_buildStats.cacheMs += ms;
+                LogInfo("SHADER: [ID %i] Load shader program from cache in %.2f ms.", m_program, ms);
+                return true;
+            }
+        }
+    }
+
+    // 2. compile shaders: no status query here, so the driver can keep compiling in the background
+    m_stages[0] = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(m_stages[0], 1, &vShaderCode, NULL);
+    glCompileShader(m_stages[0]);
+
+    m_stages[1] = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(m_stages[1], 1, &fShaderCode, NULL);
+    glCompileShader(m_stages[1]);
+
+    m_stages[2] = 0;
+    if (gShaderCode)
+    {
+        m_stages[2] = glCreateShader(GL_GEOMETRY_SHADER);
+        glShaderSource(m_stages[2], 1, &gShaderCode, NULL);
+        glCompileShader(m_stages[2]);
+    }
 
-    
-    // vertex shader
-    vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
-    glCompileShader(vertex);
-    checkCompileErrors(vertex, "VERTEX");
-    
-    // fragment Shader
-    fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
-    glCompileShader(fragment);
-    checkCompileErrors(fragment, "FRAGMENT");
-    
     // shader Program
     m_program = glCreateProgram();
-    glAttachShader(m_program, vertex);
-    glAttachShader(m_program, fragment);
+    for (u32 stage : m_stages)
+    {
+        if (stage)
+            glAttachShader(m_program, stage);
+    }
+    if (!m_cachePath.empty())
+        glProgramParameteri(m_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(m_program);
+    m_pending = true;
+    m_buildTicks = SDL_GetPerformanceCounter() - start;
+    return true;
+}
+
+bool Shader::IsReady() const
+{
+    if (!m_pending)
+        return true;
+    // Without the extension any status query blocks until the link is done, so Finish() may as well do it
+    if (!ParallelCompileSupported())
+        return true;
+    GLint done = GL_FALSE;
+    glGetProgramiv(m_program, GL_COMPLETION_STATUS_KHR, &done);
+    return done == GL_TRUE;
+}
+
+bool Shader::Finish()
+{
+    if (!m_pending)
+        return success;
+    m_pending = false;
+    Uint64 start = SDL_GetPerformanceCounter();
+
+    checkCompileErrors(m_stages[0], "VERTEX");
+    checkCompileErrors(m_stages[1], "FRAGMENT");
+    if (m_stages[2])
+        checkCompileErrors(m_stages[2], "GEOMETRY");
     checkCompileErrors(m_program, "PROGRAM");
+    buildUniformTable();
+    bindFrameBlock();
+
+    for (u32 &stage : m_stages)
+    {
+        if (stage)
+            glDeleteShader(stage);
+        stage = 0;
+    }
 
+    if (success && !m_cachePath.empty())
+        saveBinary(m_cachePath, m_cacheKey);
+
+    // Time spent blocked in Submit() and Finish(); while queued the driver compiles in the background
+    m_buildTicks += SDL_GetPerformanceCounter() - start;
+    double ms = m_buildTicks * 1000.0 / SDL_GetPerformanceFrequency();
+    if (success)
+        s_buildStats.compiled++;
+    else
+        s_buildStats.failed++;
+    s_buildStats.compileMs += ms;
     if (m_program>0)
     {
 
-        LogInfo( "SHADER: [ID %i] Create shader program.", m_program);
+        LogInfo( "SHADER: [ID %i] Create shader program in %.2f ms.", m_program, ms);
     } 
-    glDeleteShader(vertex);
-    glDeleteShader(fragment);
-    glUseProgram(m_program); 
     
     return success;
 }
 
+bool Shader::ParallelCompileSupported()
+{
+    static int supported = -1;
+    if (supported < 0)
+        supported = (SDL_GL_ExtensionSupported("GL_KHR_parallel_shader_compile") || SDL_GL_ExtensionSupported("GL_ARB_parallel_shader_compile")) ? 1 : 0;
+    return supported == 1;
+}
+
+bool Shader::SetCompilerThreads(u32 count)
+{
+    if (!ParallelCompileSupported())
+        return false;
+
+    typedef void (APIENTRY *MaxShaderCompilerThreadsProc)(GLuint count);
+    MaxShaderCompilerThreadsProc maxThreads = (MaxShaderCompilerThreadsProc)SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsKHR");
+    if (!maxThreads)
+        maxThreads = (MaxShaderCompilerThreadsProc)SDL_GL_GetProcAddress("glMaxShaderCompilerThreadsARB");
+    if (!maxThreads)
+        return false;
+    maxThreads(count);
+    return true;
+}
+
+u64 Shader::hashProgramSources(const char *vShaderCode, const char *fShaderCode, const char *gShaderCode)
+{
+    // FNV-1a over the driver strings and every stage; a driver update gives new keys
+    u64 hash = 14695981039346656037ull;
+    auto mix = [&hash](const char *text)
+    {
+        if (text)
+        {
+            for (const char *c = text; *c; c++)
+            {
+                hash ^= (u8)*c;
+                hash *= 1099511628211ull;
+            }
+        }
+        // Separator, so that moving text from one stage to the next changes the key
+        hash ^= 0xff;
+        hash *= 1099511628211ull;
+    };
+    mix((const char *)glGetString(GL_VENDOR));
+    mix((const char *)glGetString(GL_RENDERER));
+    mix((const char *)glGetString(GL_VERSION));
+    mix(vShaderCode);
+    mix(fShaderCode);
+    mix(gShaderCode);
+    return hash;
+}
+
+bool Shader::loadBinary(const std::string &path, u64 key)
+{
+    if (!FileExists(path.c_str()))
+        return false;
+
+    FileStream file;
+    if (!file.Open(path, "rb"))
+        return false;
+
+    u64 storedKey = 0;
+    bool valid = file.ReadInt() == PROGRAM_BINARY_MAGIC && file.ReadInt() == PROGRAM_BINARY_VERSION;
+    valid = valid && file.Read(&storedKey, sizeof(storedKey)) == sizeof(storedKey) && storedKey == key;
+    GLenum format = valid ? (GLenum)file.ReadInt() : 0;
+    int length = valid ? file.ReadInt() : 0;
+    valid = valid && length > 0 && (u64)length <= file.Size() - file.Cursor();
+
+    std::vector<char> binary;
+    if (valid)
+    {
+        binary.resize(length);
+        valid = file.Read(binary.data(), length) == (u64)length;
+    }
+    file.Close();
+    if (!valid)
+    {
+        LogWarning("SHADER: Ignoring invalid program binary %s", path.c_str());
+        return false;
+    }
+
+    // Only hand the driver a format it still lists (glProgramBinary would raise GL_INVALID_ENUM)
+    GLint formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    std::vector<GLint> formats(formatCount);
+    glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+    bool known = false;
+    for (GLint f : formats)
+        known = known || (GLenum)f == format;
+
+    if (known)
+    {
+        m_program = glCreateProgram();
+        glProgramBinary(m_program, format, binary.data(), length);
+        glGetProgramiv(m_program, GL_LINK_STATUS, &success);
+    }
+    if (!known || !success)
+    {
+        // Driver changed in a way the key does not see; compile from source and overwrite the file
+        LogWarning("SHADER: Program binary %s rejected by the driver, compiling from source", path.c_str());
+        if (m_program)
+            glDeleteProgram(m_program);
+        m_program = 0;
+        success = 0;
+        s_buildStats.rejected++;
+        return false;
+    }
+
+    buildUniformTable();
+    bindFrameBlock();
+    return true;
+}
+
+void Shader::saveBinary(const std::string &path, u64 key)
+{
+    GLint length = 0;
+    glGetProgramiv(m_program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+    {
+        LogWarning("SHADER: [ID %i] Driver returned no program binary, not cached", m_program);
+        return;
+    }
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(m_program, length, &length, &format, binary.data());
+
+    FileStream file;
+    if (!file.Create(path, true))
+    {
+        LogWarning("SHADER: Cannot write program binary %s", path.c_str());
+        return;
+    }
+    file.WriteInt(PROGRAM_BINARY_MAGIC);
+    file.WriteInt(PROGRAM_BINARY_VERSION);
+    file.Write(&key, sizeof(key));
+    file.WriteInt((int)format);
+    file.WriteInt(length);
+    file.Write(binary.data(), length);
+    file.Close();
+}
+
+void Shader::SetBinaryCache(const std::string &directory)
+{
+    s_binaryCacheDirectory = directory;
+    while (!s_binaryCacheDirectory.empty() && (s_binaryCacheDirectory.back() == '/' || s_binaryCacheDirectory.back() == '\\'))
+        s_binaryCacheDirectory.pop_back();
+    if (!s_binaryCacheDirectory.empty() && !SDL_CreateDirectory(s_binaryCacheDirectory.c_str()))
+    {
+        LogWarning("SHADER: Cannot create program cache %s, compiling from source", s_binaryCacheDirectory.c_str());
+        s_binaryCacheDirectory.clear();
+    }
+}
+
+void Shader::LogBuildStats()
+{
+    LogInfo("SHADER: %d program(s) compiled, %d failed (%.2f ms blocking), %d loaded from cache in %.2f ms, %d rejected binaries",
+            s_buildStats.compiled, s_buildStats.failed, s_buildStats.compileMs, s_buildStats.cached, s_buildStats.cacheMs,
+            s_buildStats.rejected);
+}
+
 bool Shader::Load(const char *vShaderCode, const char *fShaderCode)
 {
     bool result=false;
@@ -222,50 +465,232 @@ bool Shader::addAttribute(const std::string &name)
 
 
 
-void Shader::SetInt(const std::string &name, int value) 
+void Shader::buildUniformTable()
+{
+    m_uniforms.clear();
+    m_missingUniforms.clear();
+    if (!success)
+        return;
+
+    int uniformCount = 0;
+    glGetProgramiv(m_program, GL_ACTIVE_UNIFORMS, &uniformCount);
+    m_uniforms.reserve(uniformCount);
+    for (int i = 0; i < uniformCount; i++)
+    {
+        int namelen = -1;
+        int num = -1;
+        char name[256]; // Assume no variable names longer than 256
+        GLenum type = GL_ZERO;
+        glGetActiveUniform(m_program, i, sizeof(name) - 1, &namelen, &num, &type, name);
+        name[namelen] = 0;
+
+        // Members of uniform blocks have no location; they are set through the block's buffer
+        int location = glGetUniformLocation(m_program, name);
+        if (location == -1)
+            continue;
+
+        // Arrays are reported as "name[0]"; the location is the one of the first element
+        if (namelen > 3 && strcmp(name + namelen - 3, "[0]") == 0)
+        {
+            namelen -= 3;
+            name[namelen] = 0;
+        }
+
+        UniformInfo info;
+        info.hash = HashUniformName(name, (size_t)namelen);
+        info.location = location;
+        info.type = type;
+        info.size = num;
+        info.name = name;
+        m_uniforms.push_back(info);
+    }
+}
+
+void Shader::bindFrameBlock()
+{
+    m_frameBlock = false;
+    if (!success)
+        return;
+
+    GLuint block = glGetUniformBlockIndex(m_program, FRAME_BLOCK_NAME);
+    if (block == GL_INVALID_INDEX)
+        return;
+    glUniformBlockBinding(m_program, block, FRAME_UNIFORM_BINDING);
+    m_frameBlock = true;
+}
+
+int Shader::findUniformIndex(const char *name) const
+{
+    u32 hash = HashUniformName(name, strlen(name));
+    for (size_t i = 0; i < m_uniforms.size(); i++)
+    {
+        if (m_uniforms[i].hash == hash && m_uniforms[i].name == name)
+            return (int)i;
+    }
+    return -1;
+}
+
+UniformHandle Shader::GetUniformHandle(const char *name) const
+{
+    UniformHandle handle;
+    handle.index = findUniformIndex(name);
+    if (handle.index == -1)
+    {
+        u32 hash = HashUniformName(name, strlen(name));
+        for (u32 missing : m_missingUniforms)
+        {
+            if (missing == hash)
+                return handle;
+        }
+        m_missingUniforms.push_back(hash);
+        LogError( "SHADER: [ID %i] Failed to find shader uniform: %s", m_program, name);
+    }
+    return handle;
+}
+
+bool Shader::findUniform(const std::string &name) const
+{
+    return findUniformIndex(name.c_str()) != -1;
+}
+
+bool Shader::ContainsUniform(const std::string &name) const
+{
+    return findUniformIndex(name.c_str()) != -1;
+}
+
+
+void Shader::SetInt(UniformHandle handle, int value)
+{
+    if (!handle.IsValid())
+        return;
+    assert(handle.index < (int)m_uniforms.size() && "Shader: uniform handle from another program");
+    int location = m_uniforms[handle.index].location;
+    if (m_directState)
+        glProgramUniform1i(m_program, location, value);
+    else
+        glUniform1i(location, value);
+}
+
+void Shader::SetMatrix4(UniformHandle handle, const float *value)
+{
+    if (!handle.IsValid())
+        return;
+    assert(handle.index < (int)m_uniforms.size() && "Shader: uniform handle from another program");
+    int location = m_uniforms[handle.index].location;
+    if (m_directState)
+        glProgramUniformMatrix4fv(m_program, location, 1, GL_FALSE, value);
+    else
+        glUniformMatrix4fv(location, 1, GL_FALSE, value);
+}
+
+void Shader::SetMatrix3(UniformHandle handle, const float *value)
+{
+    if (!handle.IsValid())
+        return;
+    assert(handle.index < (int)m_uniforms.size() && "Shader: uniform handle from another program");
+    int location = m_uniforms[handle.index].location;
+    if (m_directState)
+        glProgramUniformMatrix3fv(m_program, location, 1, GL_FALSE, value);
+    else
+        glUniformMatrix3fv(location, 1, GL_FALSE, value);
+}
+
+void Shader::SetFloat(UniformHandle handle, float v)
+{
+    if (!handle.IsValid())
+        return;
+    assert(handle.index < (int)m_uniforms.size() && "Shader: uniform handle from another program");
+    int location = m_uniforms[handle.index].location;
+    if (m_directState)
+        glProgramUniform1f(m_program, location, v);
+    else
+        glUniform1f(location, v);
+}
+
+void Shader::SetFloat(UniformHandle handle, float x, float y)
+{
+    if (!handle.IsValid())
+        return;
+    assert(handle.index < (int)m_uniforms.size() && "Shader: uniform handle from another program");
+    int location = m_uniforms[handle.index].location;
+    if (m_directState)
+        glProgramUniform2f(m_program, location, x, y);
+    else
+        glUniform2f(location, x, y);
+}
+
+void Shader::SetFloat(UniformHandle handle, float x, float y, float z)
+{
+    if (!handle.IsValid())
+        return;
+    assert(handle.index < (int)m_uniforms.size() && "Shader: uniform handle from another program");
+    int location = m_uniforms[handle.index].location;
+    if (m_directState)
+        glProgramUniform3f(m_program, location, x, y, z);
+    else
+        glUniform3f(location, x, y, z);
+}
+
+void Shader::SetFloat(UniformHandle handle, float x, float y, float z, float w)
 {
-    int id = getUniform(name);
-    if (id != -1) glUniform1i(id, value);
+    if (!handle.IsValid())
+        return;
+    assert(handle.index < (int)m_uniforms.size() && "Shader: uniform handle from another program");
+    int location = m_uniforms[handle.index].location;
+    if (m_directState)
+        glProgramUniform4f(m_program, location, x, y, z, w);
+    else
+        glUniform4f(location, x, y, z, w);
 }
 
-void Shader::SetMatrix4(const std::string &name, const float *value)
+void Shader::SetFloat4Array(UniformHandle handle, const float *values, int count)
 {
-     int id = getUniform(name);
-    if (id != -1)
-        glUniformMatrix4fv(id, 1, GL_FALSE, value);
+    if (!handle.IsValid())
+        return;
+    assert(handle.index < (int)m_uniforms.size() && "Shader: uniform handle from another program");
+    int location = m_uniforms[handle.index].location;
+    if (m_directState)
+        glProgramUniform4fv(m_program, location, count, values);
+    else
+        glUniform4fv(location, count, values);
 }
 
-void Shader::SetMatrix3(const std::string &name, const float *value)
+
+void Shader::SetInt(const char *name, int value) 
 {
-    int id = getUniform(name);
-    if (id != -1)
-        glUniformMatrix3fv(id, 1, GL_FALSE, value);
+    SetInt(GetUniformHandle(name), value);
 }
 
-void Shader::SetFloat(const std::string& name, float v)
+void Shader::SetMatrix4(const char *name, const float *value)
 {
-    int id = getUniform(name);
-    if (id != -1)
-        glUniform1f(id,  v);
+    SetMatrix4(GetUniformHandle(name), value);
 }
-void Shader::SetFloat(const std::string& name, float x, float y)
+
+void Shader::SetMatrix3(const char *name, const float *value)
 {
-    int id = getUniform(name);
-    if (id != -1)
-        glUniform2f(id,  x,y);
+    SetMatrix3(GetUniformHandle(name), value);
 }
-void Shader::SetFloat(const std::string& name,float x, float y, float z)
+
+void Shader::SetFloat(const char *name, float v)
 {
-   int id = getUniform(name);
-    if (id != -1)
-        glUniform3f(id, x, y, z);
+    SetFloat(GetUniformHandle(name), v);
 }
-void Shader::SetFloat(const std::string& name, float x, float y, float z, float w)
+void Shader::SetFloat(const char *name, float x, float y)
 {
-	int id = getUniform(name);
-    if (id != -1)
-		glUniform4f(id,  x, y, z, w);
+    SetFloat(GetUniformHandle(name), x, y);
+}
+void Shader::SetFloat(const char *name, float x, float y, float z)
+{
+    SetFloat(GetUniformHandle(name), x, y, z);
+}
+void Shader::SetFloat(const char *name, float x, float y, float z, float w)
+{
+    SetFloat(GetUniformHandle(name), x, y, z, w);
 }   
+void Shader::SetFloat4Array(const char *name, const float *values, int count)
+{
+    SetFloat4Array(GetUniformHandle(name), values, count);
+}
 
 
 void Shader::print()
@@ -290,24 +715,188 @@ void Shader::LoadDefaults()
         GLenum type = GL_ZERO;
         glGetActiveAttrib(m_program, attrib,  sizeof(name) - 1, &namelen, &num, &type, name);
         name[namelen] = 0;
+        // Built-in inputs (gl_InstanceID, gl_VertexID) are listed as active but have no location
+        if (strncmp(name, "gl_", 3) == 0)
+            continue;
         addAttribute(std::string((char*)&name[0]));
         glBindAttribLocation(m_program, attrib, (char*)&name[0]);
         LogInfo("SHADER: [ID %i] Active attribute (%s) set at location: %i", m_program, name,attrib);
     }
-    // Get available shader uniforms
+    // Uniforms were read into the table at link time
     int uniformCount = -1;
     glGetProgramiv(m_program, GL_ACTIVE_UNIFORMS, &uniformCount);
     m_numUniforms=uniformCount;
 
-    for (int i = 0; i < uniformCount; i++)
+    for (const UniformInfo &uniform : m_uniforms)
     {
-        int namelen = -1;
-        int num = -1;
-        char name[256]; // Assume no variable names longer than 256
-        GLenum type = GL_ZERO;
-        glGetActiveUniform(m_program, i, sizeof(name) - 1, &namelen, &num, &type, name);
-        name[namelen] = 0;
-        addUniform(std::string((char*)&name[0]));
-        LogInfo("SHADER: [ID %i] Active uniform (%s) set at location: %i", m_program, name, glGetUniformLocation(m_program, name));
+        LogInfo("SHADER: [ID %i] Active uniform (%s) set at location: %i", m_program, uniform.name.c_str(), uniform.location);
     }
-}
\ No newline at end of file
+    if (m_frameBlock)
+        LogInfo("SHADER: [ID %i] Uniform block (%s) bound at: %u", m_program, FRAME_BLOCK_NAME, FRAME_UNIFORM_BINDING);
+}
+
+
+ShaderCompileQueue::ShaderCompileQueue()
+{
+    m_failed = 0;
+    m_start = 0;
+    m_logged = false;
+    if (!Shader::SetCompilerThreads(0xFFFFFFFFu))
+        LogInfo("SHADER: Parallel shader compile not available, programs build on the driver thread");
+}
+
+void ShaderCompileQueue::Add(Shader &shader, const char *vShaderCode, const char *fShaderCode, const char *gShaderCode)
+{
+    if (m_shaders.empty())
+        m_start = SDL_GetPerformanceCounter();
+    m_logged = false;
+    shader.Submit(vShaderCode, fShaderCode, gShaderCode);
+    m_shaders.push_back(&shader);
+}
+
+void ShaderCompileQueue::finish(Shader &shader)
+{
+    if (!shader.Finish())
+        m_failed++;
+}
+
+bool ShaderCompileQueue::Poll()
+{
+    int pending = 0;
+    for (Shader *shader : m_shaders)
+    {
+        if (!shader->IsPending())
+            continue;
+        if (shader->IsReady())
+            finish(*shader);
+        else
+            pending++;
+    }
+    if (pending == 0)
+        logDone();
+    return pending == 0;
+}
+
+bool ShaderCompileQueue::Wait()
+{
+    for (Shader *shader : m_shaders)
+    {
+        if (shader->IsPending())
+            finish(*shader);
+    }
+    logDone();
+    return m_failed == 0;
+}
+
+int ShaderCompileQueue::GetReadyCount() const
+{
+    int ready = 0;
+    for (const Shader *shader : m_shaders)
+        ready += shader->IsPending() ? 0 : 1;
+    return ready;
+}
+
+void ShaderCompileQueue::logDone()
+{
+    if (m_logged || m_shaders.empty())
+        return;
+    m_logged = true;
+    double ms = (SDL_GetPerformanceCounter() - m_start) * 1000.0 / SDL_GetPerformanceFrequency();
+    LogInfo("SHADER: %d program(s) ready in %.2f ms (%d failed, parallel compile %s)", (int)m_shaders.size(), ms, m_failed,
+            Shader::ParallelCompileSupported() ? "on" : "off");
+}
+
+
+ShaderVariants::ShaderVariants(const char *vShaderCode, const char *fShaderCode, const std::vector<std::string> &keywords)
+    : m_vertex(vShaderCode), m_fragment(fShaderCode), m_keywords(keywords)
+{
+    assert(m_keywords.size() <= 32 && "ShaderVariants: at most 32 feature keywords");
+}
+
+ShaderVariants::~ShaderVariants()
+{
+    Release();
+}
+
+void ShaderVariants::Release()
+{
+    for (auto &variant : m_variants)
+        delete variant.second;
+    m_variants.clear();
+}
+
+ShaderFeatures ShaderVariants::GetFeature(const char *keyword) const
+{
+    for (size_t i = 0; i < m_keywords.size(); i++)
+    {
+        if (m_keywords[i] == keyword)
+            return 1u << i;
+    }
+    return 0;
+}
+
+std::string ShaderVariants::expand(const std::string &source, ShaderFeatures features) const
+{
+    std::string defines;
+    for (size_t i = 0; i < m_keywords.size(); i++)
+    {
+        if (features & (1u << i))
+            defines += "#define " + m_keywords[i] + " 1\n";
+    }
+
+    // #version has to stay the first line
+    size_t insert = 0;
+    if (source.compare(0, 8, "#version") == 0)
+    {
+        insert = source.find('\n');
+        insert = insert == std::string::npos ? source.size() : insert + 1;
+    }
+    std::string result = source.substr(0, insert);
+    if (insert == source.size() && !result.empty() && result.back() != '\n')
+        result += '\n';
+    result += defines;
+    result.append(source, insert, std::string::npos);
+    return result;
+}
+
+Shader *ShaderVariants::create(ShaderFeatures features)
+{
+    assert((features >> m_keywords.size()) == 0 && "ShaderVariants: feature bit without a keyword");
+    Shader *shader = new Shader();
+    m_variants[features] = shader;
+    return shader;
+}
+
+Shader &ShaderVariants::Get(ShaderFeatures features)
+{
+    auto found = m_variants.find(features);
+    if (found != m_variants.end())
+    {
+        // Prewarmed but not collected by the queue yet
+        if (found->second->IsPending())
+            found->second->Finish();
+        return *found->second;
+    }
+
+    Shader *shader = create(features);
+    int compiled = Shader::GetBuildStats().compiled;
+    if (!shader->Create(expand(m_vertex, features).c_str(), expand(m_fragment, features).c_str()))
+        LogError("SHADER: [ID %i] Variant 0x%x failed to build on first use", shader->GetID(), features);
+    else if (Shader::GetBuildStats().compiled > compiled)
+        LogInfo("SHADER: [ID %i] Variant 0x%x compiled on first use", shader->GetID(), features);
+    else
+        LogInfo("SHADER: [ID %i] Variant 0x%x loaded from the binary cache on first use", shader->GetID(), features);
+    return *shader;
+}
+
+void ShaderVariants::Prewarm(ShaderCompileQueue &queue, const ShaderFeatures *features, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (m_variants.count(features[i]))
+            continue;
+        Shader *shader = create(features[i]);
+        queue.Add(*shader, expand(m_vertex, features[i]).c_str(), expand(m_fragment, features[i]).c_str());
+    }
+}
+
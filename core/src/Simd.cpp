@@ -0,0 +1,347 @@
+#include "Simd.hpp"
+#include "SimdTarget.hpp"
+#include <SDL3/SDL_cpuinfo.h>
+#include <cmath>
+#include <cstring>
+
+static const float NORMALIZE_EPSILON = 1e-6f; // same as Vec3::EPSILON
+static const float TRANSFORM_EPSILON = 1e-6f;
+
+//***********************************************************************************************************
+// Scalar
+
+static void ScalarMat4Multiply(const float *a, const float *b, float *out)
+{
+    float r[16];
+    for (int col = 0; col < 4; col++)
+    {
+        for (int row = 0; row < 4; row++)
+        {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; k++)
+            {
+                sum += a[k * 4 + row] * b[col * 4 + k];
+            }
+            r[col * 4 + row] = sum;
+        }
+    }
+    std::memcpy(out, r, sizeof(r));
+}
+
+static void ScalarMat4Transform(const float *m, const float *v, float *out)
+{
+    float w = m[3] * v[0] + m[7] * v[1] + m[11] * v[2] + m[15];
+    w = (std::abs(w) > TRANSFORM_EPSILON) ? 1.0f / w : 1.0f;
+    float x = (m[0] * v[0] + m[4] * v[1] + m[8] * v[2] + m[12]) * w;
+    float y = (m[1] * v[0] + m[5] * v[1] + m[9] * v[2] + m[13]) * w;
+    float z = (m[2] * v[0] + m[6] * v[1] + m[10] * v[2] + m[14]) * w;
+    out[0] = x;
+    out[1] = y;
+    out[2] = z;
+}
+
+static void ScalarQuatMultiply(const float *a, const float *b, float *out)
+{
+    float w = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+    float x = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+    float y = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+    float z = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+    out[0] = w;
+    out[1] = x;
+    out[2] = y;
+    out[3] = z;
+}
+
+// v' = v + w * t + u x t, with t = 2 * (u x v) and u the vector part of a unit quaternion.
+// Same result as q * v * q^-1 without the two full quaternion products.
+static void ScalarQuatRotate(const float *q, const float *v, float *out)
+{
+    float tx = (q[2] * v[2] - q[3] * v[1]) * 2.0f;
+    float ty = (q[3] * v[0] - q[1] * v[2]) * 2.0f;
+    float tz = (q[1] * v[1] - q[2] * v[0]) * 2.0f;
+    float x = v[0] + q[0] * tx + (q[2] * tz - q[3] * ty);
+    float y = v[1] + q[0] * ty + (q[3] * tx - q[1] * tz);
+    float z = v[2] + q[0] * tz + (q[1] * ty - q[2] * tx);
+    out[0] = x;
+    out[1] = y;
+    out[2] = z;
+}
+
+static void ScalarVec3Normalize(const float *v, float *out)
+{
+    float len = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (len > NORMALIZE_EPSILON)
+    {
+        float invLen = 1.0f / len;
+        out[0] = v[0] * invLen;
+        out[1] = v[1] * invLen;
+        out[2] = v[2] * invLen;
+        return;
+    }
+    out[0] = v[0];
+    out[1] = v[1];
+    out[2] = v[2];
+}
+
+static void ScalarVec3Cross(const float *a, const float *b, float *out)
+{
+    float x = a[1] * b[2] - a[2] * b[1];
+    float y = a[2] * b[0] - a[0] * b[2];
+    float z = a[0] * b[1] - a[1] * b[0];
+    out[0] = x;
+    out[1] = y;
+    out[2] = z;
+}
+
+static const MathKernels ScalarKernels = {
+    ScalarMat4Multiply,
+    ScalarMat4Transform,
+    ScalarQuatMultiply,
+    ScalarQuatRotate,
+    ScalarVec3Normalize,
+    ScalarVec3Cross,
+};
+
+//***********************************************************************************************************
+// SSE2
+
+#if defined(MATH_HAS_SSE2)
+
+static inline __m128 Load3(const float *v)
+{
+    return _mm_setr_ps(v[0], v[1], v[2], 0.0f);
+}
+
+static inline void Store3(float *out, __m128 v)
+{
+    float tmp[4];
+    _mm_storeu_ps(tmp, v);
+    out[0] = tmp[0];
+    out[1] = tmp[1];
+    out[2] = tmp[2];
+}
+
+static inline __m128 Cross3(__m128 a, __m128 b)
+{
+    __m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+    __m128 bZXY = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+    __m128 aZXY = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2));
+    __m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+    return _mm_sub_ps(_mm_mul_ps(aYZX, bZXY), _mm_mul_ps(aZXY, bYZX));
+}
+
+static void SSE2Mat4Multiply(const float *a, const float *b, float *out)
+{
+    __m128 c0 = _mm_loadu_ps(a + 0);
+    __m128 c1 = _mm_loadu_ps(a + 4);
+    __m128 c2 = _mm_loadu_ps(a + 8);
+    __m128 c3 = _mm_loadu_ps(a + 12);
+
+    __m128 r[4];
+    for (int col = 0; col < 4; col++)
+    {
+        const float *bc = b + col * 4;
+        __m128 sum = _mm_mul_ps(c0, _mm_set1_ps(bc[0]));
+        sum = _mm_add_ps(sum, _mm_mul_ps(c1, _mm_set1_ps(bc[1])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(c2, _mm_set1_ps(bc[2])));
+        sum = _mm_add_ps(sum, _mm_mul_ps(c3, _mm_set1_ps(bc[3])));
+        r[col] = sum;
+    }
+    _mm_storeu_ps(out + 0, r[0]);
+    _mm_storeu_ps(out + 4, r[1]);
+    _mm_storeu_ps(out + 8, r[2]);
+    _mm_storeu_ps(out + 12, r[3]);
+}
+
+static void SSE2Mat4Transform(const float *m, const float *v, float *out)
+{
+    __m128 r = _mm_mul_ps(_mm_loadu_ps(m + 0), _mm_set1_ps(v[0]));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m + 4), _mm_set1_ps(v[1])));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m + 8), _mm_set1_ps(v[2])));
+    r = _mm_add_ps(r, _mm_loadu_ps(m + 12));
+
+    float w = _mm_cvtss_f32(_mm_shuffle_ps(r, r, _MM_SHUFFLE(3, 3, 3, 3)));
+    w = (std::abs(w) > TRANSFORM_EPSILON) ? 1.0f / w : 1.0f;
+    Store3(out, _mm_mul_ps(r, _mm_set1_ps(w)));
+}
+
+static void SSE2QuatMultiply(const float *a, const float *b, float *out)
+{
+    // Lanes are (w, x, y, z); each term is one column of the Hamilton product.
+    const __m128 sign1 = _mm_setr_ps(-0.0f, 0.0f, -0.0f, 0.0f);
+    const __m128 sign2 = _mm_setr_ps(-0.0f, 0.0f, 0.0f, -0.0f);
+    const __m128 sign3 = _mm_setr_ps(-0.0f, -0.0f, 0.0f, 0.0f);
+
+    __m128 qb = _mm_loadu_ps(b);
+    __m128 t1 = _mm_xor_ps(_mm_shuffle_ps(qb, qb, _MM_SHUFFLE(2, 3, 0, 1)), sign1);
+    __m128 t2 = _mm_xor_ps(_mm_shuffle_ps(qb, qb, _MM_SHUFFLE(1, 0, 3, 2)), sign2);
+    __m128 t3 = _mm_xor_ps(_mm_shuffle_ps(qb, qb, _MM_SHUFFLE(0, 1, 2, 3)), sign3);
+
+    __m128 r = _mm_mul_ps(_mm_set1_ps(a[0]), qb);
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a[1]), t1));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a[2]), t2));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(a[3]), t3));
+    _mm_storeu_ps(out, r);
+}
+
+static void SSE2QuatRotate(const float *q, const float *v, float *out)
+{
+    __m128 u = Load3(q + 1);
+    __m128 p = Load3(v);
+    __m128 t = _mm_mul_ps(Cross3(u, p), _mm_set1_ps(2.0f));
+    __m128 r = _mm_add_ps(p, _mm_mul_ps(_mm_set1_ps(q[0]), t));
+    r = _mm_add_ps(r, Cross3(u, t));
+    Store3(out, r);
+}
+
+static void SSE2Vec3Normalize(const float *v, float *out)
+{
+    __m128 p = Load3(v);
+    __m128 sq = _mm_mul_ps(p, p);
+    __m128 dot = _mm_add_ss(_mm_add_ss(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(1, 1, 1, 1))),
+                            _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2, 2, 2, 2)));
+    float len = _mm_cvtss_f32(_mm_sqrt_ss(dot));
+    if (len > NORMALIZE_EPSILON)
+    {
+        Store3(out, _mm_mul_ps(p, _mm_set1_ps(1.0f / len)));
+        return;
+    }
+    Store3(out, p);
+}
+
+static void SSE2Vec3Cross(const float *a, const float *b, float *out)
+{
+    Store3(out, Cross3(Load3(a), Load3(b)));
+}
+
+static const MathKernels SSE2Kernels = {
+    SSE2Mat4Multiply,
+    SSE2Mat4Transform,
+    SSE2QuatMultiply,
+    SSE2QuatRotate,
+    SSE2Vec3Normalize,
+    SSE2Vec3Cross,
+};
+
+#endif
+
+//***********************************************************************************************************
+// AVX2 (only the 4x4 product is wide enough to gain from 256-bit lanes, the rest reuses SSE2)
+
+#if defined(MATH_HAS_AVX2)
+
+MATH_TARGET_AVX2 static void AVX2Mat4Multiply(const float *a, const float *b, float *out)
+{
+    // Each register holds the same column of a twice so two result columns are built at once.
+    __m256 c0 = _mm256_broadcast_ps((const __m128 *)(a + 0));
+    __m256 c1 = _mm256_broadcast_ps((const __m128 *)(a + 4));
+    __m256 c2 = _mm256_broadcast_ps((const __m128 *)(a + 8));
+    __m256 c3 = _mm256_broadcast_ps((const __m128 *)(a + 12));
+
+    __m256 b01 = _mm256_loadu_ps(b + 0);
+    __m256 b23 = _mm256_loadu_ps(b + 8);
+
+    __m256 r01 = _mm256_mul_ps(c0, _mm256_shuffle_ps(b01, b01, 0x00));
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(c1, _mm256_shuffle_ps(b01, b01, 0x55)));
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(c2, _mm256_shuffle_ps(b01, b01, 0xAA)));
+    r01 = _mm256_add_ps(r01, _mm256_mul_ps(c3, _mm256_shuffle_ps(b01, b01, 0xFF)));
+
+    __m256 r23 = _mm256_mul_ps(c0, _mm256_shuffle_ps(b23, b23, 0x00));
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(c1, _mm256_shuffle_ps(b23, b23, 0x55)));
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(c2, _mm256_shuffle_ps(b23, b23, 0xAA)));
+    r23 = _mm256_add_ps(r23, _mm256_mul_ps(c3, _mm256_shuffle_ps(b23, b23, 0xFF)));
+
+    _mm256_storeu_ps(out + 0, r01);
+    _mm256_storeu_ps(out + 8, r23);
+}
+
+static const MathKernels AVX2Kernels = {
+    AVX2Mat4Multiply,
+    SSE2Mat4Transform,
+    SSE2QuatMultiply,
+    SSE2QuatRotate,
+    SSE2Vec3Normalize,
+    SSE2Vec3Cross,
+};
+
+#endif
+
+//***********************************************************************************************************
+
+static SimdLevel DetectSimdLevel()
+{
+#if defined(MATH_HAS_AVX2)
+    if (SDL_HasAVX2())
+        return SimdLevel::AVX2;
+#endif
+#if defined(MATH_HAS_SSE2)
+    if (SDL_HasSSE2())
+        return SimdLevel::SSE2;
+#endif
+    return SimdLevel::SCALAR;
+}
+
+// Function-local so math used during static initialization of other units still sees a valid table.
+struct SimdState
+{
+    SimdLevel supported;
+    SimdLevel level;
+    const MathKernels *kernels;
+};
+
+static SimdState &State()
+{
+    static SimdState state = {DetectSimdLevel(), DetectSimdLevel(), &GetMathKernels(DetectSimdLevel())};
+    return state;
+}
+
+SimdLevel GetSupportedSimdLevel()
+{
+    return State().supported;
+}
+
+SimdLevel GetSimdLevel()
+{
+    return State().level;
+}
+
+void SetSimdLevel(SimdLevel level)
+{
+    SimdState &state = State();
+    if (level > state.supported)
+        level = state.supported;
+    state.level = level;
+    state.kernels = &GetMathKernels(level);
+}
+
+const char *GetSimdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::AVX2:
+        return "AVX2";
+    case SimdLevel::SSE2:
+        return "SSE2";
+    default:
+        return "Scalar";
+    }
+}
+
+const MathKernels &GetMathKernels()
+{
+    return *State().kernels;
+}
+
+const MathKernels &GetMathKernels(SimdLevel level)
+{
+#if defined(MATH_HAS_AVX2)
+    if (level >= SimdLevel::AVX2 && SDL_HasAVX2())
+        return AVX2Kernels;
+#endif
+#if defined(MATH_HAS_SSE2)
+    if (level >= SimdLevel::SSE2)
+        return SSE2Kernels;
+#endif
+    (void)level;
+    return ScalarKernels;
+}
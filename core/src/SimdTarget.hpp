@@ -0,0 +1,17 @@
+#pragma once
+
+// Which instruction sets the kernels in this directory can be compiled for.
+// AVX2 code is compiled per function (target attribute) and only called after
+// the runtime check in Simd.cpp, so no global -mavx2 is needed.
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MATH_HAS_SSE2
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define MATH_HAS_AVX2
+#define MATH_TARGET_AVX2
+#elif defined(__GNUC__) || defined(__clang__)
+#define MATH_HAS_AVX2
+#define MATH_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
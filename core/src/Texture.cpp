@@ -466,3 +466,28 @@ bool Texture2D::LoadFromMemory(const unsigned char *buffer, u16 components, int
 
     return true;
 }
+
+bool Texture2D::LoadFloat(const float *buffer, int width, int height)
+{
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    if (width <= 0 || height <= 0 || width > maxSize || height > maxSize)
+    {
+        LogError("Texture: float texture %dx%d exceeds the maximum size %d", width, height, maxSize);
+        return false;
+    }
+
+    this->width = width;
+    this->height = height;
+    this->components = 4;
+
+    MinificationFilter = Nearest;
+    MagnificationFilter = Nearest;
+    HorizontalWrap = ClampToEdge;
+    VerticalWrap = ClampToEdge;
+
+    createTexture();
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, buffer);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
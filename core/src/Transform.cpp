@@ -0,0 +1,98 @@
+#include "Transform.hpp"
+#include <algorithm>
+
+int TransformHierarchy::addNode(int parent, const Vec3 &translation, const Quat &rotation, const Vec3 &scale)
+{
+    int index = (int)parents.size();
+    assert(parent < index && "TransformHierarchy: parent must be added before its children");
+    parents.push_back(parent);
+    translations.push_back(translation);
+    rotations.push_back(rotation);
+    scales.push_back(scale);
+    worlds.push_back(Mat4::Identity());
+    dirty.push_back(1);
+    return index;
+}
+
+void TransformHierarchy::reserve(size_t count)
+{
+    parents.reserve(count);
+    translations.reserve(count);
+    rotations.reserve(count);
+    scales.reserve(count);
+    worlds.reserve(count);
+    dirty.reserve(count);
+}
+
+void TransformHierarchy::clear()
+{
+    parents.clear();
+    translations.clear();
+    rotations.clear();
+    scales.clear();
+    worlds.clear();
+    dirty.clear();
+}
+
+void TransformHierarchy::setTranslation(int node, const Vec3 &t)
+{
+    Vec3 &current = translations[node];
+    if (current.x != t.x || current.y != t.y || current.z != t.z)
+    {
+        current = t;
+        dirty[node] = 1;
+    }
+}
+
+void TransformHierarchy::setRotation(int node, const Quat &q)
+{
+    Quat &current = rotations[node];
+    if (current.w != q.w || current.x != q.x || current.y != q.y || current.z != q.z)
+    {
+        current = q;
+        dirty[node] = 1;
+    }
+}
+
+void TransformHierarchy::setScale(int node, const Vec3 &s)
+{
+    Vec3 &current = scales[node];
+    if (current.x != s.x || current.y != s.y || current.z != s.z)
+    {
+        current = s;
+        dirty[node] = 1;
+    }
+}
+
+int TransformHierarchy::update()
+{
+    int rebuilt = 0;
+    int count = (int)parents.size();
+    for (int i = 0; i < count; i++)
+    {
+        int parent = parents[i];
+        if (!dirty[i] && (parent < 0 || !dirty[parent]))
+            continue;
+
+        // local = T * R * S
+        Mat4 local = Mat4::Rotate(rotations[i]);
+        local.applyScale(scales[i].x, scales[i].y, scales[i].z);
+        local.m[12] = translations[i].x;
+        local.m[13] = translations[i].y;
+        local.m[14] = translations[i].z;
+
+        if (parent < 0)
+            worlds[i] = local;
+        else
+            GetMathKernels().mat4Multiply(worlds[parent].m, local.m, worlds[i].m);
+
+        // stays set until the end of the pass so the children see it
+        dirty[i] = 1;
+        rebuilt++;
+    }
+
+    if (rebuilt > 0)
+        std::fill(dirty.begin(), dirty.end(), 0);
+
+    return rebuilt;
+}
@@ -0,0 +1,130 @@
+#include "Math.hpp"
+#include "Transform.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// The per-frame humanoid walk must not touch the heap: counts every operator new
+// while building 10k humanoid poses on a FixedMatrixStack and on a TransformHierarchy.
+
+static size_t s_allocations = 0;
+
+void *operator new(size_t size)
+{
+    s_allocations++;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+void operator delete[](void *p, size_t) noexcept { std::free(p); }
+
+static const int RENDERS = 10000;
+
+// Same shape as the humanoid: torso, head, two arms and two legs of two segments each
+template <class Stack>
+static float Walk(Stack &stack, float angle)
+{
+    float sink = 0.0f;
+    stack.identity();
+    stack.translate(1.0f, 2.0f, 3.0f);
+    stack.rotateY(angle);
+
+    stack.push();
+    stack.scale(1.0f, 1.6f, 0.5f);
+    sink += stack.top().m[0];
+    stack.pop();
+
+    stack.push();
+    stack.translate(0.0f, 1.4f, 0.0f);
+    stack.scale(0.6f, 0.6f, 0.6f);
+    sink += stack.top().m[13];
+    stack.pop();
+
+    for (int side = 0; side < 2; side++)
+    {
+        float sideSign = side ? -1.0f : 1.0f;
+        for (int limb = 0; limb < 2; limb++)
+        {
+            stack.push();
+            stack.translate(sideSign * (limb ? 0.3f : 0.7f), limb ? -0.85f : 0.75f, 0.0f);
+            stack.rotateX(angle * sideSign);
+            stack.push();
+            stack.translate(0.0f, -0.3f, 0.0f);
+            stack.scale(0.4f, 0.6f, 0.4f);
+            sink += stack.top().m[1];
+            stack.pop();
+
+            stack.translate(0.0f, -0.6f, 0.0f);
+            stack.rotate(angle, Vec3(1.0f, 0.0f, 0.0f));
+            stack.push();
+            stack.multiply(Mat4::Scale(Vec3(0.3f, 0.6f, 0.3f)));
+            sink += stack.top().m[5];
+            stack.pop();
+            stack.pop();
+        }
+    }
+    return sink;
+}
+
+int main()
+{
+    // Reference results from the heap-backed MatrixStack, built before counting
+    MatrixStack reference;
+    FixedMatrixStack<8> fixed;
+    bool ok = true;
+    for (int i = 0; i < 8 && ok; i++)
+    {
+        float angle = i * 0.4f;
+        ok = Walk(reference, angle) == Walk(fixed, angle);
+    }
+    if (!ok)
+        std::printf("FixedMatrixStack differs from MatrixStack\n");
+
+    TransformHierarchy hierarchy;
+    hierarchy.reserve(11);
+    int root = hierarchy.addNode(-1);
+    int torso = hierarchy.addNode(root, Vec3(0.0f, 1.4f, 0.0f));
+    hierarchy.addNode(torso, Vec3(0.0f, 1.4f, 0.0f));
+    for (int side = 0; side < 2; side++)
+    {
+        float sideSign = side ? -1.0f : 1.0f;
+        int upperArm = hierarchy.addNode(torso, Vec3(sideSign * 0.7f, 0.75f, 0.0f));
+        hierarchy.addNode(upperArm, Vec3(0.0f, -0.6f, 0.0f));
+        int upperLeg = hierarchy.addNode(torso, Vec3(sideSign * 0.3f, -0.85f, 0.0f));
+        hierarchy.addNode(upperLeg, Vec3(0.0f, -0.6f, 0.0f));
+    }
+    hierarchy.update();
+
+    size_t before = s_allocations;
+    float sink = 0.0f;
+    int rebuilt = 0;
+    for (int i = 0; i < RENDERS; i++)
+    {
+        float angle = i * 0.001f;
+        sink += Walk(fixed, angle);
+
+        hierarchy.setTranslation(root, Vec3(1.0f, 2.0f, 3.0f));
+        hierarchy.setRotation(root, Quat(angle, Vec3(0.0f, 1.0f, 0.0f)));
+        for (int node = 3; node < (int)hierarchy.size(); node++)
+            hierarchy.setRotation(node, Quat(angle, Vec3(1.0f, 0.0f, 0.0f)));
+        rebuilt += hierarchy.update();
+        sink += hierarchy.getWorld((int)hierarchy.size() - 1).m[13];
+    }
+    size_t allocations = s_allocations - before;
+
+    std::printf("%d renders, %d nodes rebuilt, %zu allocations (%g)\n", RENDERS, rebuilt, allocations, sink);
+    if (allocations != 0)
+        ok = false;
+
+    std::printf(ok ? "PASS\n" : "FAIL\n");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,377 @@
+#include "Math.hpp"
+#include "MathStreams.hpp"
+#include "Simd.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Every kernel table this CPU can run must match the scalar one on random inputs.
+// The SIMD versions keep the scalar summation order, so only contraction (FMA) or
+// reciprocal rounding can move a result, and that stays within a few ulps.
+
+static const int ITERATIONS = 100000;
+static const int MAX_ULPS = 4;
+static const float ABS_TOLERANCE = 1e-6f; // near zero ulps are meaningless (cancellation)
+
+static uint32_t s_seed = 0x12345678u;
+
+static float Random()
+{
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return (float)(s_seed >> 8) / (float)(1u << 24) * 2.0f - 1.0f;
+}
+
+static int64_t Ulps(float a, float b)
+{
+    int32_t ia, ib;
+    std::memcpy(&ia, &a, sizeof(ia));
+    std::memcpy(&ib, &b, sizeof(ib));
+    // Map the sign-magnitude bit pattern to a monotonic integer line
+    int64_t la = (ia < 0) ? (int64_t)INT32_MIN - ia : ia;
+    int64_t lb = (ib < 0) ? (int64_t)INT32_MIN - ib : ib;
+    return (la > lb) ? la - lb : lb - la;
+}
+
+struct Result
+{
+    int64_t worstUlps = 0;
+    int failures = 0;
+};
+
+static void Compare(const char *level, const char *kernel, const float *expected, const float *actual, int count, Result &result)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (!std::isfinite(actual[i]))
+        {
+            if (result.failures++ < 10)
+                std::printf("  %s %s[%d]: %g is not finite\n", level, kernel, i, actual[i]);
+            continue;
+        }
+        if (std::abs(expected[i] - actual[i]) <= ABS_TOLERANCE)
+            continue;
+        int64_t ulps = Ulps(expected[i], actual[i]);
+        if (ulps > result.worstUlps)
+            result.worstUlps = ulps;
+        if (ulps > MAX_ULPS && result.failures++ < 10)
+            std::printf("  %s %s[%d]: expected %.9g, got %.9g (%lld ulps)\n", level, kernel, i, expected[i], actual[i], (long long)ulps);
+    }
+}
+
+static bool TestLevel(SimdLevel level)
+{
+    const MathKernels &scalar = GetMathKernels(SimdLevel::SCALAR);
+    const MathKernels &kernels = GetMathKernels(level);
+    const char *name = GetSimdLevelName(level);
+    Result result;
+
+    for (int it = 0; it < ITERATIONS; it++)
+    {
+        float a[16], b[16];
+        for (int i = 0; i < 16; i++)
+        {
+            a[i] = Random();
+            b[i] = Random();
+        }
+        // Affine half of the time, so mat4Transform also runs with w == 1
+        if (it & 1)
+        {
+            a[3] = a[7] = a[11] = 0.0f;
+            a[15] = 1.0f;
+        }
+
+        float expected[16], actual[16];
+        scalar.mat4Multiply(a, b, expected);
+        kernels.mat4Multiply(a, b, actual);
+        Compare(name, "mat4Multiply", expected, actual, 16, result);
+
+        // out may alias an input
+        std::memcpy(actual, a, sizeof(a));
+        kernels.mat4Multiply(actual, b, actual);
+        Compare(name, "mat4Multiply(alias)", expected, actual, 16, result);
+
+        scalar.mat4Transform(a, b, expected);
+        kernels.mat4Transform(a, b, actual);
+        Compare(name, "mat4Transform", expected, actual, 3, result);
+
+        // Quats are (w, x, y, z); rotate expects a unit quaternion
+        scalar.quatMultiply(a, b, expected);
+        kernels.quatMultiply(a, b, actual);
+        Compare(name, "quatMultiply", expected, actual, 4, result);
+
+        float unit[4];
+        float length = std::sqrt(a[0] * a[0] + a[1] * a[1] + a[2] * a[2] + a[3] * a[3]);
+        for (int i = 0; i < 4; i++)
+            unit[i] = a[i] / length;
+        scalar.quatRotate(unit, b, expected);
+        kernels.quatRotate(unit, b, actual);
+        Compare(name, "quatRotate", expected, actual, 3, result);
+
+        scalar.vec3Normalize(a, expected);
+        kernels.vec3Normalize(a, actual);
+        Compare(name, "vec3Normalize", expected, actual, 3, result);
+
+        scalar.vec3Cross(a, b, expected);
+        kernels.vec3Cross(a, b, actual);
+        Compare(name, "vec3Cross", expected, actual, 3, result);
+    }
+
+    std::printf("%-6s worst %lld ulps, %d failures\n", name, (long long)result.worstUlps, result.failures);
+    return result.failures == 0;
+}
+
+//***********************************************************************************************************
+// Stream kernels (MathStreams) dispatch on the active level: each one runs under SCALAR and
+// under every supported level, on counts around the 8-lane blocks so the scalar tails run too.
+
+static const size_t STREAM_COUNTS[] = {1, 7, 8, 9, 31, 64, 1001};
+
+static bool TestSkinPoints(SimdLevel level, size_t count, bool rigid)
+{
+    const int JOINTS = 16;
+    const int INFLUENCES = 4;
+    const int NAN_JOINT = JOINTS - 1;
+    const size_t STRIDE = 5; // interleaved with two extra floats per vertex
+
+    std::vector<float> palette(JOINTS * 12);
+    for (float &v : palette)
+        v = Random();
+    // Only ever referenced by zero-weight influences: must not reach the result
+    for (int e = 0; e < 12; e++)
+        palette[NAN_JOINT * 12 + e] = NAN;
+
+    Vec3Stream points;
+    for (size_t i = 0; i < count; i++)
+        points.push(Vec3(Random() * 2.0f, Random() * 2.0f, Random() * 2.0f));
+
+    // Lanes cycle through: 4 live influences on different joints, one live influence and junk
+    // in the other slots (out-of-range and NaN joints), and no live influence at all.
+    // rigid = every live influence 0 on the same joint (the broadcast path of the AVX2 kernel).
+    std::vector<int32_t> joints(INFLUENCES * count);
+    std::vector<float> weights(INFLUENCES * count);
+    for (size_t i = 0; i < count; i++)
+    {
+        for (int k = 0; k < INFLUENCES; k++)
+        {
+            int32_t &joint = joints[k * count + i];
+            float &weight = weights[k * count + i];
+            switch (i % 3)
+            {
+            case 0:
+                joint = rigid && k == 0 ? 3 : (int32_t)((i + k * 5) % (JOINTS - 1));
+                weight = 0.25f + Random() * 0.1f;
+                break;
+            case 1:
+                joint = (k == 0) ? (rigid ? 3 : (int32_t)(i % (JOINTS - 1))) : (k == 1 ? 1 << 28 : k == 2 ? -7 : NAN_JOINT);
+                weight = (k == 0) ? 1.0f : 0.0f;
+                break;
+            default:
+                joint = (k & 1) ? NAN_JOINT : -1000000;
+                weight = (k == 3) ? -0.0f : 0.0f;
+                break;
+            }
+        }
+    }
+
+    std::vector<float> expected(count * STRIDE, 7.0f), actual(count * STRIDE, 7.0f);
+    SetSimdLevel(SimdLevel::SCALAR);
+    SkinPoints(palette.data(), points, joints.data(), weights.data(), INFLUENCES, expected.data(), STRIDE);
+    SetSimdLevel(level);
+    SkinPoints(palette.data(), points, joints.data(), weights.data(), INFLUENCES, actual.data(), STRIDE);
+
+    Result result;
+    Compare(GetSimdLevelName(level), rigid ? "SkinPoints(rigid)" : "SkinPoints", expected.data(), actual.data(), (int)expected.size(), result);
+    return result.failures == 0;
+}
+
+static void RandomVec3s(Vec3Stream &out, size_t count)
+{
+    out.clear();
+    for (size_t i = 0; i < count; i++)
+        out.push(Vec3(Random() * 3.0f, Random() * 3.0f, Random() * 3.0f));
+}
+
+static void RandomQuats(QuatStream &out, size_t count)
+{
+    out.clear();
+    for (size_t i = 0; i < count; i++)
+        out.push(Quat(Random(), Random(), Random(), Random()).normalize());
+}
+
+static void CompareVec3s(SimdLevel level, const char *kernel, const Vec3Stream &expected, const Vec3Stream &actual, Result &result)
+{
+    const char *name = GetSimdLevelName(level);
+    Compare(name, kernel, expected.x.data(), actual.x.data(), (int)expected.size(), result);
+    Compare(name, kernel, expected.y.data(), actual.y.data(), (int)expected.size(), result);
+    Compare(name, kernel, expected.z.data(), actual.z.data(), (int)expected.size(), result);
+}
+
+static void CompareQuats(SimdLevel level, const char *kernel, const QuatStream &expected, const QuatStream &actual, Result &result)
+{
+    const char *name = GetSimdLevelName(level);
+    Compare(name, kernel, expected.w.data(), actual.w.data(), (int)expected.size(), result);
+    Compare(name, kernel, expected.x.data(), actual.x.data(), (int)expected.size(), result);
+    Compare(name, kernel, expected.y.data(), actual.y.data(), (int)expected.size(), result);
+    Compare(name, kernel, expected.z.data(), actual.z.data(), (int)expected.size(), result);
+}
+
+// Runs call() under SCALAR into expected and under level into actual
+template <typename Out, typename Call>
+static void RunBoth(SimdLevel level, Out &expected, Out &actual, const Call &call)
+{
+    SetSimdLevel(SimdLevel::SCALAR);
+    call(expected);
+    SetSimdLevel(level);
+    call(actual);
+}
+
+static bool TestVectorStreams(SimdLevel level, size_t count)
+{
+    Result result;
+    const char *name = GetSimdLevelName(level);
+
+    Affine3x4 m(Mat4::Translate(Vec3(1.0f, -2.0f, 0.5f)) * Mat4::Rotate(Quat(0.7f, Vec3(0.3f, 1.0f, -0.2f))) *
+                Mat4::Scale(Vec3(1.5f, 0.5f, 2.0f)));
+    Vec3Stream points, expected, actual;
+    RandomVec3s(points, count);
+    // Some vectors below Vec3::EPSILON: Normalize copies them unchanged
+    for (size_t i = 0; i < count; i += 5)
+        points.set(i, Vec3(Random() * 1e-7f, 0.0f, Random() * 1e-7f));
+
+    RunBoth(level, expected, actual, [&](Vec3Stream &out)
+            { TransformPoints(m, points, out); });
+    CompareVec3s(level, "TransformPoints", expected, actual, result);
+    RunBoth(level, expected, actual, [&](Vec3Stream &out)
+            { TransformNormals(m, points, out); });
+    CompareVec3s(level, "TransformNormals", expected, actual, result);
+    RunBoth(level, expected, actual, [&](Vec3Stream &out)
+            { Normalize(points, out); });
+    CompareVec3s(level, "Normalize", expected, actual, result);
+
+    // In place (output aliasing the input)
+    RunBoth(level, expected, actual, [&](Vec3Stream &out)
+            { out = points; TransformPoints(m, out, out); });
+    CompareVec3s(level, "TransformPoints(alias)", expected, actual, result);
+
+    std::vector<float> expectedLengths, actualLengths;
+    RunBoth(level, expectedLengths, actualLengths, [&](std::vector<float> &out)
+            { Lengths(points, out); });
+    Compare(name, "Lengths", expectedLengths.data(), actualLengths.data(), (int)count, result);
+
+    QuatStream a, b, expectedQuats, actualQuats;
+    RandomQuats(a, count);
+    RandomQuats(b, count);
+    RunBoth(level, expectedQuats, actualQuats, [&](QuatStream &out)
+            { MultiplyQuats(a, b, out); });
+    CompareQuats(level, "MultiplyQuats", expectedQuats, actualQuats, result);
+    for (float t : {0.0f, 0.3f, 1.0f})
+    {
+        RunBoth(level, expectedQuats, actualQuats, [&](QuatStream &out)
+                { NlerpQuats(a, b, t, out); });
+        CompareQuats(level, "NlerpQuats", expectedQuats, actualQuats, result);
+    }
+
+    return result.failures == 0;
+}
+
+static bool TestTrackStreams(SimdLevel level, size_t count)
+{
+    Result result;
+    const char *name = GetSimdLevelName(level);
+
+    std::vector<float> a(count), b(count), offset(count), scale(count), coefficients(4 * count);
+    std::vector<uint16_t> qa(count), qb(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        a[i] = Random() * 4.0f;
+        b[i] = Random() * 4.0f;
+        offset[i] = Random();
+        scale[i] = Random() * 1e-3f;
+        qa[i] = (uint16_t)(s_seed >> 16);
+        Random();
+        qb[i] = (uint16_t)(s_seed >> 16);
+    }
+    for (float &c : coefficients)
+        c = Random();
+
+    std::vector<float> expected(count), actual(count);
+    for (float t : {0.0f, 0.25f, 1.0f})
+    {
+        RunBoth(level, expected, actual, [&](std::vector<float> &out)
+                { LerpFloats(a.data(), b.data(), t, out.data(), count); });
+        Compare(name, "LerpFloats", expected.data(), actual.data(), (int)count, result);
+
+        RunBoth(level, expected, actual, [&](std::vector<float> &out)
+                { DequantizeLerp(qa.data(), qb.data(), offset.data(), scale.data(), t, out.data(), count); });
+        Compare(name, "DequantizeLerp", expected.data(), actual.data(), (int)count, result);
+
+        // Stride wider than count, like the padded coefficient rows of a clip
+        std::vector<float> rows(4 * (count + 3));
+        for (int r = 0; r < 4; r++)
+            std::memcpy(&rows[r * (count + 3)], &coefficients[r * count], count * sizeof(float));
+        RunBoth(level, expected, actual, [&](std::vector<float> &out)
+                { EvaluateCubics(rows.data(), count + 3, t, out.data(), count); });
+        Compare(name, "EvaluateCubics", expected.data(), actual.data(), (int)count, result);
+    }
+
+    return result.failures == 0;
+}
+
+static bool TestStreams(SimdLevel level)
+{
+    bool ok = true;
+    for (size_t count : STREAM_COUNTS)
+    {
+        ok = TestVectorStreams(level, count) && ok;
+        ok = TestTrackStreams(level, count) && ok;
+        ok = TestSkinPoints(level, count, false) && ok;
+        ok = TestSkinPoints(level, count, true) && ok;
+    }
+    std::printf("%-6s streams %s\n", GetSimdLevelName(level), ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main()
+{
+    SimdLevel supported = GetSupportedSimdLevel();
+    std::printf("Supported: %s\n", GetSimdLevelName(supported));
+
+    bool ok = true;
+    for (int level = (int)SimdLevel::SSE2; level <= (int)supported; level++)
+        ok = TestLevel((SimdLevel)level) && ok;
+    for (int level = (int)SimdLevel::SSE2; level <= (int)supported; level++)
+        ok = TestStreams((SimdLevel)level) && ok;
+
+    // SetSimdLevel clamps to what the CPU runs and swaps the active table
+    SetSimdLevel(SimdLevel::AVX2);
+    if (GetSimdLevel() != supported || &GetMathKernels() != &GetMathKernels(supported))
+    {
+        std::printf("SetSimdLevel did not clamp to %s\n", GetSimdLevelName(supported));
+        ok = false;
+    }
+    SetSimdLevel(SimdLevel::SCALAR);
+    if (&GetMathKernels() != &GetMathKernels(SimdLevel::SCALAR))
+    {
+        std::printf("SetSimdLevel(SCALAR) did not select the scalar table\n");
+        ok = false;
+    }
+
+    // Quat/Vec3 in Math.hpp go through the active table at run time and match their constexpr form
+    SetSimdLevel(supported);
+    static_assert((Quat(0.0f, 0.0f, 0.0f, 1.0f) * Quat(0.0f, 0.0f, 0.0f, 1.0f)).w == -1.0f, "Quat::operator*");
+    Quat k(0.0f, 0.0f, 0.0f, 1.0f);
+    Vec3 rotated = Quat(0.0f, 0.0f, 0.0f, 1.0f).rotate(Vec3(1.0f, 0.0f, 0.0f));
+    Vec3 normalized = Vec3(3.0f, 0.0f, 4.0f).normalize();
+    Vec3 crossed = Vec3(1.0f, 0.0f, 0.0f).cross(Vec3(0.0f, 1.0f, 0.0f));
+    if ((k * k).w != -1.0f || !(rotated == Vec3(-1.0f, 0.0f, 0.0f)) || std::abs(normalized.x - 0.6f) > 1e-6f ||
+        std::abs(normalized.z - 0.8f) > 1e-6f || !(crossed == Vec3(0.0f, 0.0f, 1.0f)))
+    {
+        std::printf("Quat/Vec3 operators disagree with the expected results\n");
+        ok = false;
+    }
+
+    std::printf(ok ? "PASS\n" : "FAIL\n");
+    return ok ? 0 : 1;
+}